@@ -0,0 +1,293 @@
+#include "benchdatagenerator.h"
+#include "taskrepository.h"
+#include "tasksearch.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+const char* const connectionName = "bench_generator";
+
+const char* const baseTags[] = {
+    "работа", "дом", "срочно", "учеба", "покупки", "здоровье", "финансы", "проект",
+    "звонок", "встреча", "отчет", "bug", "release", "review", "docs", "backend",
+    "frontend", "design", "ops", "research", "спорт", "семья", "поездка", "идея"
+};
+
+const char* const verbs[] = {
+    "Подготовить", "Проверить", "Обновить", "Написать", "Исправить", "Согласовать",
+    "Купить", "Позвонить", "Отправить", "Разобрать", "Спланировать", "Оплатить"
+};
+
+const char* const nouns[] = {
+    "отчет", "документацию", "релиз", "бюджет", "презентацию", "договор",
+    "тесты", "макет", "письмо", "расписание", "заявку", "сборку"
+};
+
+// Выбор ранга с вероятностью ~ 1 / (rank + 1)^s
+class ZipfSampler {
+public:
+    ZipfSampler(int size, double s)
+    {
+        cumulative.reserve(size);
+        double total = 0.0;
+        for (int rank = 0; rank < size; ++rank) {
+            total += 1.0 / std::pow(rank + 1, s);
+            cumulative.append(total);
+        }
+    }
+
+    int sample(QRandomGenerator& random) const
+    {
+        double value = random.generateDouble() * cumulative.last();
+        auto it = std::upper_bound(cumulative.begin(), cumulative.end(), value);
+        return std::min<int>(it - cumulative.begin(), cumulative.size() - 1);
+    }
+
+private:
+    QVector<double> cumulative;
+};
+
+void exec(QSqlQuery& query)
+{
+    if (!query.exec()) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+}
+
+void exec(QSqlDatabase& db, const QString& sql)
+{
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+}
+
+QSqlQuery prepare(QSqlDatabase& db, const QString& sql)
+{
+    QSqlQuery query(db);
+    if (!query.prepare(sql)) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+    return query;
+}
+
+// Число тегов у задачи: 0..4, чаще 1-2
+int sampleTagCount(QRandomGenerator& random)
+{
+    int roll = random.bounded(100);
+    if (roll < 10) return 0;
+    if (roll < 45) return 1;
+    if (roll < 75) return 2;
+    if (roll < 92) return 3;
+    return 4;
+}
+
+void fillDatabase(QSqlDatabase& db, const BenchDataOptions& options)
+{
+    QRandomGenerator random(options.seed);
+
+    const QStringList difficulties = {"Лёгкая", "Средняя", "Сложная"};
+    const QStringList priorities = {"Низкий", "Средний", "Высокий"};
+
+    // Рабочие пр-ва и категории
+    int workspaceCount = std::clamp(options.taskCount / 5000, 3, 40);
+    QVector<int> categoryIds;
+
+    QSqlQuery workspaceQuery = prepare(db, "INSERT INTO Workspaces (name) VALUES (:name)");
+    QSqlQuery categoryQuery = prepare(db, "INSERT INTO Categories (name, workspace_id) VALUES (:name, :workspace_id)");
+    for (int w = 0; w < workspaceCount; ++w) {
+        workspaceQuery.bindValue(":name", QString("Пространство %1").arg(w + 1));
+        exec(workspaceQuery);
+        int workspaceId = workspaceQuery.lastInsertId().toInt();
+
+        int categoryCount = 4 + random.bounded(9);
+        for (int c = 0; c < categoryCount; ++c) {
+            categoryQuery.bindValue(":name", QString("Категория %1.%2").arg(w + 1).arg(c + 1));
+            categoryQuery.bindValue(":workspace_id", workspaceId);
+            exec(categoryQuery);
+            categoryIds.append(categoryQuery.lastInsertId().toInt());
+        }
+    }
+
+    // Несколько "больших" категорий и длинный хвост тегов
+    ZipfSampler categorySampler(categoryIds.size(), 1.0);
+    ZipfSampler tagSampler(400, 1.1);
+
+    QSqlQuery taskQuery = prepare(db,
+        "INSERT INTO Tasks (description, category_id, difficulty, priority, status, deadline) "
+        "VALUES (:description, :category_id, :difficulty, :priority, :status, :deadline)");
+    QSqlQuery historyQuery = prepare(db,
+        "INSERT INTO TaskHistory (description, category_id, difficulty, priority, status, deadline, completed_at) "
+        "VALUES (:description, :category_id, :difficulty, :priority, :status, :deadline, :completed_at)");
+    QSqlQuery tagQuery = prepare(db, "INSERT INTO TaskTags (task_id, tag) VALUES (:task_id, :tag)");
+    QSqlQuery historyTagQuery = prepare(db, "INSERT INTO TaskHistoryTags (history_id, tag) VALUES (:task_id, :tag)");
+
+    int historyCount = qRound(options.taskCount * options.historyRatio);
+    for (int i = 0; i < options.taskCount + historyCount; ++i) {
+        bool inHistory = i >= options.taskCount;
+        QSqlQuery& query = inHistory ? historyQuery : taskQuery;
+
+        QString description = QString("%1 %2 #%3")
+                                  .arg(verbs[random.bounded(int(std::size(verbs)))])
+                                  .arg(nouns[random.bounded(int(std::size(nouns)))])
+                                  .arg(i + 1);
+
+        QString status;
+        if (inHistory) {
+            status = "Завершено";
+        } else {
+            status = random.bounded(100) < 65 ? "В ожидании" : "В процессе";
+        }
+
+        // ~70% задач со сроком в пределах [-30; +90] дней
+        QString deadline;
+        if (random.bounded(100) < 70) {
+            deadline = options.baseDate.addDays(random.bounded(121) - 30).toString("dd-MM-yyyy");
+        }
+
+        query.bindValue(":description", description);
+        query.bindValue(":category_id", categoryIds[categorySampler.sample(random)]);
+        query.bindValue(":difficulty", difficulties[random.bounded(3)]);
+        query.bindValue(":priority", priorities[random.bounded(3)]);
+        query.bindValue(":status", status);
+        query.bindValue(":deadline", deadline);
+        // История за последний год (для архивации по возрасту)
+        if (inHistory) {
+            QDateTime completedAt(options.baseDate.addDays(-random.bounded(365)), QTime(12, 0), Qt::UTC);
+            query.bindValue(":completed_at", completedAt.toString("yyyy-MM-dd HH:mm:ss"));
+        }
+        exec(query);
+        int id = query.lastInsertId().toInt();
+
+        QStringList tags;
+        int tagCount = sampleTagCount(random);
+        while (tags.size() < tagCount) {
+            QString tag = BenchDataGenerator::tagName(tagSampler.sample(random));
+            if (!tags.contains(tag)) tags.append(tag);
+        }
+        QSqlQuery& tagInsert = inHistory ? historyTagQuery : tagQuery;
+        for (const QString& tag : tags) {
+            tagInsert.bindValue(":task_id", id);
+            tagInsert.bindValue(":tag", tag);
+            exec(tagInsert);
+        }
+    }
+
+    QSqlQuery metaQuery = prepare(db,
+        "INSERT INTO BenchMeta (task_count, seed, base_date) VALUES (:task_count, :seed, :base_date)");
+    metaQuery.bindValue(":task_count", options.taskCount);
+    metaQuery.bindValue(":seed", options.seed);
+    metaQuery.bindValue(":base_date", options.baseDate.toString("dd-MM-yyyy"));
+    exec(metaQuery);
+}
+
+} // namespace
+
+QString BenchDataGenerator::tagName(int rank)
+{
+    if (rank < int(std::size(baseTags))) {
+        return QString::fromUtf8(baseTags[rank]);
+    }
+    return QString("project-%1").arg(rank);
+}
+
+void BenchDataGenerator::generate(const QString& path, const BenchDataOptions& options)
+{
+    // Пишем во временный файл, чтобы прерванная генерация не попала в кэш
+    QString tempPath = path + ".tmp";
+    QFile::remove(tempPath);
+
+    {
+        TaskRepository repository(connectionName);
+        if (!repository.open(tempPath)) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+        if (!repository.createSchema()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+
+        QSqlDatabase db = repository.database();
+        exec(db, "PRAGMA synchronous = OFF");
+        exec(db, "PRAGMA journal_mode = MEMORY");
+        exec(db, "CREATE TABLE IF NOT EXISTS BenchMeta (task_count INTEGER, seed INTEGER, base_date TEXT)");
+
+        repository.transaction();
+        try {
+            fillDatabase(db, options);
+            repository.commit();
+        } catch (...) {
+            repository.rollback();
+            repository.close();
+            throw;
+        }
+
+        // Полнотекстовый индекс, как при первом запуске приложения
+        TaskSearchIndex search;
+        search.createSchema(db);
+
+        repository.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    QFile::remove(path);
+    if (!QFile::rename(tempPath, path)) {
+        throw std::runtime_error(("Can't rename " + tempPath).toStdString());
+    }
+}
+
+// Параметры уже сгенерированной бд (taskCount = 0, если бд не подходит)
+BenchDataOptions BenchDataGenerator::readOptions(const QString& path)
+{
+    BenchDataOptions options;
+    options.taskCount = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (db.open()) {
+            // Бд старой схемы перегенерируется
+            QSqlQuery versionQuery("PRAGMA user_version", db);
+            bool current = versionQuery.next() && versionQuery.value(0).toInt() >= TaskRepository::schemaVersion;
+            versionQuery.finish();
+
+            QSqlQuery query("SELECT task_count, seed, base_date FROM BenchMeta", db);
+            if (current && query.next()) {
+                options.taskCount = query.value(0).toInt();
+                options.seed = query.value(1).toUInt();
+                options.baseDate = QDate::fromString(query.value(2).toString(), "dd-MM-yyyy");
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return options;
+}
+
+QString BenchDataGenerator::ensureDatabase(const QString& dir, const BenchDataOptions& options)
+{
+    QDir().mkpath(dir);
+    QString path = QDir(dir).filePath(QString("bench_%1_%2.db").arg(options.taskCount).arg(options.seed));
+
+    if (QFileInfo::exists(path)) {
+        BenchDataOptions existing = readOptions(path);
+        if (existing.taskCount == options.taskCount && existing.seed == options.seed) {
+            return path;
+        }
+    }
+
+    generate(path, options);
+    return path;
+}
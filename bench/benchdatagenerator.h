@@ -0,0 +1,31 @@
+#ifndef BENCHDATAGENERATOR_H
+#define BENCHDATAGENERATOR_H
+
+#include <QDate>
+#include <QString>
+
+// Параметры синтетической бд
+struct BenchDataOptions {
+    int taskCount = 1000;
+    quint32 seed = 42;
+    double historyRatio = 0.2;              // доля завершенных задач (TaskHistory)
+    QDate baseDate = QDate::currentDate();  // сроки раскладываются вокруг этой даты
+};
+
+// Генератор бд для бенчмарков: схема приложения, зипфовское распределение
+// задач по категориям и тегов по задачам, детерминированно от seed
+class BenchDataGenerator {
+public:
+    // Создает (или пересоздает) бд по пути path, бросает std::runtime_error
+    static void generate(const QString& path, const BenchDataOptions& options);
+
+    // Готовая бд с нужным числом задач (создается один раз и кэшируется в dir)
+    static QString ensureDatabase(const QString& dir, const BenchDataOptions& options);
+
+    // Параметры уже сгенерированной бд (taskCount = 0, если бд не подходит)
+    static BenchDataOptions readOptions(const QString& path);
+
+    static QString tagName(int rank);
+};
+
+#endif // BENCHDATAGENERATOR_H
@@ -0,0 +1,451 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QSqlDatabase>
+#include <QtTest>
+#include <limits>
+
+#include "benchdatagenerator.h"
+#include "changefeed.h"
+#include "deadlinescheduler.h"
+#include "modelcache.h"
+#include "modelsnapshot.h"
+#include "taskfilter.h"
+#include "taskimporter.h"
+#include "taskrepository.h"
+
+namespace {
+
+QJsonArray benchResults;
+
+// Замер одного бенчмарка (функция + строка данных) для JSON-отчета
+class BenchSample {
+public:
+    // Один проход тела QBENCHMARK
+    class Scope {
+    public:
+        explicit Scope(BenchSample& sample) : sample(sample) { timer.start(); }
+        ~Scope() { sample.add(timer.nsecsElapsed()); }
+
+    private:
+        BenchSample& sample;
+        QElapsedTimer timer;
+    };
+
+    BenchSample()
+        : name(QTest::currentTestFunction()), dataTag(QTest::currentDataTag())
+    {
+    }
+
+    ~BenchSample()
+    {
+        if (iterations == 0) return;
+
+        QJsonObject result;
+        result["benchmark"] = name;
+        result["dataset"] = dataTag;
+        result["iterations"] = iterations;
+        result["mean_ns"] = double(totalNs) / iterations;
+        result["min_ns"] = double(minNs);
+        if (items > 0) result["items"] = items;
+        benchResults.append(result);
+    }
+
+    void add(qint64 ns)
+    {
+        ++iterations;
+        totalNs += ns;
+        minNs = qMin(minNs, ns);
+    }
+
+    // Объем работы за итерацию (задач, строк)
+    qint64 items = 0;
+
+private:
+    QString name;
+    QString dataTag;
+    qint64 iterations = 0;
+    qint64 totalNs = 0;
+    qint64 minNs = std::numeric_limits<qint64>::max();
+};
+
+// Размеры бд: TASK_MANAGER_BENCH_SIZES=1000,100000,1000000
+QVector<int> benchSizes()
+{
+    QString value = qEnvironmentVariable("TASK_MANAGER_BENCH_SIZES", "1000");
+    QVector<int> sizes;
+    for (const QString& part : value.split(',', Qt::SkipEmptyParts)) {
+        int size = part.trimmed().toInt();
+        if (size > 0) sizes.append(size);
+    }
+    return sizes;
+}
+
+QString benchDataDir()
+{
+    return qEnvironmentVariable("TASK_MANAGER_BENCH_DATA",
+                                QDir::temp().filePath("task_manager_bench"));
+}
+
+void removeDatabaseFiles(const QString& path)
+{
+    for (const QString& suffix : {"", "-wal", "-shm", "-journal"}) {
+        QFile::remove(path + suffix);
+    }
+}
+
+// Бенчмарки меняют бд (статусы, вставки, импорт) - работают с копией, сгенерированная остается нетронутой
+QString workingCopy(const QString& source)
+{
+    QFileInfo info(source);
+    const QString path = info.dir().filePath(info.completeBaseName() + "-work.db");
+    removeDatabaseFiles(path);
+    if (!QFile::copy(source, path)) {
+        qFatal("Can't copy %s to %s", qPrintable(source), qPrintable(path));
+    }
+    return path;
+}
+
+} // namespace
+
+// Загруженная бд одного размера (общая для всех бенчмарков)
+struct BenchDataset {
+    explicit BenchDataset(int taskCount)
+        : repository(QString("bench_%1").arg(taskCount))
+    {
+        options.taskCount = taskCount;
+    }
+
+    ~BenchDataset()
+    {
+        qDeleteAll(workspaces);
+    }
+
+    BenchDataOptions options;
+    QString path;                  // рабочая копия
+    TaskRepository repository;
+    ChangeFeed changeFeed{repository};
+    QMap<QString, Workspace*> workspaces;
+    QVector<Task> taskHistory;
+    QVector<Task*> tasks;
+    SnapshotPublisher snapshots;
+};
+
+class TaskManagerBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanupTestCase();
+
+    void loadModel_data() { addSizes(); }
+    void loadModel();
+    void loadModelCached_data() { addSizes(); }
+    void loadModelCached();
+    void tagSearch_data() { addSizes(); }
+    void tagSearch();
+    void tagFilter_data() { addSizes(); }
+    void tagFilter();
+    void deadlineCheck_data() { addSizes(); }
+    void deadlineCheck();
+    void statusChange_data() { addSizes(); }
+    void statusChange();
+    void insertTask_data() { addSizes(); }
+    void insertTask();
+    void importTasks_data() { addSizes(); }
+    void importTasks();
+
+private:
+    void addSizes();
+    BenchDataset& dataset();
+
+    QMap<int, BenchDataset*> datasets;
+};
+
+void TaskManagerBench::addSizes()
+{
+    QTest::addColumn<int>("tasks");
+    for (int size : benchSizes()) {
+        QTest::newRow(QByteArray::number(size)) << size;
+    }
+}
+
+// Бд текущего размера: генерируется/открывается и загружается один раз
+BenchDataset& TaskManagerBench::dataset()
+{
+    QFETCH(int, tasks);
+
+    if (!datasets.contains(tasks)) {
+        auto* data = new BenchDataset(tasks);
+        QString source = BenchDataGenerator::ensureDatabase(benchDataDir(), data->options);
+        data->options = BenchDataGenerator::readOptions(source);
+        data->path = workingCopy(source);
+
+        // open() включает foreign_keys: очистка после замеров опирается на ON DELETE CASCADE
+        if (!data->repository.open(data->path)) {
+            qFatal("Can't open %s: %s", qPrintable(data->path), qPrintable(data->repository.lastError()));
+        }
+        // Триггеры журнала изменений, как в приложении: вставки и импорт замеряются вместе с ними
+        if (!data->changeFeed.createSchema()) {
+            qFatal("Can't create change log in %s", qPrintable(data->path));
+        }
+        data->repository.loadWorkspaces(data->workspaces);
+        data->repository.loadCategories(data->workspaces);
+        data->repository.loadTasks(data->workspaces);
+        data->repository.loadTaskHistory(data->taskHistory, false);
+        data->snapshots.publishAll(data->workspaces);
+
+        for (Workspace* workspace : data->workspaces) {
+            for (Category* category : workspace->getCategories()) {
+                for (Task* task : category->getTasks()) {
+                    data->tasks.append(task);
+                }
+            }
+        }
+        datasets.insert(tasks, data);
+    }
+    return *datasets[tasks];
+}
+
+void TaskManagerBench::cleanupTestCase()
+{
+    for (BenchDataset* data : datasets) {
+        data->repository.close();
+        QString connection = data->repository.database().connectionName();
+        QString path = data->path;
+        delete data;
+        QSqlDatabase::removeDatabase(connection);
+        removeDatabaseFiles(path);
+    }
+    datasets.clear();
+}
+
+// Стартовая загрузка: Workspaces -> Categories -> Tasks -> TaskHistory
+void TaskManagerBench::loadModel()
+{
+    BenchDataset& data = dataset();
+    BenchSample sample;
+    sample.items = data.tasks.size() + data.taskHistory.size();
+
+    QBENCHMARK {
+        BenchSample::Scope scope(sample);
+        QMap<QString, Workspace*> workspaces;
+        QVector<Task> taskHistory;
+        data.repository.loadWorkspaces(workspaces);
+        data.repository.loadCategories(workspaces);
+        data.repository.loadTasks(workspaces);
+        data.repository.loadTaskHistory(taskHistory, false);
+        qDeleteAll(workspaces);
+    }
+}
+
+// Стартовая загрузка из бинарного снимка (ModelCache)
+void TaskManagerBench::loadModelCached()
+{
+    BenchDataset& data = dataset();
+    BenchSample sample;
+    sample.items = data.tasks.size() + data.taskHistory.size();
+
+    QSqlDatabase db = data.repository.database();
+    QString path = ModelCache::cachePath(db.databaseName());
+    QVERIFY(ModelCache::createSchema(db));
+    QVERIFY(ModelCache::save(path, db, data.workspaces, data.taskHistory));
+
+    QBENCHMARK {
+        BenchSample::Scope scope(sample);
+        QMap<QString, Workspace*> workspaces;
+        QVector<Task> taskHistory;
+        QVERIFY(ModelCache::load(path, db, workspaces, taskHistory, false));
+        qDeleteAll(workspaces);
+    }
+
+    ModelCache::invalidate(db);
+    QFile::remove(path);
+}
+
+// Поиск по тегам как в MainWindow::findTasksByTags (теги перечитываются из бд)
+void TaskManagerBench::tagSearch()
+{
+    BenchDataset& data = dataset();
+    const QStringList searchTags = {BenchDataGenerator::tagName(0), BenchDataGenerator::tagName(30)};
+    BenchSample sample;
+    sample.items = data.tasks.size();
+
+    QBENCHMARK {
+        BenchSample::Scope scope(sample);
+        int matches = 0;
+        for (Task* task : data.tasks) {
+            QStringList taskTags = data.repository.taskTags(task->getId());
+            for (const QString& tag : taskTags) {
+                if (searchTags.contains(tag.trimmed(), Qt::CaseInsensitive)) {
+                    ++matches;
+                    break;
+                }
+            }
+        }
+        Q_UNUSED(matches);
+    }
+}
+
+// Тот же запрос через индекс тегов по снимку модели
+void TaskManagerBench::tagFilter()
+{
+    BenchDataset& data = dataset();
+    TaskFilterEngine engine;
+    TaskFilterCriteria criteria;
+    criteria.tags = QStringList{BenchDataGenerator::tagName(0)};
+    ModelSnapshotPtr snapshot = data.snapshots.current();
+    engine.run(snapshot, criteria);  // построение индекса не входит в замер
+
+    BenchSample sample;
+    sample.items = data.tasks.size();
+
+    QBENCHMARK {
+        BenchSample::Scope scope(sample);
+        QVector<TaskFilterHit> hits = engine.run(snapshot, criteria);
+        Q_UNUSED(hits);
+    }
+}
+
+// Проверка сроков на базовую дату генератора (есть совпадения)
+void TaskManagerBench::deadlineCheck()
+{
+    BenchDataset& data = dataset();
+    BenchSample sample;
+    sample.items = data.tasks.size();
+
+    QBENCHMARK {
+        BenchSample::Scope scope(sample);
+        QVector<Notification> notifications;
+        DeadlineScheduler::checkDeadlines(data.workspaces, notifications, data.options.baseDate);
+    }
+}
+
+// Смена статуса одной задачи (своя транзакция, как в changeTaskStatus)
+void TaskManagerBench::statusChange()
+{
+    BenchDataset& data = dataset();
+    QVERIFY(!data.tasks.isEmpty());
+    BenchSample sample;
+    int next = 0;
+
+    QBENCHMARK {
+        BenchSample::Scope scope(sample);
+        Task* task = data.tasks[next++ % data.tasks.size()];
+        QString status = task->getStatus() == "В процессе" ? "В ожидании" : "В процессе";
+
+        data.repository.transaction();
+        data.repository.updateTaskStatus(task->getId(), status);
+        data.repository.commit();
+        task->setStatus(status);
+    }
+}
+
+// Добавление задачи с тегами; вставленные задачи удаляются после замера
+void TaskManagerBench::insertTask()
+{
+    BenchDataset& data = dataset();
+    QVERIFY(!data.tasks.isEmpty());
+    int categoryId = data.workspaces.first()->getCategories().first()->getId();
+    const QStringList tags = {BenchDataGenerator::tagName(1), BenchDataGenerator::tagName(50)};
+    QVector<int> inserted;
+
+    {
+        BenchSample sample;
+        QBENCHMARK {
+            BenchSample::Scope scope(sample);
+            data.repository.transaction();
+            int id = data.repository.insertTask(QString("Бенчмарк %1").arg(inserted.size()), categoryId, tags,
+                                                "Средняя", "Средний", "В ожидании",
+                                                data.options.baseDate.toString("dd-MM-yyyy"));
+            data.repository.commit();
+            inserted.append(id);
+        }
+    }
+
+    data.repository.transaction();
+    for (int id : inserted) {
+        data.repository.deleteTask(id);
+    }
+    data.repository.commit();
+}
+
+// Импорт JSON Lines (задач столько же, сколько в бд) в новое рабочее пр-во; после замера оно удаляется
+void TaskManagerBench::importTasks()
+{
+    BenchDataset& data = dataset();
+    const int count = data.options.taskCount;
+
+    QByteArray lines;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject object;
+        object["workspace"] = "Бенчмарк импорт";
+        object["category"] = QString("Категория %1").arg(i % 20);
+        object["description"] = QString("Импорт %1").arg(i);
+        object["tags"] = QJsonArray{BenchDataGenerator::tagName(i % 400), BenchDataGenerator::tagName(i % 7)};
+        object["priority"] = "Средний";
+        object["deadline"] = data.options.baseDate.addDays(i % 90).toString(Qt::ISODate);
+        lines += QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    BenchSample sample;
+    sample.items = count;
+    QBENCHMARK {
+        QBuffer buffer(&lines);
+        buffer.open(QIODevice::ReadOnly);
+        TaskImporter importer(data.repository);
+        {
+            BenchSample::Scope scope(sample);
+            ImportResult result = importer.import(buffer, TaskImporter::JsonLines);
+            QCOMPARE(result.tasks, count);
+        }
+        data.repository.executeSQL("DELETE FROM Workspaces WHERE name = 'Бенчмарк импорт';");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // Построчные qDebug загрузки искажают замеры
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    // --json <файл> (по умолчанию task_manager_bench.json), остальное - аргументы QTest
+    QStringList args = app.arguments();
+    QString jsonPath = "task_manager_bench.json";
+    int jsonIndex = args.indexOf("--json");
+    if (jsonIndex > 0 && jsonIndex + 1 < args.size()) {
+        jsonPath = args[jsonIndex + 1];
+        args.remove(jsonIndex, 2);
+    }
+
+    int status;
+    {
+        TaskManagerBench bench;
+        status = QTest::qExec(&bench, args);
+    }
+
+    QJsonObject report;
+    report["suite"] = "task_manager_bench";
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["qt_version"] = QString(qVersion());
+    report["results"] = benchResults;
+
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Can't write %s", qPrintable(jsonPath));
+        return status ? status : 1;
+    }
+    file.write(QJsonDocument(report).toJson());
+    return status;
+}
+
+#include "task_manager_bench.moc"
@@ -0,0 +1,334 @@
+#include <QApplication>
+#include <QDateTime>
+#include <QDialog>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QPushButton>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QtTest>
+#include <functional>
+
+#include "benchdatagenerator.h"
+#include "mainwindow.h"
+
+namespace {
+
+// Размеры бд: TASK_MANAGER_BENCH_SIZES=1000,100000,1000000
+QVector<int> benchSizes()
+{
+    QString value = qEnvironmentVariable("TASK_MANAGER_BENCH_SIZES", "1000");
+    QVector<int> sizes;
+    for (const QString& part : value.split(',', Qt::SkipEmptyParts)) {
+        int size = part.trimmed().toInt();
+        if (size > 0) sizes.append(size);
+    }
+    return sizes;
+}
+
+QString benchDataDir()
+{
+    return qEnvironmentVariable("TASK_MANAGER_BENCH_DATA",
+                                QDir::temp().filePath("task_manager_bench"));
+}
+
+// Статистика одного действия по всем повторам
+struct ActionStats {
+    int samples = 0;
+    double wallTotalMs = 0.0;
+    double wallMaxMs = 0.0;
+    int stallCount = 0;
+    double stallTotalMs = 0.0;
+    double stallMaxMs = 0.0;
+    int dialogs = 0;
+};
+
+} // namespace
+
+// Прогон действий над MainWindow с замером времени и зависаний цикла событий.
+// Пульс - таймер на 1 мс: разрыв между тиками больше порога считается зависанием,
+// действие завершено, когда после него цикл событий простаивает settleTicks тиков подряд
+class GuiBenchRunner : public QObject
+{
+public:
+    explicit GuiBenchRunner(int stallThresholdMs)
+        : stallThresholdNs(qint64(stallThresholdMs) * 1000000)
+    {
+        heartbeat.setTimerType(Qt::PreciseTimer);
+        heartbeat.setInterval(1);
+        connect(&heartbeat, &QTimer::timeout, this, &GuiBenchRunner::tick);
+        qApp->installEventFilter(this);
+        clock.start();
+        heartbeat.start();
+    }
+
+    void measure(const QString& action, const std::function<void()>& body)
+    {
+        ActionStats& stats = results[action];
+
+        stallCount = 0;
+        stallTotalNs = 0;
+        stallMaxNs = 0;
+        quietTicks = 0;
+        dialogs = 0;
+        actionDone = false;
+
+        qint64 dispatchedAt = clock.nsecsElapsed();
+        lastTick = dispatchedAt;
+        settledAt = -1;
+        recording = true;
+
+        QEventLoop loop;
+        settleLoop = &loop;
+        QTimer::singleShot(0, this, [this, &body]() {
+            body();
+            actionDone = true;
+        });
+        QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+        loop.exec();
+        settleLoop = nullptr;
+        recording = false;
+
+        if (settledAt < 0) {
+            qWarning("%s: no idle period within %d ms", qPrintable(action), timeoutMs);
+            settledAt = clock.nsecsElapsed();
+        }
+
+        double wallMs = (settledAt - dispatchedAt) / 1e6;
+        stats.samples++;
+        stats.wallTotalMs += wallMs;
+        stats.wallMaxMs = qMax(stats.wallMaxMs, wallMs);
+        stats.stallCount += stallCount;
+        stats.stallTotalMs += stallTotalNs / 1e6;
+        stats.stallMaxMs = qMax(stats.stallMaxMs, stallMaxNs / 1e6);
+        stats.dialogs += dialogs;
+
+        qInfo("%-18s wall %9.2f ms, stalls %d (max %.2f ms)",
+              qPrintable(action), wallMs, stallCount, stallMaxNs / 1e6);
+    }
+
+    // Перенос накопленной статистики в отчет
+    void flush(int taskCount, QJsonArray& report)
+    {
+        for (auto it = results.begin(); it != results.end(); ++it) {
+            const ActionStats& stats = it.value();
+            QJsonObject result;
+            result["dataset"] = taskCount;
+            result["action"] = it.key();
+            result["samples"] = stats.samples;
+            result["wall_ms_mean"] = stats.wallTotalMs / stats.samples;
+            result["wall_ms_max"] = stats.wallMaxMs;
+            result["stall_count"] = stats.stallCount;
+            result["stall_ms_total"] = stats.stallTotalMs;
+            result["stall_ms_max"] = stats.stallMaxMs;
+            result["dialogs_dismissed"] = stats.dialogs;
+            report.append(result);
+        }
+        results.clear();
+    }
+
+    int timeoutMs = 10 * 60 * 1000;
+    int settleTicks = 10;
+
+protected:
+    // Модальные окна (сообщения об успехе и т.п.) закрываются сразу после показа
+    bool eventFilter(QObject* obj, QEvent* event) override
+    {
+        if (event->type() == QEvent::Show) {
+            QDialog* dialog = qobject_cast<QDialog*>(obj);
+            if (dialog && dialog->isModal()) {
+                dialogs++;
+                QMetaObject::invokeMethod(dialog, "reject", Qt::QueuedConnection);
+            }
+        }
+        return QObject::eventFilter(obj, event);
+    }
+
+private:
+    void tick()
+    {
+        qint64 now = clock.nsecsElapsed();
+        qint64 gap = now - lastTick;
+        qint64 previous = lastTick;
+        lastTick = now;
+        if (!recording) return;
+
+        if (gap > stallThresholdNs) {
+            stallCount++;
+            stallTotalNs += gap;
+            stallMaxNs = qMax(stallMaxNs, gap);
+        }
+
+        // Тик вовремя (с запасом на точность таймера) - цикл событий свободен
+        if (gap <= 3000000) {
+            if (quietTicks == 0) quietStart = previous;
+            quietTicks++;
+        } else {
+            quietTicks = 0;
+        }
+
+        if (actionDone && quietTicks >= settleTicks && settleLoop) {
+            settledAt = quietStart;
+            settleLoop->quit();
+        }
+    }
+
+    QElapsedTimer clock;
+    QTimer heartbeat;
+    QEventLoop* settleLoop = nullptr;
+    qint64 stallThresholdNs;
+    qint64 lastTick = 0;
+    qint64 quietStart = 0;
+    qint64 settledAt = -1;
+    int quietTicks = 0;
+    bool recording = false;
+    bool actionDone = false;
+
+    int stallCount = 0;
+    qint64 stallTotalNs = 0;
+    qint64 stallMaxNs = 0;
+    int dialogs = 0;
+
+    QMap<QString, ActionStats> results;
+};
+
+namespace {
+
+QList<QPushButton*> buttonsByName(QWidget* window, const QString& name)
+{
+    return window->findChildren<QPushButton*>(name);
+}
+
+// Сценарий над одной бд: запуск, выбор пр-в, смена статуса, язык, тема
+void runDataset(GuiBenchRunner& runner, int taskCount, int repeat, QJsonArray& report)
+{
+    BenchDataOptions options;
+    options.taskCount = taskCount;
+    QString source = BenchDataGenerator::ensureDatabase(benchDataDir(), options);
+
+    // MainWindow открывает task_manager.db в текущем каталоге - работаем с копией
+    QTemporaryDir workDir;
+    QString previousDir = QDir::currentPath();
+    QDir::setCurrent(workDir.path());
+    QFile::copy(source, "task_manager.db");
+
+    qInfo("Dataset: %d tasks", taskCount);
+
+    MainWindow* window = nullptr;
+    runner.measure("startup", [&]() {
+        window = new MainWindow;
+        window->resize(1280, 800);
+        window->show();
+    });
+
+    for (int round = 0; round < repeat; ++round) {
+        // Выбор рабочих пр-в по очереди
+        QList<QPushButton*> workspaceButtons = buttonsByName(window, "workspaceButton");
+        if (!workspaceButtons.isEmpty()) {
+            QPushButton* button = workspaceButtons[round % workspaceButtons.size()];
+            runner.measure("select_workspace", [button]() {
+                QTest::mouseClick(button, Qt::LeftButton);
+            });
+        }
+
+        // Смена статуса первой задачи (туда и обратно); кнопки пересоздаются,
+        // поэтому нажатие через click(), а не через события мыши
+        const char* statusButtons[] = {"progressButton", "pendingButton"};
+        for (const char* name : statusButtons) {
+            QList<QPushButton*> buttons = buttonsByName(window, name);
+            if (buttons.isEmpty()) break;
+            QPointer<QPushButton> button = buttons.first();
+            runner.measure("status_click", [button]() {
+                if (button) button->click();
+            });
+        }
+
+        // Язык и тема (по два переключения, чтобы вернуться в исходное состояние)
+        for (int i = 0; i < 2; ++i) {
+            QList<QPushButton*> language = buttonsByName(window, "languageButton");
+            if (!language.isEmpty()) {
+                QPushButton* button = language.first();
+                runner.measure("toggle_language", [button]() {
+                    QTest::mouseClick(button, Qt::LeftButton);
+                });
+            }
+        }
+        for (int i = 0; i < 2; ++i) {
+            QList<QPushButton*> theme = buttonsByName(window, "themeButton");
+            if (!theme.isEmpty()) {
+                QPushButton* button = theme.first();
+                runner.measure("toggle_theme", [button]() {
+                    QTest::mouseClick(button, Qt::LeftButton);
+                });
+            }
+        }
+    }
+
+    runner.measure("shutdown", [&]() {
+        delete window;
+        window = nullptr;
+    });
+
+    runner.flush(taskCount, report);
+    QDir::setCurrent(previousDir);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // Без дисплея по умолчанию
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    // Построчные qDebug загрузки искажают замеры
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    // --json <файл>, --repeat <n>, --stall-ms <порог>
+    QStringList args = app.arguments();
+    QString jsonPath = "task_manager_gui_bench.json";
+    int repeat = 5;
+    int stallMs = 16;
+    for (int i = 1; i + 1 < args.size(); ++i) {
+        if (args[i] == "--json") jsonPath = args[++i];
+        else if (args[i] == "--repeat") repeat = qMax(1, args[++i].toInt());
+        else if (args[i] == "--stall-ms") stallMs = qMax(1, args[++i].toInt());
+    }
+
+    GuiBenchRunner runner(stallMs);
+    QJsonArray results;
+    try {
+        for (int size : benchSizes()) {
+            runDataset(runner, size, repeat, results);
+        }
+    } catch (const std::exception& e) {
+        qCritical("GUI benchmark failed: %s", e.what());
+        return 1;
+    }
+
+    QJsonObject report;
+    report["suite"] = "task_manager_gui_bench";
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["qt_version"] = QString(qVersion());
+    report["platform"] = QGuiApplication::platformName();
+    report["stall_threshold_ms"] = stallMs;
+    report["results"] = results;
+
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Can't write %s", qPrintable(jsonPath));
+        return 1;
+    }
+    file.write(QJsonDocument(report).toJson());
+    return 0;
+}
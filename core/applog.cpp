@@ -0,0 +1,215 @@
+#include "applog.h"
+#include <QByteArray>
+#include <QFile>
+#include <QThread>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+
+Q_LOGGING_CATEGORY(lcDb, "taskmanager.db", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcModel, "taskmanager.model", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcUi, "taskmanager.ui", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcSearch, "taskmanager.search", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcTrace, "taskmanager.trace", QtInfoMsg)
+
+namespace {
+
+qint64 monotonicMs()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct LogNode {
+    std::atomic<LogNode*> next{nullptr};
+    QByteArray text;
+};
+
+// Очередь Вьюкова (много писателей, один читатель) без блокировок
+class LogQueue {
+public:
+    LogQueue() : head(&stub), tail(&stub) {}
+
+    void push(LogNode* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        LogNode* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // Только из потока-читателя
+    LogNode* pop()
+    {
+        LogNode* current = tail;
+        LogNode* next = current->next.load(std::memory_order_acquire);
+        if (current == &stub) {
+            if (!next) return nullptr;
+            tail = next;
+            current = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return current;
+        }
+        if (current != head.load(std::memory_order_acquire)) return nullptr;  // писатель в процессе push
+
+        push(&stub);
+        next = current->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return current;
+        }
+        return nullptr;
+    }
+
+private:
+    std::atomic<LogNode*> head;
+    LogNode* tail;
+    LogNode stub;
+};
+
+// Предел очереди: при переполнении новые сообщения отбрасываются (и считаются)
+const int maxPending = 100000;
+
+struct WriterState {
+    LogQueue queue;
+    std::atomic<int> pending{0};
+    std::atomic<int> dropped{0};
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    QThread* thread = nullptr;
+    FILE* output = stderr;
+    QtMessageHandler previousHandler = nullptr;
+};
+
+WriterState& state()
+{
+    static WriterState instance;
+    return instance;
+}
+
+void writeLine(FILE* output, const QByteArray& text)
+{
+    std::fwrite(text.constData(), 1, size_t(text.size()), output);
+    std::fputc('\n', output);
+}
+
+int drainQueue(WriterState& s)
+{
+    int written = 0;
+    while (LogNode* node = s.queue.pop()) {
+        writeLine(s.output, node->text);
+        delete node;
+        s.pending.fetch_sub(1, std::memory_order_relaxed);
+        ++written;
+    }
+
+    int dropped = s.dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        writeLine(s.output, QByteArray("[log] dropped ") + QByteArray::number(dropped) + " messages");
+    }
+    if (written > 0 || dropped > 0) std::fflush(s.output);
+    return written;
+}
+
+void writerLoop()
+{
+    WriterState& s = state();
+    while (!s.stopping.load(std::memory_order_acquire)) {
+        if (drainQueue(s) == 0) {
+            // Пробуждение по первому сообщению в пустой очереди или по таймауту
+            std::unique_lock<std::mutex> lock(s.wakeMutex);
+            s.wake.wait_for(lock, std::chrono::milliseconds(20));
+        }
+    }
+    drainQueue(s);
+}
+
+void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    WriterState& s = state();
+    QByteArray text = qFormatLogMessage(type, context, message).toLocal8Bit();
+
+    // Фатальные сообщения и сообщения после остановки - сразу
+    if (type == QtFatalMsg || !s.running.load(std::memory_order_acquire)) {
+        writeLine(s.output, text);
+        std::fflush(s.output);
+        return;
+    }
+
+    if (s.pending.load(std::memory_order_relaxed) >= maxPending) {
+        s.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    LogNode* node = new LogNode;
+    node->text = std::move(text);
+    s.queue.push(node);
+    if (s.pending.fetch_add(1, std::memory_order_relaxed) == 0) {
+        s.wake.notify_one();
+    }
+}
+
+} // namespace
+
+bool LogRateLimiter::allow(const QLoggingCategory& category)
+{
+    qint64 now = monotonicMs();
+    qint64 start = windowStart.load(std::memory_order_relaxed);
+
+    // Новое секундное окно
+    if (now - start >= 1000 && windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        count.store(0, std::memory_order_relaxed);
+        int skipped = suppressed.exchange(0, std::memory_order_relaxed);
+        if (skipped > 0) {
+            QMessageLogger().debug(category) << "..." << skipped << "similar messages suppressed";
+        }
+    }
+
+    if (count.fetch_add(1, std::memory_order_relaxed) < limit) return true;
+    suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void AsyncLogWriter::install()
+{
+    WriterState& s = state();
+    if (s.running.load()) return;
+
+    QString path = qEnvironmentVariable("TASK_MANAGER_LOG");
+    if (!path.isEmpty()) {
+        FILE* file = std::fopen(QFile::encodeName(path).constData(), "a");
+        if (file) s.output = file;
+    }
+
+    s.stopping.store(false);
+    s.thread = QThread::create(writerLoop);
+    s.thread->setObjectName("log-writer");
+    s.thread->start(QThread::LowPriority);
+    s.running.store(true, std::memory_order_release);
+    s.previousHandler = qInstallMessageHandler(messageHandler);
+}
+
+void AsyncLogWriter::shutdown()
+{
+    WriterState& s = state();
+    if (!s.running.load()) return;
+
+    s.running.store(false, std::memory_order_release);
+    qInstallMessageHandler(s.previousHandler);
+
+    s.stopping.store(true, std::memory_order_release);
+    s.wake.notify_one();
+    s.thread->wait();
+    delete s.thread;
+    s.thread = nullptr;
+
+    if (s.output != stderr) {
+        std::fclose(s.output);
+        s.output = stderr;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef APPLOG_H
+#define APPLOG_H
+
+#include <QLoggingCategory>
+#include <atomic>
+
+// Категории журнала. Отладочные сообщения по умолчанию выключены
+// (включение: QT_LOGGING_RULES="taskmanager.db.debug=true"), аргументы
+// выключенных сообщений не форматируются
+Q_DECLARE_LOGGING_CATEGORY(lcDb)
+Q_DECLARE_LOGGING_CATEGORY(lcModel)
+Q_DECLARE_LOGGING_CATEGORY(lcUi)
+Q_DECLARE_LOGGING_CATEGORY(lcSearch)
+Q_DECLARE_LOGGING_CATEGORY(lcTrace)
+
+// Ограничение частоты построчных сообщений одного места вызова:
+// не больше limit сообщений в секунду, о пропущенных сообщается одной строкой
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(int limit = 20) : limit(limit) {}
+
+    bool allow(const QLoggingCategory& category);
+
+private:
+    const int limit;
+    std::atomic<qint64> windowStart{0};
+    std::atomic<int> count{0};
+    std::atomic<int> suppressed{0};
+};
+
+// qCDebug с ограничением частоты (свой лимитер на каждое место вызова)
+#define qCDebugRow(category) \
+    if (!category().isDebugEnabled() || \
+        ![]() -> LogRateLimiter& { static LogRateLimiter limiter; return limiter; }().allow(category())) {} \
+    else qCDebug(category)
+
+// Вывод журнала в фоновом потоке: обработчик сообщений кладет готовые строки
+// в lock-free очередь, поток-писатель выводит их в stderr (или TASK_MANAGER_LOG=<файл>)
+class AsyncLogWriter {
+public:
+    static void install();
+    // Вывод оставшихся сообщений и остановка потока
+    static void shutdown();
+};
+
+#endif // APPLOG_H
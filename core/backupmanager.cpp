@@ -0,0 +1,373 @@
+#include "backupmanager.h"
+#include "applog.h"
+#include "historyarchive.h"
+#include "readconnection.h"
+#include "tracer.h"
+#include "workspacestorage.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <stdexcept>
+
+#ifdef TASK_MANAGER_HAVE_SQLITE3
+#include <sqlite3.h>
+#endif
+
+namespace {
+
+// Страниц за шаг (~256 КБ при странице 4 КБ) и пауза между шагами:
+// блокировка источника держится только на время шага
+const int pagesPerStep = 64;
+const int stepPauseMs = 5;
+
+const char* const timestampFormat = "yyyyMMdd-HHmmss";
+
+QString backupPrefix(const QString& databasePath)
+{
+    return QFileInfo(databasePath).completeBaseName() + "-";
+}
+
+void removeWithSidecars(const QString& path)
+{
+    for (const QString& suffix : {"", "-journal", "-wal", "-shm"}) {
+        QFile::remove(path + suffix);
+    }
+}
+
+// Копия переводится в rollback-журнал (самодостаточный файл) и проверяется
+void finalizeCopy(const QString& path)
+{
+    const QString name = ReadConnection::uniqueName("backup_check");
+    QString error;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(path);
+        if (!db.open()) {
+            error = db.lastError().text();
+        } else {
+            QSqlQuery query(db);
+            query.exec("PRAGMA journal_mode=DELETE;");
+            if (!query.exec("PRAGMA quick_check;") || !query.next()) {
+                error = query.lastError().text();
+            } else if (query.value(0).toString() != "ok") {
+                error = "Backup is damaged: " + query.value(0).toString();
+            }
+            query.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    if (!error.isEmpty()) {
+        throw std::runtime_error(error.toStdString());
+    }
+}
+
+#ifdef TASK_MANAGER_HAVE_SQLITE3
+// Владение соединением sqlite3
+struct SqliteHandle {
+    sqlite3* db = nullptr;
+    ~SqliteHandle() { sqlite3_close(db); }
+};
+
+void check(int rc, sqlite3* db)
+{
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error(db ? sqlite3_errmsg(db) : sqlite3_errstr(rc));
+    }
+}
+
+bool copyDatabase(const QString& source, const QString& destination, const BackupManager::Progress& progress)
+{
+    SqliteHandle src;
+    SqliteHandle dst;
+    check(sqlite3_open_v2(QFile::encodeName(source).constData(), &src.db, SQLITE_OPEN_READONLY, nullptr), src.db);
+    check(sqlite3_open_v2(QFile::encodeName(destination).constData(), &dst.db,
+                          SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr), dst.db);
+    sqlite3_busy_timeout(src.db, 1000);
+
+    // Читающая транзакция на все копирование: в WAL это снимок, и запись приложения
+    // не перезапускает копирование (и сама не блокируется)
+    check(sqlite3_exec(src.db, "BEGIN; SELECT COUNT(*) FROM sqlite_master;", nullptr, nullptr, nullptr), src.db);
+
+    sqlite3_backup* backup = sqlite3_backup_init(dst.db, "main", src.db, "main");
+    if (!backup) {
+        throw std::runtime_error(sqlite3_errmsg(dst.db));
+    }
+
+    int rc;
+    do {
+        rc = sqlite3_backup_step(backup, pagesPerStep);
+        if (progress && !progress(sqlite3_backup_remaining(backup), sqlite3_backup_pagecount(backup))) {
+            sqlite3_backup_finish(backup);
+            return false;
+        }
+        if (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+            sqlite3_sleep(stepPauseMs);
+        }
+    } while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+
+    sqlite3_backup_finish(backup);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(sqlite3_errstr(rc));
+    }
+    sqlite3_exec(src.db, "COMMIT;", nullptr, nullptr, nullptr);
+    return true;
+}
+#else
+// Без SQLite3: VACUUM INTO (один запрос, тоже только чтение источника)
+bool copyDatabase(const QString& source, const QString& destination, const BackupManager::Progress& progress)
+{
+    ReadConnection connection(source, ReadConnection::uniqueName("backup"));
+    QSqlQuery query = connection.prepare("VACUUM INTO :path");
+    query.bindValue(":path", destination);
+    ReadConnection::exec(query);
+    if (progress) progress(0, 0);
+    return true;
+}
+#endif
+
+} // namespace
+
+BackupManager::BackupManager(QObject* parent)
+    : QObject(parent)
+{
+    timer.callOnTimeout(this, [this]() {
+        if (!isRunning()) start();
+    });
+}
+
+BackupManager::~BackupManager()
+{
+    if (worker) {
+        cancel();
+        worker->wait();
+    }
+}
+
+void BackupManager::setDatabasePath(const QString& path)
+{
+    sourcePath = QFileInfo(path).absoluteFilePath();
+}
+
+void BackupManager::setBackupDirectory(const QString& dir)
+{
+    directory = dir;
+}
+
+QString BackupManager::backupDirectory() const
+{
+    if (!directory.isEmpty()) return directory;
+    return QFileInfo(sourcePath).dir().filePath("backups");
+}
+
+void BackupManager::setKeepCount(int count)
+{
+    keep = qMax(1, count);
+}
+
+void BackupManager::setInterval(int minutes)
+{
+    intervalMinutes = qMax(0, minutes);
+    if (intervalMinutes > 0) {
+        timer.start(intervalMinutes * 60 * 1000);
+    } else {
+        timer.stop();
+    }
+}
+
+void BackupManager::configureFromEnvironment()
+{
+    bool ok = false;
+    int count = qEnvironmentVariableIntValue("TASK_MANAGER_BACKUP_KEEP", &ok);
+    if (ok) setKeepCount(count);
+
+    QString dir = qEnvironmentVariable("TASK_MANAGER_BACKUP_DIR");
+    if (!dir.isEmpty()) setBackupDirectory(dir);
+
+    int minutes = qEnvironmentVariableIntValue("TASK_MANAGER_BACKUP_INTERVAL", &ok);
+    if (ok) setInterval(minutes);
+}
+
+QStringList BackupManager::backups() const
+{
+    QDir dir(backupDirectory());
+    QStringList names = dir.entryList({backupPrefix(sourcePath) + "*.db"}, QDir::Files, QDir::Name | QDir::Reversed);
+    QStringList paths;
+    for (const QString& name : names) {
+        paths.append(dir.filePath(name));
+    }
+    return paths;
+}
+
+bool BackupManager::backup(const QString& source, const QString& destination, const Progress& progress)
+{
+    TRACE_SCOPE("BackupManager::backup", "sql");
+    const QString partPath = destination + ".part";
+    removeWithSidecars(partPath);
+
+    try {
+        if (!copyDatabase(source, partPath, progress)) {
+            removeWithSidecars(partPath);
+            return false;
+        }
+        finalizeCopy(partPath);
+    } catch (...) {
+        removeWithSidecars(partPath);
+        throw;
+    }
+
+    QFile::remove(destination);
+    if (!QFile::rename(partPath, destination)) {
+        removeWithSidecars(partPath);
+        throw std::runtime_error(("Can't rename " + partPath).toStdString());
+    }
+    return true;
+}
+
+void BackupManager::restore(const QString& backupPath, const QString& databasePath)
+{
+    TRACE_SCOPE("BackupManager::restore", "sql");
+    if (!QFileInfo::exists(backupPath)) {
+        throw std::runtime_error(("No such backup: " + backupPath).toStdString());
+    }
+
+    // Проверка копии до замены (рабочая копия, сама копия не меняется)
+    const QString partPath = databasePath + ".part";
+    removeWithSidecars(partPath);
+    if (!QFile::copy(backupPath, partPath)) {
+        throw std::runtime_error(("Can't copy " + backupPath).toStdString());
+    }
+    try {
+        finalizeCopy(partPath);
+    } catch (...) {
+        removeWithSidecars(partPath);
+        throw;
+    }
+
+    // Текущая бд (вместе с незачекпоинченным WAL) остается рядом
+    const QString savedPath = databasePath + ".before-restore";
+    removeWithSidecars(savedPath);
+    QFile::remove(databasePath + "-shm");
+    if (QFileInfo::exists(databasePath + "-wal")) {
+        QFile::rename(databasePath + "-wal", savedPath + "-wal");
+    }
+    if (QFileInfo::exists(databasePath) && !QFile::rename(databasePath, savedPath)) {
+        removeWithSidecars(partPath);
+        throw std::runtime_error(("Can't move " + databasePath).toStdString());
+    }
+
+    if (!QFile::rename(partPath, databasePath)) {
+        QFile::rename(savedPath, databasePath);
+        QFile::rename(savedPath + "-wal", databasePath + "-wal");
+        removeWithSidecars(partPath);
+        throw std::runtime_error(("Can't replace " + databasePath).toStdString());
+    }
+
+    // Файлы рабочих пр-в: текущие остаются рядом с сохраненной бд, из копии берутся ее файлы
+    const QString workspaceDir = WorkspaceStorage::directoryFor(databasePath);
+    const QString savedWorkspaceDir = WorkspaceStorage::directoryFor(savedPath);
+    QDir(savedWorkspaceDir).removeRecursively();
+    if (QFileInfo::exists(workspaceDir)) {
+        QDir().rename(workspaceDir, savedWorkspaceDir);
+    }
+    const QStringList workspaceFiles = WorkspaceStorage::files(backupPath);
+    if (!workspaceFiles.isEmpty()) {
+        QDir().mkpath(workspaceDir);
+        for (const QString& file : workspaceFiles) {
+            if (!QFile::copy(file, QDir(workspaceDir).filePath(QFileInfo(file).fileName()))) {
+                qCWarning(lcDb) << "Can't restore workspace file" << file;
+            }
+        }
+    }
+
+    // Архив истории - так же: текущий рядом с сохраненной бд
+    const QString archivePath = HistoryArchive::pathFor(databasePath);
+    const QString savedArchivePath = HistoryArchive::pathFor(savedPath);
+    QFile::remove(savedArchivePath);
+    if (QFileInfo::exists(archivePath)) {
+        QFile::rename(archivePath, savedArchivePath);
+    }
+    if (QFileInfo::exists(HistoryArchive::pathFor(backupPath)) &&
+        !QFile::copy(HistoryArchive::pathFor(backupPath), archivePath)) {
+        qCWarning(lcDb) << "Can't restore history archive" << backupPath;
+    }
+    qCInfo(lcDb) << "Database restored from" << backupPath << "- previous file kept as" << savedPath;
+}
+
+bool BackupManager::start()
+{
+    if (isRunning() || sourcePath.isEmpty()) return false;
+    cancelled.store(false);
+
+    const QString source = sourcePath;
+    const QString dir = backupDirectory();
+    const QString prefix = backupPrefix(sourcePath);
+    const int keepCount = keep;
+
+    worker = QThread::create([this, source, dir, prefix, keepCount]() {
+        QDir().mkpath(dir);
+        const QString path = QDir(dir).filePath(prefix + QDateTime::currentDateTime().toString(timestampFormat) + ".db");
+
+        const QString workspaceDir = WorkspaceStorage::directoryFor(path);
+        try {
+            auto report = [this](int remaining, int total) {
+                emit progress(remaining, total);
+                return !cancelled.load();
+            };
+            bool done = backup(source, path, report);
+
+            // Файлы рабочих пр-в - в каталог рядом с копией (каждый файл - свой снимок)
+            for (const QString& file : WorkspaceStorage::files(source)) {
+                if (!done) break;
+                QDir().mkpath(workspaceDir);
+                done = backup(file, QDir(workspaceDir).filePath(QFileInfo(file).fileName()), report);
+            }
+            // Архив истории дописывается только при старте - достаточно копии файла
+            const QString archive = HistoryArchive::pathFor(source);
+            if (done && QFileInfo::exists(archive) && !QFile::copy(archive, HistoryArchive::pathFor(path))) {
+                throw std::runtime_error(("Can't copy " + archive).toStdString());
+            }
+            if (!done) {
+                QFile::remove(path);
+                QDir(workspaceDir).removeRecursively();
+                emit finished(false, QString(), QString());
+                return;
+            }
+
+            // Ротация: остаются keepCount последних
+            QStringList old = QDir(dir).entryList({prefix + "*.db"}, QDir::Files, QDir::Name | QDir::Reversed);
+            for (int i = keepCount; i < old.size(); ++i) {
+                QFile::remove(QDir(dir).filePath(old[i]));
+                QDir(WorkspaceStorage::directoryFor(QDir(dir).filePath(old[i]))).removeRecursively();
+                QFile::remove(HistoryArchive::pathFor(QDir(dir).filePath(old[i])));
+            }
+
+            qCInfo(lcDb) << "Backup written to" << path;
+            emit finished(true, path, QString());
+        } catch (const std::exception& e) {
+            QFile::remove(path);
+            QFile::remove(HistoryArchive::pathFor(path));
+            QDir(workspaceDir).removeRecursively();
+            qCWarning(lcDb) << "Backup failed:" << e.what();
+            emit finished(false, QString(), QString::fromUtf8(e.what()));
+        }
+    });
+    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+    worker->start(QThread::LowPriority);
+    return true;
+}
+
+void BackupManager::cancel()
+{
+    cancelled.store(true);
+}
+
+bool BackupManager::isRunning() const
+{
+    return worker && !worker->isFinished();
+}
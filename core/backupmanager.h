@@ -0,0 +1,71 @@
+#ifndef BACKUPMANAGER_H
+#define BACKUPMANAGER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+
+// Онлайн-резервное копирование бд в рабочем потоке.
+// С SQLite3 (TASK_MANAGER_HAVE_SQLITE3) - sqlite3_backup_step небольшими порциями страниц
+// внутри читающей транзакции источника: в WAL это согласованный снимок, запись приложения
+// не блокируется. Без него - VACUUM INTO через read-only соединение.
+// Копии: <каталог>/<имя бд>-yyyyMMdd-HHmmss.db (файлы рабочих пр-в - в <копия>-workspaces),
+// хранятся keepCount последних
+class BackupManager : public QObject {
+    Q_OBJECT
+
+public:
+    // Осталось / всего страниц; false - отмена
+    using Progress = std::function<bool(int remaining, int total)>;
+
+    explicit BackupManager(QObject* parent = nullptr);
+    ~BackupManager() override;
+
+    void setDatabasePath(const QString& path);
+    QString databasePath() const { return sourcePath; }
+    // По умолчанию backups рядом с бд
+    void setBackupDirectory(const QString& dir);
+    QString backupDirectory() const;
+    void setKeepCount(int count);
+    int keepCount() const { return keep; }
+
+    // Копирование по расписанию (0 - выключено)
+    void setInterval(int minutes);
+    int interval() const { return intervalMinutes; }
+    // TASK_MANAGER_BACKUP_INTERVAL (минуты), TASK_MANAGER_BACKUP_KEEP, TASK_MANAGER_BACKUP_DIR
+    void configureFromEnvironment();
+
+    // Копии, новые первыми
+    QStringList backups() const;
+
+    // Копирование в рабочем потоке; по окончании - finished()
+    bool start();
+    void cancel();
+    bool isRunning() const;
+
+    // Синхронное копирование source -> destination (через временный .part). Бросает std::runtime_error
+    static bool backup(const QString& source, const QString& destination, const Progress& progress = Progress());
+    // Замена файла бд копией; соединения с бд должны быть закрыты.
+    // Текущий файл сохраняется как <бд>.before-restore
+    static void restore(const QString& backupPath, const QString& databasePath);
+
+signals:
+    void progress(int remaining, int total);
+    void finished(bool ok, const QString& path, const QString& error);
+
+private:
+    QString sourcePath;
+    QString directory;
+    int keep = 7;
+    int intervalMinutes = 0;
+    QTimer timer;
+    QPointer<QThread> worker;
+    std::atomic<bool> cancelled{false};
+};
+
+#endif // BACKUPMANAGER_H
@@ -0,0 +1,606 @@
+#include "changefeed.h"
+#include "taskrepository.h"
+#include "workspacestorage.h"
+#include "applog.h"
+#include "tracer.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Таблица, под каким именем она пишется в журнал, id строки и родитель (прежний: OLD при
+// изменении и удалении); условия записи изменения и удаления (nullptr - всегда); once - не
+// повторять строку, только что записанную этой же пачкой
+struct TriggerSource {
+    const char* table;
+    const char* logged;
+    const char* row;
+    const char* parent;
+    const char* updateWhen;
+    const char* deleteWhen;
+    bool once;
+};
+
+// Очистка помеченных строк в журнал не пишется: для модели они исчезли вместе с пометкой
+const char* const tombstoneChanged = "OLD.deleted = 0 OR NEW.deleted = 0";
+const char* const liveRow = "OLD.deleted = 0";
+const char* const liveCategoryTask = "NOT EXISTS (SELECT 1 FROM Categories WHERE id = OLD.category_id AND deleted = 1)";
+// Каскад при удалении задачи: задача уже удалена (и записана сама, если нужно)
+const char* const liveTaskTag = "EXISTS (SELECT 1 FROM Tasks WHERE id = OLD.task_id)";
+// Последняя запись журнала - та же строка, и сделана она открытой пачкой этого соединения
+// (ChangeLogBatch.seq задан только внутри ее транзакции, у чужих записей он NULL)
+const char* const notJustLogged = "NOT EXISTS (SELECT 1 FROM (SELECT seq, tbl, row_id FROM ChangeLog ORDER BY seq DESC LIMIT 1) "
+                                  "WHERE tbl = '%1' AND row_id = %2 AND seq > (SELECT seq FROM ChangeLogBatch))";
+
+// Теги пишутся строкой задачи: задача с тегами (импорт, добавление) - одна запись, а не 1 + число тегов
+const TriggerSource triggerSources[] = {
+    {"Workspaces", "Workspaces", "id", nullptr, tombstoneChanged, liveRow, false},
+    {"Categories", "Categories", "id", "workspace_id", tombstoneChanged, liveRow, false},
+    {"Tasks", "Tasks", "id", "category_id", nullptr, liveCategoryTask, false},
+    {"TaskTags", "Tasks", "task_id", nullptr, nullptr, liveTaskTag, true},
+    {"TaskHistory", "TaskHistory", "id", nullptr, nullptr, nullptr, false}
+};
+
+struct TaskRow {
+    QString description;
+    int categoryId = 0;
+    QString difficulty;
+    QString priority;
+    QString status;
+    QString deadline;
+    QStringList tags;
+};
+
+void exec(QSqlQuery& query, const QString& sql)
+{
+    if (!query.exec(sql)) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+}
+
+// Транзакция чтения: последовательность, data_version и записи журнала - из одного снимка.
+// Иначе чужая фиксация между чтениями сдвинет версию без своих записей, и они будут пропущены.
+// Внутри открытой пачки записи снимок и так один
+class ReadSnapshot {
+public:
+    explicit ReadSnapshot(TaskRepository& repository)
+        : db(repository.database()), own(!repository.writeCoordinator().hasPending())
+    {
+        if (own && !db.transaction()) {
+            throw std::runtime_error(db.lastError().text().toStdString());
+        }
+    }
+    // Только чтение: фиксация ничего не записывает
+    ~ReadSnapshot() { if (own) db.commit(); }
+
+private:
+    QSqlDatabase db;
+    bool own;
+};
+
+// id через запятую порциями (целые подставляются в текст запроса)
+QStringList idLists(QList<qint64> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    QStringList lists;
+    for (int first = 0; first < ids.size(); first += 500) {
+        QStringList part;
+        for (int i = first; i < qMin(first + 500, int(ids.size())); ++i) {
+            part.append(QString::number(ids[i]));
+        }
+        lists.append(part.join(','));
+    }
+    return lists;
+}
+
+QHash<int, Workspace*> workspacesById(const QMap<QString, Workspace*>& workspaces)
+{
+    QHash<int, Workspace*> result;
+    for (Workspace* workspace : workspaces) {
+        result.insert(workspace->getId(), workspace);
+    }
+    return result;
+}
+
+QHash<int, QPair<Workspace*, Category*>> categoriesById(const QMap<QString, Workspace*>& workspaces)
+{
+    QHash<int, QPair<Workspace*, Category*>> result;
+    for (Workspace* workspace : workspaces) {
+        for (Category* category : workspace->getCategories()) {
+            result.insert(category->getId(), qMakePair(workspace, category));
+        }
+    }
+    return result;
+}
+
+void addTask(const Task* task, ChangeFeed::Delta& delta)
+{
+    delta.addedDescriptions.append(task->getDescription());
+    delta.addedTags += task->getTags();
+}
+
+void forgetTask(const Task* task, ChangeFeed::Delta& delta)
+{
+    delta.removedDescriptions.append(task->getDescription());
+    delta.removedTags += task->getTags();
+}
+
+void forgetCategory(Category* category, ChangeFeed::Delta& delta)
+{
+    delta.removedCategories.append(category->getName());
+    for (const Task* task : category->getTasks()) {
+        forgetTask(task, delta);
+    }
+}
+
+int findTask(Category* category, int taskId)
+{
+    const QVector<Task*>& tasks = category->getTasks();
+    for (int i = 0; i < tasks.size(); ++i) {
+        if (tasks[i]->getId() == taskId) return i;
+    }
+    return -1;
+}
+
+} // namespace
+
+void ChangeFeed::Rows::addCategory(qint64 id, qint64 parent)
+{
+    if (!categories.contains(id)) categories.insert(id, parent);
+}
+
+void ChangeFeed::Rows::addTask(qint64 id, qint64 parent)
+{
+    // Родитель из строки тегов неизвестен - его заменяет первая строка самой задачи
+    if (tasks.value(id, unknownParent) == unknownParent) tasks.insert(id, parent);
+}
+
+bool ChangeFeed::Rows::isEmpty() const
+{
+    return workspaces.isEmpty() && categories.isEmpty() && tasks.isEmpty() && history.isEmpty();
+}
+
+ChangeFeed::ChangeFeed(TaskRepository& repository)
+    : repository(repository)
+{
+}
+
+bool ChangeFeed::createSchema()
+{
+    WriteCoordinator& writes = repository.writeCoordinator();
+    writes.setBatchStatements(QString(), QString());
+
+    // ChangeLogBatch - одна строка: последовательность журнала на начало открытой пачки, вне ее NULL
+    QSqlQuery query(repository.database());
+    if (!query.exec("CREATE TABLE IF NOT EXISTS ChangeLog (seq INTEGER PRIMARY KEY AUTOINCREMENT, "
+                    "tbl TEXT NOT NULL, row_id INTEGER NOT NULL, parent_id INTEGER, "
+                    "changed_at TEXT NOT NULL DEFAULT (datetime('now')));") ||
+        !query.exec("CREATE TABLE IF NOT EXISTS ChangeLogBatch (seq INTEGER);") ||
+        !query.exec("INSERT INTO ChangeLogBatch (seq) SELECT NULL WHERE NOT EXISTS (SELECT 1 FROM ChangeLogBatch);")) {
+        qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+        return false;
+    }
+
+    const QStringList events = {"INSERT", "UPDATE", "DELETE"};
+    for (const TriggerSource& source : triggerSources) {
+        for (const QString& event : events) {
+            const QString row = event == "INSERT" ? "NEW" : "OLD";
+            const QString parent = source.parent ? row + "." + source.parent : QString("NULL");
+            const char* condition = event == "UPDATE" ? source.updateWhen
+                                  : event == "DELETE" ? source.deleteWhen : nullptr;
+            QStringList conditions;
+            if (condition) conditions.append(condition);
+            if (source.once) conditions.append(QString(notJustLogged).arg(source.logged, row + "." + source.row));
+            if (conditions.size() > 1) conditions[0] = "(" + conditions[0] + ")";
+            const QString name = QString("ChangeLog_%1_%2").arg(source.table, event.toLower());
+            const QString sql = QString("CREATE TRIGGER %1 AFTER %2 ON %3%4 "
+                                        "BEGIN INSERT INTO ChangeLog (tbl, row_id, parent_id) VALUES ('%5', %6.%7, %8); END")
+                                    .arg(name, event, source.table,
+                                         conditions.isEmpty() ? QString() : " WHEN " + conditions.join(" AND "),
+                                         source.logged, row, source.row, parent);
+
+            // Триггер прежней версии пересоздается (sqlite_master хранит текст без ';')
+            query.prepare("SELECT sql FROM sqlite_master WHERE type = 'trigger' AND name = :name");
+            query.bindValue(":name", name);
+            if (query.exec() && query.next() && query.value(0).toString() == sql) continue;
+            query.finish();
+            if (!query.exec("DROP TRIGGER IF EXISTS " + name + ";") || !query.exec(sql + ";")) {
+                qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+                return false;
+            }
+        }
+    }
+
+    // Отметка пачки снимается до фиксации: зафиксированное значение всегда NULL, и чужие
+    // записи (другие процессы, старые версии) журнал не прореживают
+    writes.setBatchStatements("UPDATE ChangeLogBatch SET seq = COALESCE((SELECT seq FROM sqlite_sequence "
+                              "WHERE name = 'ChangeLog'), 0);",
+                              "UPDATE ChangeLogBatch SET seq = NULL;");
+    return true;
+}
+
+void ChangeFeed::configureFromEnvironment()
+{
+    bool ok = false;
+    int ms = qEnvironmentVariableIntValue("TASK_MANAGER_SYNC_INTERVAL_MS", &ok);
+    if (ok) setInterval(ms);
+}
+
+qint64 ChangeFeed::lastSequence() const
+{
+    // Счетчик AUTOINCREMENT: учитывает и удаленные очисткой записи
+    QSqlQuery query(repository.database());
+    exec(query, "SELECT seq FROM sqlite_sequence WHERE name = 'ChangeLog';");
+    return query.next() ? query.value(0).toLongLong() : 0;
+}
+
+int ChangeFeed::dataVersion() const
+{
+    QSqlQuery query(repository.database());
+    exec(query, "PRAGMA data_version;");
+    return query.next() ? query.value(0).toInt() : 0;
+}
+
+void ChangeFeed::reset()
+{
+    try {
+        ReadSnapshot snapshot(repository);
+        cursor = lastSequence();
+        knownVersion = dataVersion();
+    } catch (const std::exception& e) {
+        qCWarning(lcDb) << "Error reading change log:" << e.what();
+    }
+    prune();
+}
+
+// Уже прочитанные записи старше keepHours; отстающий дольше процесс увидит пропуск и загрузит модель
+void ChangeFeed::prune()
+{
+    pruneClock.start();
+    if (!repository.transaction()) return;
+    try {
+        QSqlQuery query(repository.database());
+        exec(query, QString("DELETE FROM ChangeLog WHERE seq <= %1 AND changed_at < datetime('now', '-%2 hours');")
+                        .arg(cursor).arg(keepHours));
+        if (!repository.commit()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+    } catch (const std::exception& e) {
+        repository.rollback();
+        qCWarning(lcDb) << "Error pruning change log:" << e.what();
+    }
+}
+
+ChangeFeed::Delta ChangeFeed::sync(QMap<QString, Workspace*>& workspaces, QVector<Task>& taskHistory, bool isEnglish)
+{
+    Delta delta;
+    // Незафиксированная пачка видна этому соединению, но еще может откатиться
+    if (repository.writeCoordinator().hasPending()) return delta;
+
+    Rows changed;
+    {
+        ReadSnapshot snapshot(repository);
+        readChanges(changed, delta);
+    }
+    // Журнал растет с каждым изменением: очистка и во время долгой работы
+    if (pruneClock.hasExpired(pruneIntervalMs)) prune();
+    if (changed.isEmpty()) return delta;
+
+    qCDebug(lcModel) << "Applying external changes";
+    return refresh(changed, workspaces, taskHistory, isEnglish);
+}
+
+void ChangeFeed::readChanges(Rows& changed, Delta& delta)
+{
+    const qint64 last = lastSequence();
+    const int version = dataVersion();
+    if (version == knownVersion) {
+        cursor = last;
+        return;
+    }
+    knownVersion = version;
+    if (last <= cursor) return;
+
+    const qint64 from = cursor;
+    cursor = last;
+    if (last - from > maxChanges) {
+        delta.reloadRequired = true;
+        return;
+    }
+
+    QSqlQuery query(repository.database());
+    query.setForwardOnly(true);
+    exec(query, QString("SELECT tbl, row_id, parent_id FROM ChangeLog WHERE seq > %1 AND seq <= %2 ORDER BY seq;")
+                    .arg(from).arg(last));
+    qint64 rows = 0;
+    while (query.next()) {
+        ++rows;
+        const QString table = query.value(0).toString();
+        const qint64 rowId = query.value(1).toLongLong();
+        const qint64 parentId = query.value(2).isNull() ? unknownParent : query.value(2).toLongLong();
+
+        if (table == "Workspaces") {
+            changed.workspaces.insert(rowId);
+        } else if (table == "Categories") {
+            changed.addCategory(rowId, parentId);
+        } else if (table == "Tasks") {
+            changed.addTask(rowId, parentId);
+        } else if (table == "TaskTags") {
+            // Запись прежней версии (теги теперь пишутся строкой задачи)
+            changed.addTask(rowId, unknownParent);
+        } else if (table == "TaskHistory") {
+            changed.history.insert(rowId);
+        }
+    }
+    query.finish();
+
+    // Пропуски - записи удалены очисткой, пока приложение не опрашивало журнал
+    if (rows < last - from) {
+        changed = Rows();
+        delta.reloadRequired = true;
+    }
+}
+
+ChangeFeed::Delta ChangeFeed::refresh(const Rows& rows, QMap<QString, Workspace*>& workspaces,
+                                      QVector<Task>& taskHistory, bool isEnglish)
+{
+    TRACE_SCOPE("ChangeFeed::refresh", "model");
+    Delta delta;
+    QHash<qint64, qint64> tasks = rows.tasks;
+    applyWorkspaces(rows.workspaces, workspaces, delta);
+    if (!delta.reloadRequired) applyCategories(rows.categories, workspaces, tasks, delta);
+    if (!delta.reloadRequired) applyTasks(tasks, workspaces, delta);
+    if (!delta.reloadRequired) applyHistory(rows.history, taskHistory, isEnglish, delta);
+    return delta;
+}
+
+void ChangeFeed::applyWorkspaces(const QSet<qint64>& ids, QMap<QString, Workspace*>& workspaces, Delta& delta)
+{
+    if (ids.isEmpty()) return;
+
+    QHash<qint64, QString> rows;
+    QSqlQuery query(repository.database());
+    for (const QString& list : idLists(ids.values())) {
+        exec(query, QString("SELECT id, name FROM Workspaces WHERE id IN (%1) AND deleted = 0;").arg(list));
+        while (query.next()) {
+            rows.insert(query.value(0).toLongLong(), query.value(1).toString());
+        }
+    }
+
+    const QHash<int, Workspace*> byId = workspacesById(workspaces);
+    for (qint64 id : ids) {
+        Workspace* current = byId.value(int(id));
+        if (rows.contains(id)) {
+            const QString name = rows[id];
+            if (current) {
+                // Переименование (в приложении его нет) - только полной загрузкой
+                if (current->getName() != name) delta.reloadRequired = true;
+                continue;
+            }
+            if (workspaces.contains(name)) {
+                delta.reloadRequired = true;
+                continue;
+            }
+            workspaces.insert(name, new Workspace(int(id), name));
+            delta.addedWorkspaces.append(name);
+            delta.workspaces.insert(name);
+            delta.rows++;
+        } else if (current) {
+            const QString name = current->getName();
+            for (Category* category : current->getCategories()) {
+                forgetCategory(category, delta);
+            }
+            delete current;
+            workspaces.remove(name);
+            delta.removedWorkspaces.append(name);
+            delta.workspaces.insert(name);
+            delta.rows++;
+        }
+    }
+}
+
+void ChangeFeed::applyCategories(const QHash<qint64, qint64>& ids, QMap<QString, Workspace*>& workspaces,
+                                 QHash<qint64, qint64>& tasks, Delta& delta)
+{
+    if (ids.isEmpty()) return;
+
+    QHash<qint64, QPair<QString, int>> rows;
+    QSqlQuery query(repository.database());
+    for (const QString& list : idLists(ids.keys())) {
+        exec(query, QString("SELECT id, name, workspace_id FROM Categories WHERE id IN (%1) AND deleted = 0;").arg(list));
+        while (query.next()) {
+            rows.insert(query.value(0).toLongLong(), qMakePair(query.value(1).toString(), query.value(2).toInt()));
+        }
+    }
+
+    const QHash<int, Workspace*> workspaceById = workspacesById(workspaces);
+    const QHash<int, QPair<Workspace*, Category*>> categoryById = categoriesById(workspaces);
+    for (auto it = ids.cbegin(); it != ids.cend(); ++it) {
+        const qint64 id = it.key();
+        const QPair<Workspace*, Category*> current = categoryById.value(int(id));
+        if (rows.contains(id)) {
+            const QString name = rows[id].first;
+            Workspace* target = workspaceById.value(rows[id].second);
+            if (current.second) {
+                if (current.second->getName() != name || current.first != target) delta.reloadRequired = true;
+                continue;
+            }
+            // Рабочее пр-во не загружено (удалено этой же пачкой)
+            if (!target) continue;
+            if (target->getCategories().contains(name)) {
+                delta.reloadRequired = true;
+                continue;
+            }
+            target->addCategory(int(id), name);
+            delta.addedCategories.append(name);
+            delta.categories.insert(qMakePair(target->getName(), name));
+            delta.rows++;
+
+            // Снятая пометка удаления: задачи, которые очистка не успела удалить, в журнале не упомянуты
+            QSqlQuery taskQuery(repository.database());
+            exec(taskQuery, QString("SELECT id FROM %1.Tasks WHERE category_id = %2;")
+                                .arg(repository.workspaceStorage().schemaForCategory(int(id))).arg(id));
+            while (taskQuery.next()) {
+                const qint64 taskId = taskQuery.value(0).toLongLong();
+                if (!tasks.contains(taskId)) tasks.insert(taskId, id);
+            }
+        } else if (current.second) {
+            const QString name = current.second->getName();
+            forgetCategory(current.second, delta);
+            current.first->removeCategory(name);
+            delta.categories.insert(qMakePair(current.first->getName(), name));
+            delta.rows++;
+        }
+    }
+}
+
+void ChangeFeed::applyTasks(const QHash<qint64, qint64>& ids, QMap<QString, Workspace*>& workspaces, Delta& delta)
+{
+    if (ids.isEmpty()) return;
+
+    // Задачи рабочих пр-в с файлами - в своей схеме (по диапазону id)
+    QHash<QString, QList<qint64>> bySchema;
+    for (auto it = ids.cbegin(); it != ids.cend(); ++it) {
+        const int id = int(it.key());
+        const QString schema = WorkspaceStorage::isSplitId(id)
+                                   ? repository.workspaceStorage().schemaForTask(id) : QString("main");
+        bySchema[schema].append(it.key());
+    }
+
+    QHash<qint64, TaskRow> rows;
+    QSqlQuery query(repository.database());
+    query.setForwardOnly(true);
+    for (auto schema = bySchema.cbegin(); schema != bySchema.cend(); ++schema) {
+        for (const QString& list : idLists(schema.value())) {
+            exec(query, QString("SELECT id, description, category_id, difficulty, priority, status, deadline "
+                                "FROM %1.Tasks WHERE id IN (%2);").arg(schema.key(), list));
+            while (query.next()) {
+                TaskRow row;
+                row.description = query.value(1).toString();
+                row.categoryId = query.value(2).toInt();
+                row.difficulty = query.value(3).toString();
+                row.priority = query.value(4).toString();
+                row.status = query.value(5).toString();
+                row.deadline = query.value(6).toString();
+                rows.insert(query.value(0).toLongLong(), row);
+            }
+            exec(query, QString("SELECT task_id, tag FROM %1.TaskTags WHERE task_id IN (%2) ORDER BY id;")
+                            .arg(schema.key(), list));
+            while (query.next()) {
+                auto row = rows.find(query.value(0).toLongLong());
+                if (row != rows.end()) row->tags.append(query.value(1).toString());
+            }
+        }
+    }
+
+    const QHash<int, QPair<Workspace*, Category*>> categoryById = categoriesById(workspaces);
+    for (auto it = ids.cbegin(); it != ids.cend(); ++it) {
+        const int id = int(it.key());
+        const bool exists = rows.contains(it.key());
+        const TaskRow row = rows.value(it.key());
+
+        // Где задача в модели: у прежнего родителя или (изменились теги) у текущего
+        QPair<Workspace*, Category*> from;
+        int index = -1;
+        for (qint64 candidate : {it.value(), qint64(row.categoryId)}) {
+            if (candidate == unknownParent || !categoryById.contains(int(candidate))) continue;
+            index = findTask(categoryById[int(candidate)].second, id);
+            if (index >= 0) {
+                from = categoryById[int(candidate)];
+                break;
+            }
+        }
+        const QPair<Workspace*, Category*> target = exists ? categoryById.value(row.categoryId)
+                                                           : QPair<Workspace*, Category*>();
+
+        if (from.second && from.second == target.second) {
+            Task* task = from.second->getTasks()[index];
+            bool changed = false;
+            if (task->getDescription() != row.description || task->getTags() != row.tags) {
+                // Описание и теги без сеттеров: замена объекта
+                forgetTask(task, delta);
+                Task* replacement = new Task(id, row.description, from.second->getName(), row.tags,
+                                             row.difficulty, row.priority, row.status, row.deadline);
+                addTask(replacement, delta);
+                delete task;
+                from.second->getTasks()[index] = replacement;
+                changed = true;
+            } else if (task->getStatus() != row.status || task->getDifficulty() != row.difficulty ||
+                       task->getPriority() != row.priority || task->getDeadline() != row.deadline) {
+                task->setStatus(row.status);
+                task->setDifficulty(row.difficulty);
+                task->setPriority(row.priority);
+                task->setDeadline(row.deadline);
+                changed = true;
+            }
+            if (changed) {
+                delta.categories.insert(qMakePair(from.first->getName(), from.second->getName()));
+                delta.rows++;
+            }
+            continue;
+        }
+
+        if (from.second) {
+            Task* task = from.second->getTasks().takeAt(index);
+            forgetTask(task, delta);
+            delete task;
+            delta.categories.insert(qMakePair(from.first->getName(), from.second->getName()));
+            delta.rows++;
+        }
+        if (target.second) {
+            Task* task = new Task(id, row.description, target.second->getName(), row.tags,
+                                  row.difficulty, row.priority, row.status, row.deadline);
+            target.second->addTask(task);
+            addTask(task, delta);
+            delta.categories.insert(qMakePair(target.first->getName(), target.second->getName()));
+            delta.rows++;
+        }
+    }
+}
+
+void ChangeFeed::applyHistory(const QSet<qint64>& ids, QVector<Task>& taskHistory, bool isEnglish, Delta& delta)
+{
+    if (ids.isEmpty()) return;
+
+    QMap<qint64, Task> rows;
+    QSqlQuery query(repository.database());
+    for (const QString& list : idLists(ids.values())) {
+        exec(query, QString("SELECT id, description, difficulty, priority, status, deadline "
+                            "FROM TaskHistory WHERE id IN (%1);").arg(list));
+        while (query.next()) {
+            // Приведение статуса к текущему языку, как в TaskRepository::loadTaskHistory
+            QString status = query.value(4).toString();
+            if (isEnglish && status == "Завершено") {
+                status = "Completed";
+            } else if (!isEnglish && status == "Completed") {
+                status = "Завершено";
+            }
+            const int id = query.value(0).toInt();
+            rows.insert(id, Task(id, query.value(1).toString(), "", QStringList(), query.value(2).toString(),
+                                 query.value(3).toString(), status, query.value(5).toString()));
+        }
+    }
+
+    // Записи истории не изменяются: только появляются и исчезают
+    for (int i = taskHistory.size() - 1; i >= 0; --i) {
+        const qint64 id = taskHistory[i].getId();
+        if (!ids.contains(id)) continue;
+        if (rows.contains(id)) {
+            rows.remove(id);
+        } else {
+            delta.removedHistoryDescriptions.append(taskHistory[i].getDescription());
+            taskHistory.remove(i);
+            delta.historyChanged = true;
+            delta.rows++;
+        }
+    }
+    for (const Task& task : rows) {
+        taskHistory.append(task);
+        delta.addedHistoryDescriptions.append(task.getDescription());
+        delta.historyChanged = true;
+        delta.rows++;
+    }
+}
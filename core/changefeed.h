@@ -0,0 +1,114 @@
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "taskmodel.h"
+
+class TaskRepository;
+
+// Журнал изменений (CDC): триггеры пишут в ChangeLog таблицу, id строки и прежнего родителя
+// на каждую вставку, изменение и удаление в таблицах модели основной бд. sync() сравнивает
+// PRAGMA data_version (меняется только от чужих фиксаций): без чужих изменений курсор просто
+// сдвигается, иначе затронутые строки перечитываются и модель правится по месту - стоимость
+// пропорциональна числу измененных строк. Свои изменения при этом повторно не меняют модель.
+// Пометка удаления записывается как изменение строки, последующая очистка - не записывается.
+// Задачи рабочих пр-в в отдельных файлах журналом не покрываются
+class ChangeFeed {
+public:
+    // Что изменилось в модели (для индексов, снимков и перерисовки)
+    struct Delta {
+        QStringList addedWorkspaces;
+        QStringList removedWorkspaces;
+        QStringList addedCategories;
+        QStringList removedCategories;
+        QStringList addedDescriptions;
+        QStringList removedDescriptions;
+        QStringList addedHistoryDescriptions;
+        QStringList removedHistoryDescriptions;
+        QStringList addedTags;
+        QStringList removedTags;
+        QSet<QString> workspaces;                     // пересобрать целиком
+        QSet<QPair<QString, QString>> categories;     // рабочее пр-во, категория
+        bool historyChanged = false;
+        // Журнал обрезан, изменений больше maxChanges или изменились имена: нужна полная загрузка
+        bool reloadRequired = false;
+        int rows = 0;
+
+        bool isEmpty() const { return rows == 0 && !reloadRequired; }
+    };
+
+    // Затронутые строки; для категорий и задач - родитель, которого видит модель (unknownParent - неизвестен)
+    struct Rows {
+        QSet<qint64> workspaces;
+        QHash<qint64, qint64> categories;
+        QHash<qint64, qint64> tasks;
+        QSet<qint64> history;
+
+        // Первое упоминание строки хранит родителя
+        void addCategory(qint64 id, qint64 parent);
+        void addTask(qint64 id, qint64 parent);
+        bool isEmpty() const;
+    };
+
+    static constexpr qint64 unknownParent = -1;
+
+    // Больше - дешевле загрузить модель заново
+    static const int maxChanges = 5000;
+    // Прочитанные записи журнала старше этого удаляются при reset() и раз в pruneIntervalMs при sync()
+    static const int keepHours = 24;
+    static const int pruneIntervalMs = 10 * 60 * 1000;
+
+    explicit ChangeFeed(TaskRepository& repository);
+
+    // Таблица ChangeLog и триггеры (после createSchema репозитория); пачки записи репозитория
+    // отмечают свое начало, чтобы теги задачи не повторяли ее строку в журнале
+    bool createSchema();
+
+    // Интервал опроса в мс (0 - выключено)
+    int interval() const { return intervalMs; }
+    void setInterval(int ms) { intervalMs = qMax(0, ms); }
+    // TASK_MANAGER_SYNC_INTERVAL_MS
+    void configureFromEnvironment();
+
+    // Отсчет от текущего состояния бд (сразу после загрузки модели) и очистка старого журнала
+    void reset();
+
+    // Применение чужих изменений к модели. Пока открыта пачка записи - ничего не делает.
+    // Бросает std::runtime_error; при reloadRequired модель могла измениться частично
+    Delta sync(QMap<QString, Workspace*>& workspaces, QVector<Task>& taskHistory, bool isEnglish);
+
+    // Перечитывание указанных строк и правка модели (в т.ч. после своих изменений, напр. отмены)
+    Delta refresh(const Rows& rows, QMap<QString, Workspace*>& workspaces, QVector<Task>& taskHistory,
+                  bool isEnglish);
+
+private:
+    qint64 lastSequence() const;
+    int dataVersion() const;
+    // Курсор, версия и затронутые строки (в одной транзакции чтения)
+    void readChanges(Rows& changed, Delta& delta);
+    void prune();
+
+    void applyWorkspaces(const QSet<qint64>& ids, QMap<QString, Workspace*>& workspaces, Delta& delta);
+    // Задачи появившихся категорий добавляются в tasks
+    void applyCategories(const QHash<qint64, qint64>& ids, QMap<QString, Workspace*>& workspaces,
+                         QHash<qint64, qint64>& tasks, Delta& delta);
+    void applyTasks(const QHash<qint64, qint64>& ids, QMap<QString, Workspace*>& workspaces, Delta& delta);
+    void applyHistory(const QSet<qint64>& ids, QVector<Task>& taskHistory, bool isEnglish, Delta& delta);
+
+    TaskRepository& repository;
+    qint64 cursor = 0;
+    int knownVersion = -1;
+    QElapsedTimer pruneClock;
+    int intervalMs = 1000;
+};
+
+#endif // CHANGEFEED_H
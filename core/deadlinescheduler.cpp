@@ -0,0 +1,43 @@
+#include "deadlinescheduler.h"
+#include "tracer.h"
+
+int DeadlineScheduler::checkDeadlines(QMap<QString, Workspace*>& workspaces, QVector<Notification>& notifications,
+                                      const QDate& date)
+{
+    TRACE_SCOPE("DeadlineScheduler::checkDeadlines", "model");
+    int added = 0;
+
+    // Перебор
+    for (auto workspaceIt = workspaces.begin(); workspaceIt != workspaces.end(); ++workspaceIt) {
+        QMap<QString, Category*>& categories = workspaceIt.value()->getCategories();
+        for (auto categoryIt = categories.begin(); categoryIt != categories.end(); ++categoryIt) {
+            QVector<Task*>& tasks = categoryIt.value()->getTasks();
+            for (Task *task : tasks) {
+                QString taskDeadline = task->getDeadline();
+                if (!taskDeadline.isEmpty()) {
+                    QDate deadlineDate = QDate::fromString(taskDeadline, "dd-MM-yyyy");
+                    if (deadlineDate.isValid() && deadlineDate == date) {
+
+                        // Пр-ка
+                        bool exists = false;
+                        for (const Notification &n : notifications) {
+                            if (n.getTaskDescription() == task->getDescription() &&
+                                n.getDeadline() == taskDeadline) {
+                                exists = true;
+                                break;
+                            }
+                        }
+
+                        // Добавление нового уведомления
+                        if (!exists) {
+                            notifications.append(Notification(task->getDescription(), taskDeadline));
+                            added++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return added;
+}
@@ -0,0 +1,19 @@
+#ifndef DEADLINESCHEDULER_H
+#define DEADLINESCHEDULER_H
+
+#include <QDate>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "taskmodel.h"
+
+// Проверка сроков задач и формирование уведомлений
+class DeadlineScheduler {
+public:
+    // Добавляет уведомления о задачах со сроком на date (без дублей), возвращает число новых
+    static int checkDeadlines(QMap<QString, Workspace*>& workspaces, QVector<Notification>& notifications,
+                              const QDate& date = QDate::currentDate());
+};
+
+#endif // DEADLINESCHEDULER_H
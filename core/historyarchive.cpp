@@ -0,0 +1,357 @@
+#include "historyarchive.h"
+#include "taskrepository.h"
+#include "applog.h"
+#include "tracer.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <stdexcept>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const quint32 blockMagic = 0x54484142; // "THAB"
+const quint32 formatVersion = 1;
+// magic, version, size, checksum, rows, firstId, lastId, archivedAt
+const qint64 headerSize = 7 * 4 + 8;
+
+const QChar tagSeparator(31);
+
+// QFile::flush() отдает данные только ОС: без fsync сбой питания после удаления из бд потеряет блок
+bool syncToDisk(QFile& file)
+{
+#ifdef Q_OS_WIN
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+QVector<HistoryArchive::Entry> decode(QFile& file, const HistoryArchive::Block& block)
+{
+    QVector<HistoryArchive::Entry> entries;
+    if (!file.seek(block.offset + headerSize)) return entries;
+
+    QByteArray data = file.read(block.size);
+    if (data.size() != qsizetype(block.size) || qChecksum(data) != block.checksum) {
+        qCWarning(lcDb) << "History archive: damaged block at" << block.offset;
+        return entries;
+    }
+
+    QByteArray payload = qUncompress(data);
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    entries.reserve(block.rows);
+    for (quint32 i = 0; i < block.rows; ++i) {
+        HistoryArchive::Entry entry;
+        qint32 id = 0;
+        in >> id >> entry.description >> entry.difficulty >> entry.priority >> entry.status >> entry.deadline
+           >> entry.completedAt >> entry.workspace >> entry.category >> entry.tags;
+        if (in.status() != QDataStream::Ok) {
+            qCWarning(lcDb) << "History archive: can't decode block at" << block.offset;
+            return {};
+        }
+        entry.id = id;
+        entries.append(entry);
+    }
+    return entries;
+}
+
+bool matches(const HistoryArchive::Entry& entry, const QString& text)
+{
+    if (entry.description.contains(text, Qt::CaseInsensitive) ||
+        entry.category.contains(text, Qt::CaseInsensitive) ||
+        entry.workspace.contains(text, Qt::CaseInsensitive)) {
+        return true;
+    }
+    for (const QString& tag : entry.tags) {
+        if (tag.contains(text, Qt::CaseInsensitive)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+QString HistoryArchive::pathFor(const QString& databasePath)
+{
+    return databasePath + ".history-archive";
+}
+
+bool HistoryArchive::open(const QString& path)
+{
+    filePath = path;
+    index.clear();
+
+    QFile file(path);
+    if (!file.exists()) return true;
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(lcDb) << "Can't open history archive:" << file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    qint64 offset = 0;
+    while (offset + headerSize <= size) {
+        file.seek(offset);
+        QDataStream in(file.read(headerSize));
+        quint32 magic = 0;
+        quint32 version = 0;
+        Block block;
+        in >> magic >> version >> block.size >> block.checksum >> block.rows
+           >> block.firstId >> block.lastId >> block.archivedAt;
+        if (magic != blockMagic || version != formatVersion || offset + headerSize + block.size > size) break;
+
+        block.offset = offset;
+        index.append(block);
+        offset += headerSize + block.size;
+    }
+    file.close();
+
+    // Хвост от прерванной записи
+    if (offset < size) {
+        qCWarning(lcDb) << "History archive: removing" << size - offset << "bytes of incomplete block";
+        QFile::resize(path, offset);
+    }
+    return true;
+}
+
+void HistoryArchive::configureFromEnvironment()
+{
+    bool ok = false;
+    int days = qEnvironmentVariableIntValue("TASK_MANAGER_HISTORY_RETENTION_DAYS", &ok);
+    if (ok) setRetentionDays(days);
+}
+
+qint64 HistoryArchive::rowCount() const
+{
+    qint64 rows = 0;
+    for (const Block& block : index) rows += block.rows;
+    return rows;
+}
+
+void HistoryArchive::append(const QVector<Entry>& entries, qint64 archivedAt)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+
+    QVector<Block> written;
+    qint64 offset = file.size();
+    for (int first = 0; first < entries.size(); first += blockRows) {
+        const int count = qMin(blockRows, int(entries.size()) - first);
+
+        QByteArray payload;
+        {
+            QDataStream out(&payload, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_6_0);
+            for (int i = first; i < first + count; ++i) {
+                const Entry& entry = entries[i];
+                out << qint32(entry.id) << entry.description << entry.difficulty << entry.priority << entry.status
+                    << entry.deadline << entry.completedAt << entry.workspace << entry.category << entry.tags;
+            }
+        }
+        const QByteArray data = qCompress(payload);
+
+        Block block;
+        block.offset = offset;
+        block.size = quint32(data.size());
+        block.checksum = qChecksum(data);
+        block.rows = quint32(count);
+        block.firstId = entries[first].id;
+        block.lastId = entries[first + count - 1].id;
+        block.archivedAt = archivedAt;
+
+        QByteArray header;
+        {
+            QDataStream out(&header, QIODevice::WriteOnly);
+            out << blockMagic << formatVersion << block.size << block.checksum << block.rows
+                << block.firstId << block.lastId << block.archivedAt;
+        }
+
+        if (file.write(header) != header.size() || file.write(data) != data.size()) {
+            throw std::runtime_error(file.errorString().toStdString());
+        }
+        offset += header.size() + data.size();
+        written.append(block);
+    }
+
+    if (!file.flush()) {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+    if (!syncToDisk(file)) {
+        throw std::runtime_error("Can't sync history archive to disk");
+    }
+    index += written;
+}
+
+int HistoryArchive::archive(TaskRepository& repository)
+{
+    if (retention <= 0 || filePath.isEmpty()) return 0;
+    TRACE_SCOPE("HistoryArchive::archive", "sql");
+    QSqlDatabase db = repository.database();
+    repository.flush();
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT h.id, h.description, h.difficulty, h.priority, h.status, h.deadline, h.completed_at, "
+                  "w.name, c.name, "
+                  "(SELECT group_concat(tag, char(31)) FROM TaskHistoryTags t WHERE t.history_id = h.id) "
+                  "FROM TaskHistory h "
+                  "LEFT JOIN Categories c ON c.id = h.category_id "
+                  "LEFT JOIN Workspaces w ON w.id = c.workspace_id "
+                  "WHERE h.completed_at < datetime('now', :age) ORDER BY h.id");
+    query.bindValue(":age", QString("-%1 days").arg(retention));
+    if (!query.exec()) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+
+    QVector<Entry> entries;
+    while (query.next()) {
+        Entry entry;
+        entry.id = query.value(0).toInt();
+        entry.description = query.value(1).toString();
+        entry.difficulty = query.value(2).toString();
+        entry.priority = query.value(3).toString();
+        entry.status = query.value(4).toString();
+        entry.deadline = query.value(5).toString();
+        entry.completedAt = query.value(6).toString();
+        entry.workspace = query.value(7).toString();
+        entry.category = query.value(8).toString();
+        entry.tags = query.value(9).toString().split(tagSeparator, Qt::SkipEmptyParts);
+        entries.append(entry);
+    }
+    query.finish();
+    if (entries.isEmpty()) return 0;
+
+    // Сначала файл (на диске), потом удаление из бд: сбой между ними чинит reconcile()
+    const qint64 previousSize = QFileInfo(filePath).size();
+    const int previousBlocks = index.size();
+    auto undo = [&]() {
+        QFile::resize(filePath, previousSize);
+        index.resize(previousBlocks);
+    };
+
+    try {
+        append(entries, QDateTime::currentSecsSinceEpoch());
+    } catch (...) {
+        undo();
+        throw;
+    }
+
+    try {
+        // Без транзакции строки удалялись бы по одной, и откат после ошибки обрезал бы архив
+        // с записями, которых в бд уже нет
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+        QSqlQuery remove(db);
+        if (!remove.prepare("DELETE FROM TaskHistory WHERE id = :id")) {
+            throw std::runtime_error(remove.lastError().text().toStdString());
+        }
+        for (const Entry& entry : entries) {
+            remove.bindValue(":id", entry.id);
+            if (!remove.exec()) {
+                throw std::runtime_error(remove.lastError().text().toStdString());
+            }
+        }
+        if (!repository.commit()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+    } catch (...) {
+        repository.rollback();
+        undo();
+        throw;
+    }
+    if (!repository.flush()) {
+        undo();
+        throw std::runtime_error("Can't commit archived history");
+    }
+
+    qCInfo(lcDb) << "Archived" << entries.size() << "history entries older than" << retention << "days";
+    return entries.size();
+}
+
+void HistoryArchive::reconcile(TaskRepository& repository)
+{
+    if (index.isEmpty()) return;
+    const Block last = index.last();
+
+    // Записи одного запуска удаляются одной транзакцией: достаточно проверить последнюю
+    QSqlQuery query(repository.database());
+    query.prepare("SELECT 1 FROM TaskHistory WHERE id = :id");
+    query.bindValue(":id", last.lastId);
+    if (!query.exec() || !query.next()) return;
+    query.finish();
+
+    QVector<int> ids;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    for (const Block& block : index) {
+        if (block.archivedAt != last.archivedAt) continue;
+        for (const Entry& entry : decode(file, block)) {
+            ids.append(entry.id);
+        }
+    }
+
+    try {
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+        QSqlQuery remove(repository.database());
+        if (!remove.prepare("DELETE FROM TaskHistory WHERE id = :id")) {
+            throw std::runtime_error(remove.lastError().text().toStdString());
+        }
+        for (int id : ids) {
+            remove.bindValue(":id", id);
+            if (!remove.exec()) {
+                throw std::runtime_error(remove.lastError().text().toStdString());
+            }
+        }
+        if (!repository.commit() || !repository.flush()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+        qCInfo(lcDb) << "History archive: removed" << ids.size() << "already archived entries from the database";
+    } catch (const std::exception& e) {
+        repository.rollback();
+        qCWarning(lcDb) << "History archive reconcile failed:" << e.what();
+    }
+}
+
+QVector<HistoryArchive::Entry> HistoryArchive::search(const QString& text, int limit) const
+{
+    TRACE_SCOPE_DETAIL("HistoryArchive::search", "search", text);
+    QVector<Entry> results;
+    const QString needle = text.trimmed();
+
+    QFile file(filePath);
+    if (index.isEmpty() || !file.open(QIODevice::ReadOnly)) return results;
+
+    // Новые блоки первыми
+    for (int i = index.size() - 1; i >= 0 && results.size() < limit; --i) {
+        for (const Entry& entry : decode(file, index[i])) {
+            if (needle.isEmpty() || matches(entry, needle)) {
+                results.append(entry);
+                if (results.size() >= limit) break;
+            }
+        }
+    }
+    return results;
+}
+
+QVector<HistoryArchive::Entry> HistoryArchive::readBlock(const Block& block) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return {};
+    return decode(file, block);
+}
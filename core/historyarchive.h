@@ -0,0 +1,77 @@
+#ifndef HISTORYARCHIVE_H
+#define HISTORYARCHIVE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class TaskRepository;
+
+// Холодный архив истории: записи TaskHistory старше retentionDays переносятся в файл
+// <бд>.history-archive и не загружаются при старте. Файл только дописывается блоками
+// по blockRows записей, каждый блок сжат qCompress и имеет заголовок фиксированного
+// размера (число записей, диапазон id, размер, контрольная сумма) - индекс блоков
+// строится при открытии чтением одних заголовков. Поиск по архиву - по запросу, с распаковкой
+class HistoryArchive {
+public:
+    struct Entry {
+        int id = 0;
+        QString description;
+        QString difficulty;
+        QString priority;
+        QString status;
+        QString deadline;
+        QString completedAt;    // UTC, yyyy-MM-dd HH:mm:ss
+        QString workspace;      // имена на момент архивации
+        QString category;
+        QStringList tags;
+    };
+
+    struct Block {
+        qint64 offset = 0;      // начало заголовка
+        quint32 size = 0;       // сжатые данные без заголовка
+        quint32 checksum = 0;
+        quint32 rows = 0;
+        qint32 firstId = 0;
+        qint32 lastId = 0;
+        qint64 archivedAt = 0;  // общая метка одного запуска archive()
+    };
+
+    static const int blockRows = 1000;
+
+    // <бд>.history-archive
+    static QString pathFor(const QString& databasePath);
+
+    // Чтение индекса; поврежденный хвост (запись, прерванная сбоем) отрезается
+    bool open(const QString& path);
+    QString path() const { return filePath; }
+
+    // 0 - архивация выключена
+    void setRetentionDays(int days) { retention = qMax(0, days); }
+    int retentionDays() const { return retention; }
+    // TASK_MANAGER_HISTORY_RETENTION_DAYS
+    void configureFromEnvironment();
+
+    // Перенос старых записей (одна транзакция после записи файла), возвращает их число.
+    // Бросает std::runtime_error; при ошибке файл возвращается к прежнему размеру
+    int archive(TaskRepository& repository);
+    // Удаление из бд записей последнего запуска, если сбой случился между записью файла и фиксацией
+    void reconcile(TaskRepository& repository);
+
+    const QVector<Block>& blocks() const { return index; }
+    qint64 rowCount() const;
+
+    // Записи, где text входит в описание, теги, категорию или рабочее пр-во (без учета регистра)
+    QVector<Entry> search(const QString& text, int limit = 200) const;
+    // Записи одного блока (пустой вектор - блок поврежден)
+    QVector<Entry> readBlock(const Block& block) const;
+
+private:
+    void append(const QVector<Entry>& entries, qint64 archivedAt);
+
+    QString filePath;
+    QVector<Block> index;
+    int retention = 0;
+};
+
+#endif // HISTORYARCHIVE_H
@@ -0,0 +1,245 @@
+#include "memoryaccounting.h"
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QSet>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#ifdef TASK_MANAGER_COUNTING_ALLOCATOR
+
+// Считающий allocator: перед блоком хранится его размер (заголовок выровнен
+// как max_align_t, чтобы не нарушать выравнивание обычного new)
+namespace {
+
+std::atomic<qint64> liveBytes{0};
+std::atomic<qint64> liveAllocations{0};
+std::atomic<qint64> peakBytes{0};
+std::atomic<qint64> totalAllocations{0};
+
+constexpr std::size_t headerSize = alignof(std::max_align_t) > sizeof(std::size_t)
+                                       ? alignof(std::max_align_t) : sizeof(std::size_t);
+
+void* countedAlloc(std::size_t size) noexcept
+{
+    void* block = std::malloc(size + headerSize);
+    if (!block) return nullptr;
+
+    *static_cast<std::size_t*>(block) = size;
+    qint64 live = liveBytes.fetch_add(qint64(size), std::memory_order_relaxed) + qint64(size);
+    liveAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    qint64 peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return static_cast<char*>(block) + headerSize;
+}
+
+void countedFree(void* pointer) noexcept
+{
+    if (!pointer) return;
+
+    void* block = static_cast<char*>(pointer) - headerSize;
+    std::size_t size = *static_cast<std::size_t*>(block);
+    liveBytes.fetch_sub(qint64(size), std::memory_order_relaxed);
+    liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+    std::free(block);
+}
+
+void* countedNew(std::size_t size)
+{
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* pointer = countedAlloc(size)) return pointer;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedNew(size); }
+void* operator new[](std::size_t size) { return countedNew(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size ? size : 1); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size ? size : 1); }
+void operator delete(void* pointer) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+
+AllocatorStats MemoryAccounting::allocatorStats()
+{
+    AllocatorStats stats;
+    stats.available = true;
+    stats.liveBytes = liveBytes.load(std::memory_order_relaxed);
+    stats.liveAllocations = liveAllocations.load(std::memory_order_relaxed);
+    stats.peakBytes = peakBytes.load(std::memory_order_relaxed);
+    stats.totalAllocations = totalAllocations.load(std::memory_order_relaxed);
+    return stats;
+}
+
+#else
+
+AllocatorStats MemoryAccounting::allocatorStats()
+{
+    return AllocatorStats();
+}
+
+#endif // TASK_MANAGER_COUNTING_ALLOCATOR
+
+qint64 MemoryAccounting::residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return -1;
+}
+
+qint64 MemoryAccounting::stringBytes(const QString& text)
+{
+    if (text.isNull()) return 0;
+    return qint64(sizeof(QArrayData)) + qint64(text.capacity() + 1) * qint64(sizeof(QChar));
+}
+
+namespace {
+
+// Размер узла QMap (std::map): ключ, значение и служебные указатели
+template <typename Key, typename Value>
+qint64 mapNodeBytes()
+{
+    return qint64(sizeof(Key) + sizeof(Value) + 4 * sizeof(void*));
+}
+
+qint64 taskBytes(const Task& task, bool countObject)
+{
+    qint64 bytes = countObject ? qint64(sizeof(Task)) : 0;
+    bytes += MemoryAccounting::stringBytes(task.getDescription());
+    bytes += MemoryAccounting::stringBytes(task.getCategory());
+    bytes += MemoryAccounting::stringBytes(task.getDifficulty());
+    bytes += MemoryAccounting::stringBytes(task.getPriority());
+    bytes += MemoryAccounting::stringBytes(task.getStatus());
+    bytes += MemoryAccounting::stringBytes(task.getDeadline());
+
+    QStringList tags = task.getTags();
+    if (!tags.isEmpty()) {
+        bytes += qint64(sizeof(QArrayData)) + tags.capacity() * qint64(sizeof(QString));
+    }
+    return bytes;
+}
+
+} // namespace
+
+QVector<MemoryUsage> MemoryAccounting::modelUsage(const QMap<QString, Workspace*>& workspaces,
+                                                  const QVector<Task>& taskHistory,
+                                                  const QVector<Notification>& notifications)
+{
+    MemoryUsage workspaceUsage{"workspaces"};
+    MemoryUsage categoryUsage{"categories"};
+    MemoryUsage taskUsage{"tasks"};
+    MemoryUsage tagUsage{"tag strings"};
+    MemoryUsage distinctTagUsage{"tag texts (distinct)"};
+    MemoryUsage historyUsage{"history"};
+    MemoryUsage notificationUsage{"notifications"};
+
+    // Общие буферы тегов считаются один раз
+    QSet<const void*> tagBuffers;
+    QSet<QString> tagTexts;
+    auto countTags = [&](const QStringList& tags) {
+        for (const QString& tag : tags) {
+            tagUsage.objects++;
+            if (!tagBuffers.contains(tag.constData())) {
+                tagBuffers.insert(tag.constData());
+                tagUsage.bytes += stringBytes(tag);
+            }
+            if (!tagTexts.contains(tag)) {
+                tagTexts.insert(tag);
+                distinctTagUsage.objects++;
+                distinctTagUsage.bytes += stringBytes(tag);
+            }
+        }
+    };
+
+    for (auto workspaceIt = workspaces.begin(); workspaceIt != workspaces.end(); ++workspaceIt) {
+        Workspace* workspace = workspaceIt.value();
+        workspaceUsage.objects++;
+        workspaceUsage.bytes += qint64(sizeof(Workspace)) + stringBytes(workspace->getName())
+                                + mapNodeBytes<QString, Workspace*>() + stringBytes(workspaceIt.key());
+
+        const QMap<QString, Category*>& categories = workspace->getCategories();
+        for (auto categoryIt = categories.begin(); categoryIt != categories.end(); ++categoryIt) {
+            Category* category = categoryIt.value();
+            categoryUsage.objects++;
+            categoryUsage.bytes += qint64(sizeof(Category)) + stringBytes(category->getName())
+                                   + mapNodeBytes<QString, Category*>()
+                                   + category->getTasks().capacity() * qint64(sizeof(Task*));
+
+            for (const Task* task : category->getTasks()) {
+                taskUsage.objects++;
+                taskUsage.bytes += taskBytes(*task, true);
+                countTags(task->getTags());
+            }
+        }
+    }
+
+    historyUsage.bytes += taskHistory.capacity() * qint64(sizeof(Task));
+    for (const Task& task : taskHistory) {
+        historyUsage.objects++;
+        historyUsage.bytes += taskBytes(task, false);
+        countTags(task.getTags());
+    }
+
+    notificationUsage.bytes += notifications.capacity() * qint64(sizeof(Notification));
+    for (const Notification& notification : notifications) {
+        notificationUsage.objects++;
+        notificationUsage.bytes += stringBytes(notification.getMessage())
+                                   + stringBytes(notification.getTaskDescription())
+                                   + stringBytes(notification.getDeadline());
+    }
+
+    return {workspaceUsage, categoryUsage, taskUsage, tagUsage, distinctTagUsage,
+            historyUsage, notificationUsage};
+}
+
+QJsonObject MemoryAccounting::toJson(const QVector<MemoryUsage>& usage)
+{
+    QJsonArray structures;
+    for (const MemoryUsage& entry : usage) {
+        QJsonObject object;
+        object["name"] = entry.name;
+        object["objects"] = double(entry.objects);
+        object["bytes"] = double(entry.bytes);
+        structures.append(object);
+    }
+
+    AllocatorStats stats = allocatorStats();
+    QJsonObject allocator;
+    allocator["available"] = stats.available;
+    if (stats.available) {
+        allocator["live_bytes"] = double(stats.liveBytes);
+        allocator["live_allocations"] = double(stats.liveAllocations);
+        allocator["peak_bytes"] = double(stats.peakBytes);
+        allocator["total_allocations"] = double(stats.totalAllocations);
+    }
+
+    QJsonObject root;
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["resident_bytes"] = double(residentBytes());
+    root["allocator"] = allocator;
+    root["structures"] = structures;
+    return root;
+}
@@ -0,0 +1,47 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "taskmodel.h"
+
+// Объем одной структуры
+struct MemoryUsage {
+    QString name;
+    qint64 objects = 0;
+    qint64 bytes = 0;
+};
+
+// Счетчики глобального operator new/delete (сборка с TASK_MANAGER_COUNTING_ALLOCATOR).
+// Буферы QString/QVector выделяются через malloc и сюда не попадают - их
+// учитывает оценка по структурам
+struct AllocatorStats {
+    bool available = false;
+    qint64 liveBytes = 0;
+    qint64 liveAllocations = 0;
+    qint64 peakBytes = 0;
+    qint64 totalAllocations = 0;
+};
+
+// Отчет о памяти модели: байты и число объектов по структурам
+class MemoryAccounting {
+public:
+    static AllocatorStats allocatorStats();
+
+    // Резидентная память процесса (Linux, иначе -1)
+    static qint64 residentBytes();
+
+    // Заголовок + буфер строки (общий буфер считать один раз - дело вызывающего)
+    static qint64 stringBytes(const QString& text);
+
+    static QVector<MemoryUsage> modelUsage(const QMap<QString, Workspace*>& workspaces,
+                                           const QVector<Task>& taskHistory,
+                                           const QVector<Notification>& notifications);
+
+    static QJsonObject toJson(const QVector<MemoryUsage>& usage);
+};
+
+#endif // MEMORYACCOUNTING_H
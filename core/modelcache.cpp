@@ -0,0 +1,430 @@
+#include "modelcache.h"
+#include "applog.h"
+#include "tracer.h"
+#include "workspacestorage.h"
+#include <QFile>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+const char magic[8] = {'T', 'M', 'C', 'A', 'C', 'H', 'E', '1'};
+const quint32 formatVersion = 1;
+const quint32 byteOrderMark = 0x01020304;
+
+// Заголовок и записи - в порядке байт машины (другой порядок - снимок не используется)
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    quint64 token;
+    quint32 stringCount;
+    quint32 workspaceCount;
+    quint32 categoryCount;
+    quint32 taskCount;
+    quint32 tagRefCount;
+    quint32 historyCount;
+    quint64 stringBytes;    // размер блока символов (UTF-16)
+};
+
+struct WorkspaceRecord {
+    qint32 id;
+    quint32 name;
+};
+
+struct CategoryRecord {
+    qint32 id;
+    quint32 workspace;      // индекс в workspaces
+    quint32 name;
+};
+
+struct TaskRecord {
+    qint32 id;
+    quint32 category;       // индекс в categories
+    quint32 description;
+    quint32 difficulty;
+    quint32 priority;
+    quint32 status;
+    quint32 deadline;
+    quint32 firstTag;       // индекс в tagRefs
+    quint32 tagCount;
+};
+
+struct CachedHistory {
+    qint32 id;
+    quint32 description;
+    quint32 difficulty;
+    quint32 priority;
+    quint32 status;
+    quint32 deadline;
+};
+
+static_assert(std::is_trivially_copyable<Header>::value, "Header must be POD");
+
+// Таблица строк: одна копия каждой строки
+class StringTable {
+public:
+    quint32 intern(const QString& value)
+    {
+        auto it = indexes.constFind(value);
+        if (it != indexes.constEnd()) return it.value();
+        quint32 index = quint32(strings.size());
+        indexes.insert(value, index);
+        strings.append(value);
+        return index;
+    }
+
+    QStringList strings;
+
+private:
+    QHash<QString, quint32> indexes;
+};
+
+template <typename T>
+void append(QByteArray& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void appendVector(QByteArray& out, const QVector<T>& values)
+{
+    if (!values.isEmpty()) {
+        out.append(reinterpret_cast<const char*>(values.constData()), qsizetype(sizeof(T)) * values.size());
+    }
+}
+
+// Последовательное чтение из отображенного файла с проверкой границ
+class Reader {
+public:
+    Reader(const uchar* data, qint64 size) : data(data), size(size) {}
+
+    template <typename T>
+    const T* take(quint64 count)
+    {
+        if (!ok) return nullptr;
+        quint64 bytes = count * sizeof(T);
+        if (count != 0 && bytes / count != sizeof(T)) {
+            ok = false;
+            return nullptr;
+        }
+        // Выравнивание до 8 байт между секциями
+        quint64 aligned = (offset + 7) & ~quint64(7);
+        if (aligned + bytes > quint64(size)) {
+            ok = false;
+            return nullptr;
+        }
+        offset = aligned + bytes;
+        return reinterpret_cast<const T*>(data + aligned);
+    }
+
+    bool ok = true;
+
+private:
+    const uchar* data;
+    qint64 size;
+    quint64 offset = 0;
+};
+
+void alignTo8(QByteArray& out)
+{
+    while (out.size() % 8 != 0) out.append('\0');
+}
+
+quint64 currentToken(const QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT token FROM ModelCacheState LIMIT 1;") || !query.next()) return 0;
+    return query.value(0).toULongLong();
+}
+
+QString historyStatus(QString status, bool isEnglish)
+{
+    // Приведение статуса к текущему языку, как в TaskRepository::loadTaskHistory
+    if (isEnglish && status == "Завершено") {
+        status = "Completed";
+    } else if (!isEnglish && status == "Completed") {
+        status = "Завершено";
+    }
+    return status;
+}
+
+} // namespace
+
+QString ModelCache::cachePath(const QString& databasePath)
+{
+    return databasePath + ".modelcache";
+}
+
+bool ModelCache::createSchema(const QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TABLE IF NOT EXISTS ModelCacheState (token INTEGER NOT NULL);")) {
+        qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+        return false;
+    }
+
+    // Триггеры дешевы, пока токена нет (т.е. все время работы приложения): EXISTS по пустой таблице
+    const QStringList tables = {"Workspaces", "Categories", "Tasks", "TaskTags", "TaskHistory", "TaskHistoryTags"};
+    const QStringList events = {"INSERT", "UPDATE", "DELETE"};
+    for (const QString& table : tables) {
+        for (const QString& event : events) {
+            QString sql = QString("CREATE TRIGGER IF NOT EXISTS ModelCache_%1_%2 AFTER %3 ON %1 "
+                                  "WHEN EXISTS (SELECT 1 FROM ModelCacheState) "
+                                  "BEGIN DELETE FROM ModelCacheState; END;")
+                              .arg(table, event.toLower(), event);
+            if (!query.exec(sql)) {
+                qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ModelCache::load(const QString& path, const QSqlDatabase& db, QMap<QString, Workspace*>& workspaces,
+                      QVector<Task>& taskHistory, bool isEnglish)
+{
+    TRACE_SCOPE("ModelCache::load", "model");
+
+    quint64 token = currentToken(db);
+    if (token == 0) return false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = file.size();
+    const uchar* data = file.map(0, size);
+    if (!data) return false;
+
+    Reader reader(data, size);
+    const Header* header = reader.take<Header>(1);
+    if (!header || std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != formatVersion ||
+        header->byteOrder != byteOrderMark || header->token != token) {
+        qCInfo(lcModel) << "Model cache is stale, loading from the database";
+        return false;
+    }
+
+    const quint32* stringLengths = reader.take<quint32>(header->stringCount);
+    const WorkspaceRecord* workspaceRecords = reader.take<WorkspaceRecord>(header->workspaceCount);
+    const CategoryRecord* categoryRecords = reader.take<CategoryRecord>(header->categoryCount);
+    const TaskRecord* taskRecords = reader.take<TaskRecord>(header->taskCount);
+    const quint32* tagRefs = reader.take<quint32>(header->tagRefCount);
+    const CachedHistory* historyRecords = reader.take<CachedHistory>(header->historyCount);
+    const QChar* chars = reader.take<QChar>(header->stringBytes / sizeof(QChar));
+    if (!reader.ok) {
+        qCWarning(lcModel) << "Model cache is truncated";
+        return false;
+    }
+
+    // Строки: одна QString на уникальное значение, объекты модели делят ее (implicit sharing)
+    QVector<QString> strings;
+    strings.reserve(header->stringCount);
+    quint64 charOffset = 0;
+    const quint64 charCount = header->stringBytes / sizeof(QChar);
+    for (quint32 i = 0; i < header->stringCount; ++i) {
+        if (charOffset + stringLengths[i] > charCount) return false;
+        strings.append(QString(chars + charOffset, qsizetype(stringLengths[i])));
+        charOffset += stringLengths[i];
+    }
+
+    auto valid = [&](quint32 index) { return index < quint32(strings.size()); };
+
+    // Проверка всех ссылок до создания объектов, чтобы при ошибке модель осталась пустой
+    for (quint32 i = 0; i < header->workspaceCount; ++i) {
+        if (!valid(workspaceRecords[i].name)) return false;
+    }
+    for (quint32 i = 0; i < header->categoryCount; ++i) {
+        const CategoryRecord& record = categoryRecords[i];
+        if (record.workspace >= header->workspaceCount || !valid(record.name)) return false;
+    }
+    for (quint32 i = 0; i < header->taskCount; ++i) {
+        const TaskRecord& record = taskRecords[i];
+        if (record.category >= header->categoryCount || !valid(record.description) || !valid(record.difficulty) ||
+            !valid(record.priority) || !valid(record.status) || !valid(record.deadline) ||
+            quint64(record.firstTag) + record.tagCount > header->tagRefCount) {
+            return false;
+        }
+        for (quint32 t = 0; t < record.tagCount; ++t) {
+            if (!valid(tagRefs[record.firstTag + t])) return false;
+        }
+    }
+    for (quint32 i = 0; i < header->historyCount; ++i) {
+        const CachedHistory& record = historyRecords[i];
+        if (!valid(record.description) || !valid(record.difficulty) || !valid(record.priority) ||
+            !valid(record.status) || !valid(record.deadline)) {
+            return false;
+        }
+    }
+
+    QVector<Workspace*> workspaceObjects(header->workspaceCount);
+    for (quint32 i = 0; i < header->workspaceCount; ++i) {
+        const QString& name = strings[workspaceRecords[i].name];
+        workspaceObjects[i] = new Workspace(workspaceRecords[i].id, name);
+        workspaces[name] = workspaceObjects[i];
+    }
+
+    QVector<Category*> categoryObjects(header->categoryCount);
+    for (quint32 i = 0; i < header->categoryCount; ++i) {
+        const CategoryRecord& record = categoryRecords[i];
+        Workspace* workspace = workspaceObjects[record.workspace];
+        const QString& name = strings[record.name];
+        workspace->addCategory(record.id, name);
+        categoryObjects[i] = workspace->getCategories().value(name);
+    }
+
+    for (quint32 i = 0; i < header->taskCount; ++i) {
+        const TaskRecord& record = taskRecords[i];
+        Category* category = categoryObjects[record.category];
+        QStringList tags;
+        tags.reserve(record.tagCount);
+        for (quint32 t = 0; t < record.tagCount; ++t) {
+            tags.append(strings[tagRefs[record.firstTag + t]]);
+        }
+        category->addTask(new Task(record.id, strings[record.description], category->getName(), tags,
+                                   strings[record.difficulty], strings[record.priority],
+                                   strings[record.status], strings[record.deadline]));
+    }
+
+    taskHistory.reserve(taskHistory.size() + header->historyCount);
+    for (quint32 i = 0; i < header->historyCount; ++i) {
+        const CachedHistory& record = historyRecords[i];
+        taskHistory.append(Task(record.id, strings[record.description], "", QStringList(),
+                                strings[record.difficulty], strings[record.priority],
+                                historyStatus(strings[record.status], isEnglish), strings[record.deadline]));
+    }
+
+    qCInfo(lcModel) << "Model loaded from cache:" << header->workspaceCount << "workspaces,"
+                    << header->categoryCount << "categories," << header->taskCount << "tasks,"
+                    << header->historyCount << "history entries," << header->stringCount << "strings";
+    return true;
+}
+
+void ModelCache::invalidate(const QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("DELETE FROM ModelCacheState;")) {
+        qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+    }
+}
+
+bool ModelCache::save(const QString& path, const QSqlDatabase& db, const QMap<QString, Workspace*>& workspaces,
+                      const QVector<Task>& taskHistory)
+{
+    TRACE_SCOPE("ModelCache::save", "model");
+
+    StringTable strings;
+    QVector<WorkspaceRecord> workspaceRecords;
+    QVector<CategoryRecord> categoryRecords;
+    QVector<TaskRecord> taskRecords;
+    QVector<quint32> tagRefs;
+    QVector<CachedHistory> historyRecords;
+
+    for (Workspace* workspace : workspaces) {
+        quint32 workspaceIndex = quint32(workspaceRecords.size());
+        workspaceRecords.append({workspace->getId(), strings.intern(workspace->getName())});
+
+        for (Category* category : workspace->getCategories()) {
+            quint32 categoryIndex = quint32(categoryRecords.size());
+            categoryRecords.append({category->getId(), workspaceIndex, strings.intern(category->getName())});
+
+            for (Task* task : category->getTasks()) {
+                // Задачи из файлов рабочих пр-в загружаются из них при открытии пр-ва
+                if (WorkspaceStorage::isSplitId(task->getId())) continue;
+
+                const QStringList tags = task->getTags();
+                TaskRecord record;
+                record.id = task->getId();
+                record.category = categoryIndex;
+                record.description = strings.intern(task->getDescription());
+                record.difficulty = strings.intern(task->getDifficulty());
+                record.priority = strings.intern(task->getPriority());
+                record.status = strings.intern(task->getStatus());
+                record.deadline = strings.intern(task->getDeadline());
+                record.firstTag = quint32(tagRefs.size());
+                record.tagCount = quint32(tags.size());
+                for (const QString& tag : tags) {
+                    tagRefs.append(strings.intern(tag));
+                }
+                taskRecords.append(record);
+            }
+        }
+    }
+
+    for (const Task& task : taskHistory) {
+        historyRecords.append({task.getId(), strings.intern(task.getDescription()),
+                               strings.intern(task.getDifficulty()), strings.intern(task.getPriority()),
+                               strings.intern(task.getStatus()), strings.intern(task.getDeadline())});
+    }
+
+    QVector<quint32> stringLengths;
+    stringLengths.reserve(strings.strings.size());
+    quint64 charCount = 0;
+    for (const QString& value : strings.strings) {
+        stringLengths.append(quint32(value.size()));
+        charCount += value.size();
+    }
+
+    quint64 token = 0;
+    while (token == 0) token = QRandomGenerator::system()->generate64();
+
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = formatVersion;
+    header.byteOrder = byteOrderMark;
+    header.token = token;
+    header.stringCount = quint32(strings.strings.size());
+    header.workspaceCount = quint32(workspaceRecords.size());
+    header.categoryCount = quint32(categoryRecords.size());
+    header.taskCount = quint32(taskRecords.size());
+    header.tagRefCount = quint32(tagRefs.size());
+    header.historyCount = quint32(historyRecords.size());
+    header.stringBytes = charCount * sizeof(QChar);
+
+    QByteArray out;
+    append(out, header);
+    alignTo8(out);
+    appendVector(out, stringLengths);
+    alignTo8(out);
+    appendVector(out, workspaceRecords);
+    alignTo8(out);
+    appendVector(out, categoryRecords);
+    alignTo8(out);
+    appendVector(out, taskRecords);
+    alignTo8(out);
+    appendVector(out, tagRefs);
+    alignTo8(out);
+    appendVector(out, historyRecords);
+    alignTo8(out);
+    for (const QString& value : strings.strings) {
+        out.append(reinterpret_cast<const char*>(value.constData()), value.size() * qsizetype(sizeof(QChar)));
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+        qCWarning(lcModel) << "Can't write model cache:" << file.errorString();
+        return false;
+    }
+
+    // Токен - после файла: сбой между ними оставляет бд без токена
+    QSqlQuery query(db);
+    if (!query.exec("DELETE FROM ModelCacheState;") ||
+        !query.prepare("INSERT INTO ModelCacheState (token) VALUES (:token);")) {
+        qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+        return false;
+    }
+    query.bindValue(":token", qint64(token));
+    if (!query.exec()) {
+        qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+        return false;
+    }
+
+    qCInfo(lcModel) << "Model cache written:" << out.size() << "bytes," << header.stringCount << "strings";
+    return true;
+}
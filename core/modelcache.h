@@ -0,0 +1,36 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#include <QMap>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+#include "taskmodel.h"
+
+// Бинарный снимок модели для быстрого старта. Пишется при штатном выходе вместе с токеном
+// в бд; при запуске файл отображается в память (QFile::map) и используется, только если
+// токен в бд совпадает. Токен расходуется при загрузке, а любое изменение таблиц модели
+// удаляет его триггером - после сбоя или правки бд другим процессом снимок не используется.
+// Строки (имена, описания, теги, статусы) хранятся один раз в таблице строк
+class ModelCache {
+public:
+    // <бд>.modelcache
+    static QString cachePath(const QString& databasePath);
+
+    // Таблица токена и триггеры сброса
+    static bool createSchema(const QSqlDatabase& db);
+
+    // false - снимка нет, он устарел или поврежден (модель не тронута)
+    static bool load(const QString& path, const QSqlDatabase& db, QMap<QString, Workspace*>& workspaces,
+                     QVector<Task>& taskHistory, bool isEnglish);
+
+    // Сброс токена: до следующего save() снимок недействителен
+    static void invalidate(const QSqlDatabase& db);
+
+    // Запись снимка и токена (изменения в бд к этому моменту должны быть зафиксированы)
+    static bool save(const QString& path, const QSqlDatabase& db, const QMap<QString, Workspace*>& workspaces,
+                     const QVector<Task>& taskHistory);
+};
+
+#endif // MODELCACHE_H
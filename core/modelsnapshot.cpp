@@ -0,0 +1,152 @@
+#include "modelsnapshot.h"
+#include "taskmodel.h"
+#include <QDate>
+
+int taskStatusCode(const QString& status)
+{
+    if (status == "Pending" || status == "В ожидании") return StatusPending;
+    if (status == "In Progress" || status == "В процессе") return StatusInProgress;
+    if (status == "Completed" || status == "Завершено") return StatusCompleted;
+    return -1;
+}
+
+int taskPriorityRank(const QString& priority)
+{
+    if (priority == "Low" || priority == "Низкий") return 0;
+    if (priority == "Medium" || priority == "Средний") return 1;
+    if (priority == "High" || priority == "Высокий") return 2;
+    return -1;
+}
+
+int taskDifficultyRank(const QString& difficulty)
+{
+    if (difficulty == "Easy" || difficulty == "Лёгкая") return 0;
+    if (difficulty == "Medium" || difficulty == "Средняя") return 1;
+    if (difficulty == "Hard" || difficulty == "Сложная") return 2;
+    return -1;
+}
+
+qint64 taskDeadlineDay(const QString& deadline)
+{
+    if (deadline.isEmpty()) return 0;
+    QDate date = QDate::fromString(deadline, "dd-MM-yyyy");
+    return date.isValid() ? date.toJulianDay() : 0;
+}
+
+QString searchKey(const QString& text)
+{
+    return text.trimmed().toCaseFolded();
+}
+
+SnapshotPublisher::SnapshotPublisher()
+    : snapshot(std::make_shared<const ModelSnapshot>())
+{
+}
+
+// Текущий снимок (без блокировок)
+ModelSnapshotPtr SnapshotPublisher::current() const
+{
+    return std::atomic_load(&snapshot);
+}
+
+// Атомарная публикация новой версии
+void SnapshotPublisher::store(const std::shared_ptr<ModelSnapshot>& next)
+{
+    int taskCount = 0;
+    for (const WorkspaceSnapshotPtr& workspace : next->workspaces) {
+        for (const CategorySnapshotPtr& category : workspace->categories) {
+            taskCount += category->tasks.size();
+        }
+    }
+    next->taskCount = taskCount;
+    next->version = current()->version + 1;
+
+    std::atomic_store(&snapshot, ModelSnapshotPtr(next));
+}
+
+// Полная пересборка снимка
+void SnapshotPublisher::publishAll(const QMap<QString, Workspace*>& workspaces)
+{
+    auto next = std::make_shared<ModelSnapshot>();
+    for (auto it = workspaces.begin(); it != workspaces.end(); ++it) {
+        next->workspaces.insert(it.key(), buildWorkspace(it.value(), nullptr, QString()));
+    }
+    store(next);
+}
+
+// Пересборка только изменившегося рабочего пр-ва
+void SnapshotPublisher::publish(const QMap<QString, Workspace*>& workspaces,
+                                const QString& workspaceName, const QString& categoryName)
+{
+    ModelSnapshotPtr previous = current();
+    auto next = std::make_shared<ModelSnapshot>();
+
+    for (auto it = workspaces.begin(); it != workspaces.end(); ++it) {
+        WorkspaceSnapshotPtr old = previous->workspaces.value(it.key());
+        if (old && it.key() != workspaceName && old->id == it.value()->getId()) {
+            next->workspaces.insert(it.key(), old); // общая часть с предыдущей версией
+        } else {
+            next->workspaces.insert(it.key(), buildWorkspace(it.value(), old, categoryName));
+        }
+    }
+    store(next);
+}
+
+TaskSnapshotPtr SnapshotPublisher::buildTask(const Task* task, int categoryId)
+{
+    auto snapshot = std::make_shared<TaskSnapshot>();
+    snapshot->id = task->getId();
+    snapshot->categoryId = categoryId;
+    snapshot->description = task->getDescription();
+    snapshot->category = task->getCategory();
+    snapshot->tags = task->getTags();
+    snapshot->difficulty = task->getDifficulty();
+    snapshot->priority = task->getPriority();
+    snapshot->status = task->getStatus();
+    snapshot->deadline = task->getDeadline();
+
+    snapshot->statusCode = taskStatusCode(snapshot->status);
+    snapshot->priorityRank = taskPriorityRank(snapshot->priority);
+    snapshot->difficultyRank = taskDifficultyRank(snapshot->difficulty);
+    snapshot->deadlineDay = taskDeadlineDay(snapshot->deadline);
+    snapshot->descriptionKey = searchKey(snapshot->description);
+    for (const QString& tag : snapshot->tags) {
+        snapshot->tagKeys.append(searchKey(tag));
+    }
+    return snapshot;
+}
+
+CategorySnapshotPtr SnapshotPublisher::buildCategory(Category* category)
+{
+    auto snapshot = std::make_shared<CategorySnapshot>();
+    snapshot->id = category->getId();
+    snapshot->name = category->getName();
+    snapshot->tasks.reserve(category->getTasks().size());
+    for (const Task* task : category->getTasks()) {
+        snapshot->tasks.append(buildTask(task, category->getId()));
+    }
+    return snapshot;
+}
+
+// Если указана категория - пересобирается только она, остальные берутся из previous
+WorkspaceSnapshotPtr SnapshotPublisher::buildWorkspace(Workspace* workspace,
+                                                       const WorkspaceSnapshotPtr& previous,
+                                                       const QString& categoryName)
+{
+    auto snapshot = std::make_shared<WorkspaceSnapshot>();
+    snapshot->id = workspace->getId();
+    snapshot->name = workspace->getName();
+
+    bool reuse = previous && previous->id == workspace->getId() && !categoryName.isEmpty();
+
+    QMap<QString, Category*>& categories = workspace->getCategories();
+    for (auto it = categories.begin(); it != categories.end(); ++it) {
+        CategorySnapshotPtr old = reuse ? previous->categories.value(it.key()) : nullptr;
+        if (old && it.key() != categoryName && old->id == it.value()->getId()) {
+            snapshot->categories.insert(it.key(), old);
+        } else {
+            snapshot->categories.insert(it.key(), buildCategory(it.value()));
+        }
+    }
+    return snapshot;
+}
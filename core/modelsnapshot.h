@@ -0,0 +1,100 @@
+#ifndef MODELSNAPSHOT_H
+#define MODELSNAPSHOT_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+class Workspace;
+class Category;
+class Task;
+
+// Неизменяемые снимки модели.
+// Снимок публикуется после каждой зафиксированной мутации (RCU):
+// читатели в фоновых потоках берут указатель на текущий снимок и работают с ним без блокировок,
+// а неизменившиеся рабочие пр-ва и категории разделяются между соседними версиями.
+
+struct TaskSnapshot {
+    int id = 0;
+    int categoryId = 0;
+    QString description;
+    QString category;
+    QStringList tags;
+    QString difficulty;
+    QString priority;
+    QString status;
+    QString deadline;
+
+    // Ключи фильтрации/сортировки (считаются один раз при построении снимка)
+    int statusCode = -1;
+    int priorityRank = -1;
+    int difficultyRank = -1;
+    qint64 deadlineDay = 0;      // юлианский день, 0 - без срока
+    QString descriptionKey;      // casefold
+    QStringList tagKeys;         // casefold + trimmed
+};
+
+// Нормализация значений, которые в бд хранятся на любом из двух языков
+enum TaskStatusCode { StatusPending = 0, StatusInProgress = 1, StatusCompleted = 2 };
+
+int taskStatusCode(const QString& status);
+int taskPriorityRank(const QString& priority);
+int taskDifficultyRank(const QString& difficulty);
+qint64 taskDeadlineDay(const QString& deadline);
+QString searchKey(const QString& text);
+
+using TaskSnapshotPtr = std::shared_ptr<const TaskSnapshot>;
+
+struct CategorySnapshot {
+    int id = 0;
+    QString name;
+    QVector<TaskSnapshotPtr> tasks;
+};
+
+using CategorySnapshotPtr = std::shared_ptr<const CategorySnapshot>;
+
+struct WorkspaceSnapshot {
+    int id = 0;
+    QString name;
+    QMap<QString, CategorySnapshotPtr> categories;
+};
+
+using WorkspaceSnapshotPtr = std::shared_ptr<const WorkspaceSnapshot>;
+
+struct ModelSnapshot {
+    quint64 version = 0;
+    int taskCount = 0;
+    QMap<QString, WorkspaceSnapshotPtr> workspaces;
+};
+
+using ModelSnapshotPtr = std::shared_ptr<const ModelSnapshot>;
+
+// Публикация снимков.
+// publish*() вызываются только из GUI-потока, current() - из любого потока
+class SnapshotPublisher {
+public:
+    SnapshotPublisher();
+
+    ModelSnapshotPtr current() const;
+
+    // Полная пересборка (после загрузки из бд)
+    void publishAll(const QMap<QString, Workspace*>& workspaces);
+
+    // Пересборка одного рабочего пр-ва (или одной его категории), остальное переиспользуется
+    void publish(const QMap<QString, Workspace*>& workspaces,
+                 const QString& workspaceName, const QString& categoryName = QString());
+
+private:
+    void store(const std::shared_ptr<ModelSnapshot>& next);
+    static TaskSnapshotPtr buildTask(const Task* task, int categoryId);
+    static CategorySnapshotPtr buildCategory(Category* category);
+    static WorkspaceSnapshotPtr buildWorkspace(Workspace* workspace,
+                                               const WorkspaceSnapshotPtr& previous,
+                                               const QString& categoryName);
+
+    ModelSnapshotPtr snapshot; // доступ только через std::atomic_load/std::atomic_store
+};
+
+#endif // MODELSNAPSHOT_H
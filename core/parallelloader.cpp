@@ -0,0 +1,277 @@
+#include "parallelloader.h"
+#include "applog.h"
+#include "readconnection.h"
+#include "sqlprofiler.h"
+#include "tracer.h"
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QThread>
+#include <QThreadPool>
+#include <QVariant>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+// Меньше строк - делить на диапазоны нет смысла
+const qint64 minRowsPerPartition = 20000;
+
+struct WorkspaceRow {
+    int id;
+    QString name;
+};
+
+struct CategoryRow {
+    int id;
+    QString name;
+    int workspaceId;
+};
+
+struct TaskRow {
+    int id;
+    QString description;
+    int categoryId;
+    QString difficulty;
+    QString priority;
+    QString status;
+    QString deadline;
+};
+
+struct IdRange {
+    qint64 first;
+    qint64 last;
+};
+
+// Разбиение [min(id); max(id)] на parts диапазонов
+QVector<IdRange> splitRange(ReadConnection& connection, const QString& table, int parts)
+{
+    QSqlQuery query = connection.select(QString("SELECT MIN(id), MAX(id), COUNT(*) FROM %1").arg(table));
+    QVector<IdRange> ranges;
+    if (!query.next() || query.value(2).toLongLong() == 0) return ranges;
+
+    qint64 first = query.value(0).toLongLong();
+    qint64 last = query.value(1).toLongLong();
+    qint64 rows = query.value(2).toLongLong();
+
+    parts = int(qBound<qint64>(1, rows / minRowsPerPartition, parts));
+    qint64 span = (last - first) / parts + 1;
+    for (qint64 start = first; start <= last; start += span) {
+        ranges.append({start, qMin(last, start + span - 1)});
+    }
+    return ranges;
+}
+
+} // namespace
+
+bool ParallelModelLoader::load(const QString& databasePath, QMap<QString, Workspace*>& workspaces,
+                               QVector<Task>& taskHistory, bool isEnglish, int threads)
+{
+    TRACE_SCOPE("ParallelModelLoader::load", "model");
+
+    if (databasePath.isEmpty() || databasePath == ":memory:") return false;
+    if (threads <= 0) threads = QThread::idealThreadCount();
+
+    const QString prefix = ReadConnection::uniqueName("parallel_loader") + "_";
+
+    QVector<IdRange> taskRanges;
+    QVector<IdRange> tagRanges;
+    try {
+        ReadConnection connection(databasePath, prefix + "plan");
+        taskRanges = splitRange(connection, "Tasks", threads);
+        tagRanges = splitRange(connection, "TaskTags", threads);
+    } catch (const std::exception& e) {
+        qCWarning(lcDb) << "Parallel load planning failed:" << e.what();
+        return false;
+    }
+
+    // Слоты результатов: каждое задание пишет только в свой
+    QVector<WorkspaceRow> workspaceRows;
+    QVector<CategoryRow> categoryRows;
+    QVector<Task> historyRows;
+    QVector<QVector<TaskRow>> taskParts(taskRanges.size());
+    QVector<QHash<int, QStringList>> tagParts(tagRanges.size());
+
+    QMutex errorMutex;
+    QString error;
+
+    QVector<std::function<void()>> jobs;
+    jobs.append([&]() {
+        TRACE_SCOPE("load workspaces", "model");
+        ReadConnection connection(databasePath, prefix + "workspaces");
+        const QString sql = "SELECT id, name FROM Workspaces WHERE deleted = 0";
+        SqlProfileScope profile(sql);
+        QSqlQuery query = connection.select(sql);
+        profile.stop();
+        while (query.next()) {
+            workspaceRows.append({query.value(0).toInt(), query.value(1).toString()});
+            profile.addRows();
+        }
+    });
+    jobs.append([&]() {
+        TRACE_SCOPE("load categories", "model");
+        ReadConnection connection(databasePath, prefix + "categories");
+        const QString sql = "SELECT id, name, workspace_id FROM Categories WHERE deleted = 0";
+        SqlProfileScope profile(sql);
+        QSqlQuery query = connection.select(sql);
+        profile.stop();
+        while (query.next()) {
+            categoryRows.append({query.value(0).toInt(), query.value(1).toString(), query.value(2).toInt()});
+            profile.addRows();
+        }
+    });
+    jobs.append([&]() {
+        TRACE_SCOPE("load history", "model");
+        ReadConnection connection(databasePath, prefix + "history");
+        const QString sql = "SELECT id, description, difficulty, priority, status, deadline FROM TaskHistory";
+        SqlProfileScope profile(sql);
+        QSqlQuery query = connection.select(sql);
+        profile.stop();
+        while (query.next()) {
+            QString status = query.value(4).toString();
+
+            // Приведение статуса к текущему языку
+            if (isEnglish && status == "Завершено") {
+                status = "Completed";
+            } else if (!isEnglish && status == "Completed") {
+                status = "Завершено";
+            }
+
+            historyRows.append(Task(query.value(0).toInt(), query.value(1).toString(), "", QStringList(),
+                                    query.value(2).toString(), query.value(3).toString(),
+                                    status, query.value(5).toString()));
+            profile.addRows();
+        }
+    });
+    for (int part = 0; part < taskRanges.size(); ++part) {
+        jobs.append([&, part]() {
+            TRACE_SCOPE("load tasks range", "model");
+            ReadConnection connection(databasePath, prefix + "tasks_" + QString::number(part));
+            const QString sql = "SELECT id, description, category_id, difficulty, priority, status, deadline "
+                                "FROM Tasks WHERE id BETWEEN :first AND :last "
+                                "AND category_id NOT IN (SELECT id FROM Categories WHERE deleted = 1) ORDER BY id";
+            SqlProfileScope profile(sql);
+            QSqlQuery query = connection.select(sql, taskRanges[part].first, taskRanges[part].last);
+            profile.stop();
+            QVector<TaskRow>& rows = taskParts[part];
+            while (query.next()) {
+                rows.append({query.value(0).toInt(), query.value(1).toString(), query.value(2).toInt(),
+                             query.value(3).toString(), query.value(4).toString(),
+                             query.value(5).toString(), query.value(6).toString()});
+                profile.addRows();
+            }
+        });
+    }
+    // Теги читаются по диапазонам TaskTags.id (rowid): один проход по таблице
+    // вместо запроса на каждую задачу
+    for (int part = 0; part < tagRanges.size(); ++part) {
+        jobs.append([&, part]() {
+            TRACE_SCOPE("load tags range", "model");
+            ReadConnection connection(databasePath, prefix + "tags_" + QString::number(part));
+            const QString sql = "SELECT task_id, tag FROM TaskTags WHERE id BETWEEN :first AND :last ORDER BY id";
+            SqlProfileScope profile(sql);
+            QSqlQuery query = connection.select(sql, tagRanges[part].first, tagRanges[part].last);
+            profile.stop();
+            QHash<int, QStringList>& tags = tagParts[part];
+            while (query.next()) {
+                tags[query.value(0).toInt()].append(query.value(1).toString());
+                profile.addRows();
+            }
+        });
+    }
+
+    {
+        TRACE_SCOPE("parallel read", "model");
+        QThreadPool pool;
+        pool.setMaxThreadCount(qMin(threads, int(jobs.size())));
+        for (const std::function<void()>& job : jobs) {
+            pool.start([&, job]() {
+                try {
+                    job();
+                } catch (const std::exception& e) {
+                    QMutexLocker locker(&errorMutex);
+                    error = QString::fromUtf8(e.what());
+                }
+            });
+        }
+        pool.waitForDone();
+    }
+
+    if (!error.isEmpty()) {
+        qCWarning(lcDb) << "Parallel load failed:" << error;
+        return false;
+    }
+
+    TRACE_SCOPE("merge model", "model");
+
+    // Теги по задачам в порядке TaskTags.id
+    QHash<int, QStringList> tagsByTask;
+    for (QHash<int, QStringList>& part : tagParts) {
+        if (tagsByTask.isEmpty()) {
+            tagsByTask.swap(part);
+            continue;
+        }
+        for (auto it = part.begin(); it != part.end(); ++it) {
+            tagsByTask[it.key()].append(it.value());
+        }
+    }
+
+    // Как и при последовательной загрузке: одноименные записи перезаписывают друг друга
+    for (const WorkspaceRow& row : workspaceRows) {
+        if (row.id == 0) {
+            qCWarning(lcModel) << "Warning: Workspace with ID 0 found! This should not happen.";
+            continue;
+        }
+        delete workspaces.value(row.name);
+        workspaces[row.name] = new Workspace(row.id, row.name);
+    }
+
+    QHash<int, Workspace*> workspacesById;
+    for (Workspace* workspace : workspaces) {
+        if (!workspacesById.contains(workspace->getId())) {
+            workspacesById.insert(workspace->getId(), workspace);
+        }
+    }
+
+    for (const CategoryRow& row : categoryRows) {
+        Workspace* workspace = workspacesById.value(row.workspaceId);
+        if (!workspace) {
+            qCWarning(lcModel) << "Category" << row.name << "with ID" << row.id
+                               << "has no matching workspace (Workspace ID:" << row.workspaceId << ")";
+            continue;
+        }
+        workspace->addCategory(row.id, row.name);
+    }
+
+    QHash<int, Category*> categoriesById;
+    for (Workspace* workspace : workspaces) {
+        for (Category* category : workspace->getCategories()) {
+            if (!categoriesById.contains(category->getId())) {
+                categoriesById.insert(category->getId(), category);
+            }
+        }
+    }
+
+    int taskCount = 0;
+    for (const QVector<TaskRow>& part : taskParts) {
+        for (const TaskRow& row : part) {
+            Category* category = categoriesById.value(row.categoryId);
+            if (!category) {
+                qCWarning(lcModel) << "Failed to load task - category ID" << row.categoryId
+                                   << "not found for task ID:" << row.id;
+                continue;
+            }
+            category->addTask(new Task(row.id, row.description, category->getName(), tagsByTask.value(row.id),
+                                       row.difficulty, row.priority, row.status, row.deadline));
+            taskCount++;
+        }
+    }
+
+    taskHistory += historyRows;
+
+    qCInfo(lcModel) << "Parallel load:" << workspacesById.size() << "workspaces," << categoriesById.size()
+                    << "categories," << taskCount << "tasks," << historyRows.size() << "history entries in"
+                    << jobs.size() << "jobs";
+    return true;
+}
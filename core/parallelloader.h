@@ -0,0 +1,21 @@
+#ifndef PARALLELLOADER_H
+#define PARALLELLOADER_H
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "taskmodel.h"
+
+// Параллельная стартовая загрузка модели: рабочие пр-ва, категории, история,
+// диапазоны Tasks и TaskTags читаются одновременно в пуле потоков, у каждого
+// задания свое read-only соединение с бд. Результаты собираются в модель в
+// вызывающем потоке в том же порядке, что и при последовательной загрузке
+class ParallelModelLoader {
+public:
+    // false - загрузка не удалась (модель не тронута), нужна последовательная
+    static bool load(const QString& databasePath, QMap<QString, Workspace*>& workspaces,
+                     QVector<Task>& taskHistory, bool isEnglish, int threads = 0);
+};
+
+#endif // PARALLELLOADER_H
@@ -0,0 +1,67 @@
+#include "readconnection.h"
+#include <QAtomicInt>
+#include <QSqlError>
+#include <QVariant>
+#include <stdexcept>
+
+ReadConnection::ReadConnection(const QString& path, const QString& name)
+    : name(name)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(path);
+    db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    if (!db.open()) {
+        const std::string error = db.lastError().text().toStdString();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        throw std::runtime_error(error);
+    }
+}
+
+ReadConnection::~ReadConnection()
+{
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+QString ReadConnection::uniqueName(const QString& prefix)
+{
+    static QAtomicInt counter;
+    return QString("%1_%2").arg(prefix).arg(counter.fetchAndAddRelaxed(1));
+}
+
+QSqlDatabase ReadConnection::database() const
+{
+    return QSqlDatabase::database(name, false);
+}
+
+QSqlQuery ReadConnection::prepare(const QString& sql)
+{
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+    return query;
+}
+
+void ReadConnection::exec(QSqlQuery& query)
+{
+    if (!query.exec()) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+}
+
+QSqlQuery ReadConnection::select(const QString& sql, qint64 first, qint64 last)
+{
+    QSqlQuery query = prepare(sql);
+    if (sql.contains(":first")) {
+        query.bindValue(":first", first);
+        query.bindValue(":last", last);
+    }
+    exec(query);
+    return query;
+}
@@ -0,0 +1,34 @@
+#ifndef READCONNECTION_H
+#define READCONNECTION_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+// Свое read-only соединение с файлом бд для фонового потока
+// (соединения QtSql нельзя делить между потоками). Ошибки - std::runtime_error
+class ReadConnection {
+public:
+    ReadConnection(const QString& path, const QString& name);
+    ~ReadConnection();
+
+    ReadConnection(const ReadConnection&) = delete;
+    ReadConnection& operator=(const ReadConnection&) = delete;
+
+    // Имя соединения, не совпадающее с уже выданными
+    static QString uniqueName(const QString& prefix);
+
+    QSqlDatabase database() const;
+
+    // Подготовленный forward-only запрос
+    QSqlQuery prepare(const QString& sql);
+    static void exec(QSqlQuery& query);
+
+    // Выполненный запрос; :first и :last подставляются, если есть в тексте
+    QSqlQuery select(const QString& sql, qint64 first = 0, qint64 last = 0);
+
+private:
+    QString name;
+};
+
+#endif // READCONNECTION_H
@@ -0,0 +1,177 @@
+#include "sqlprofiler.h"
+#include "applog.h"
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+struct ProfilerState {
+    QMutex mutex;
+    QHash<QString, SqlStatementStats> statements;
+    QString dumpPath;
+};
+
+ProfilerState& state()
+{
+    static ProfilerState instance;
+    return instance;
+}
+
+int bucketFor(qint64 ns)
+{
+    const QVector<qint64>& bounds = SqlProfiler::bucketBoundsNs();
+    auto it = std::lower_bound(bounds.begin(), bounds.end(), ns);
+    return std::min<int>(it - bounds.begin(), bounds.size() - 1);
+}
+
+} // namespace
+
+std::atomic<bool> SqlProfiler::enabled{true};
+
+qint64 SqlStatementStats::percentileNs(double p) const
+{
+    if (count == 0) return 0;
+
+    const QVector<qint64>& bounds = SqlProfiler::bucketBoundsNs();
+    qint64 target = qMax<qint64>(1, qint64(count * p + 0.5));
+    qint64 seen = 0;
+    for (int i = 0; i < histogram.size(); ++i) {
+        seen += histogram[i];
+        if (seen >= target) {
+            // Последняя корзина открыта сверху - лучше показать максимум
+            return i == bounds.size() - 1 ? maxNs : qMin(bounds[i], maxNs);
+        }
+    }
+    return maxNs;
+}
+
+// 1 мкс ... 1 с, шаг 1-2-5
+const QVector<qint64>& SqlProfiler::bucketBoundsNs()
+{
+    static const QVector<qint64> bounds = {
+        1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+        1000000, 2000000, 5000000, 10000000, 20000000, 50000000,
+        100000000, 200000000, 500000000, 1000000000,
+        std::numeric_limits<qint64>::max()
+    };
+    return bounds;
+}
+
+void SqlProfiler::configureFromEnvironment()
+{
+    QString value = qEnvironmentVariable("TASK_MANAGER_SQL_PROFILE");
+    if (value == "0") {
+        setEnabled(false);
+    } else if (!value.isEmpty() && value != "1") {
+        QMutexLocker locker(&state().mutex);
+        state().dumpPath = value;
+    }
+}
+
+QString SqlProfiler::dumpPath()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().dumpPath;
+}
+
+void SqlProfiler::record(const QString& statement, qint64 ns, qint64 rows)
+{
+    if (!isEnabled()) return;
+
+    ProfilerState& s = state();
+    QMutexLocker locker(&s.mutex);
+    SqlStatementStats& stats = s.statements[statement];
+    if (stats.histogram.isEmpty()) {
+        stats.statement = statement;
+        stats.histogram.fill(0, bucketBoundsNs().size());
+    }
+    stats.count++;
+    stats.rows += rows;
+    stats.totalNs += ns;
+    stats.maxNs = qMax(stats.maxNs, ns);
+    stats.histogram[bucketFor(ns)]++;
+}
+
+void SqlProfiler::addRows(const QString& statement, qint64 rows)
+{
+    if (!isEnabled() || rows == 0) return;
+
+    ProfilerState& s = state();
+    QMutexLocker locker(&s.mutex);
+    auto it = s.statements.find(statement);
+    if (it != s.statements.end()) {
+        it->rows += rows;
+    }
+}
+
+QVector<SqlStatementStats> SqlProfiler::statistics()
+{
+    QVector<SqlStatementStats> result;
+    {
+        ProfilerState& s = state();
+        QMutexLocker locker(&s.mutex);
+        result.reserve(s.statements.size());
+        for (const SqlStatementStats& stats : s.statements) {
+            result.append(stats);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const SqlStatementStats& a, const SqlStatementStats& b) {
+        return a.totalNs > b.totalNs;
+    });
+    return result;
+}
+
+void SqlProfiler::reset()
+{
+    ProfilerState& s = state();
+    QMutexLocker locker(&s.mutex);
+    s.statements.clear();
+}
+
+bool SqlProfiler::dump(const QString& path)
+{
+    QJsonArray bounds;
+    for (qint64 bound : bucketBoundsNs()) {
+        bounds.append(bound == std::numeric_limits<qint64>::max() ? QJsonValue() : QJsonValue(double(bound)));
+    }
+
+    QJsonArray statements;
+    for (const SqlStatementStats& stats : statistics()) {
+        QJsonArray histogram;
+        for (qint64 value : stats.histogram) {
+            histogram.append(double(value));
+        }
+
+        QJsonObject object;
+        object["statement"] = stats.statement;
+        object["count"] = double(stats.count);
+        object["rows"] = double(stats.rows);
+        object["total_ns"] = double(stats.totalNs);
+        object["mean_ns"] = stats.meanNs();
+        object["p50_ns"] = double(stats.percentileNs(0.5));
+        object["p95_ns"] = double(stats.percentileNs(0.95));
+        object["max_ns"] = double(stats.maxNs);
+        object["histogram"] = histogram;
+        statements.append(object);
+    }
+
+    QJsonObject root;
+    root["bucket_bounds_ns"] = bounds;
+    root["statements"] = statements;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(lcDb) << "Can't write sql profile:" << path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
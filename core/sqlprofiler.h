@@ -0,0 +1,86 @@
+#ifndef SQLPROFILER_H
+#define SQLPROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+
+// Статистика одного текста запроса
+struct SqlStatementStats {
+    QString statement;
+    qint64 count = 0;
+    qint64 rows = 0;       // выбранные (SELECT) или измененные строки
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+    QVector<qint64> histogram;  // число выполнений по корзинам SqlProfiler::bucketBoundsNs()
+
+    double meanNs() const { return count ? double(totalNs) / count : 0.0; }
+    // Оценка перцентиля по гистограмме (верхняя граница корзины)
+    qint64 percentileNs(double p) const;
+};
+
+// Профилировщик sql: число выполнений, строки и гистограмма задержек на каждый текст запроса.
+// Включен по умолчанию (TASK_MANAGER_SQL_PROFILE=0 - выключить, =<файл> - записать отчет при выходе)
+class SqlProfiler {
+public:
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    static void configureFromEnvironment();
+
+    static void record(const QString& statement, qint64 ns, qint64 rows);
+    // Строки, выбранные уже после record() (итерация по SELECT)
+    static void addRows(const QString& statement, qint64 rows);
+
+    // Копия статистики, самые дорогие (по суммарному времени) запросы первыми
+    static QVector<SqlStatementStats> statistics();
+    static void reset();
+
+    // Отчет в JSON
+    static bool dump(const QString& path);
+    // Путь для отчета при выходе (пусто - не писать)
+    static QString dumpPath();
+
+    // Верхние границы корзин гистограммы (последняя - без ограничения)
+    static const QVector<qint64>& bucketBoundsNs();
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+// Замер одного выполнения запроса от создания до stop() (или до конца области видимости)
+class SqlProfileScope {
+public:
+    explicit SqlProfileScope(const QString& statement)
+        : statement(statement)
+    {
+        if (SqlProfiler::isEnabled()) timer.start();
+    }
+
+    ~SqlProfileScope()
+    {
+        if (!timer.isValid()) return;
+        stop();
+        SqlProfiler::record(statement, elapsedNs, rows);
+    }
+
+    SqlProfileScope(const SqlProfileScope&) = delete;
+    SqlProfileScope& operator=(const SqlProfileScope&) = delete;
+
+    // Остановка таймера (строки можно добавлять и дальше)
+    void stop()
+    {
+        if (timer.isValid() && elapsedNs < 0) elapsedNs = timer.nsecsElapsed();
+    }
+
+    void addRows(qint64 count = 1) { rows += count; }
+
+private:
+    QString statement;
+    QElapsedTimer timer;
+    qint64 elapsedNs = -1;
+    qint64 rows = 0;
+};
+
+#endif // SQLPROFILER_H
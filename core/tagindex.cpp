@@ -0,0 +1,177 @@
+#include "tagindex.h"
+#include <algorithm>
+
+QString TagIndex::normalize(const QString& tag)
+{
+    return tag.simplified().toCaseFolded();
+}
+
+int TagIndex::findChild(int node, QChar c) const
+{
+    const QVector<QPair<QChar, int>>& children = nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), c,
+                               [](const QPair<QChar, int>& child, QChar value) { return child.first < value; });
+    return (it != children.end() && it->first == c) ? it->second : -1;
+}
+
+int TagIndex::ensureChild(int node, QChar c)
+{
+    int existing = findChild(node, c);
+    if (existing >= 0) return existing;
+
+    int created = nodes.size();
+    nodes.append(Node());
+
+    QVector<QPair<QChar, int>>& children = nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), c,
+                               [](const QPair<QChar, int>& child, QChar value) { return child.first < value; });
+    children.insert(it, qMakePair(c, created));
+    return created;
+}
+
+int TagIndex::findNode(const QString& key) const
+{
+    if (nodes.isEmpty()) return -1;
+
+    int node = 0;
+    for (QChar c : key) {
+        node = findChild(node, c);
+        if (node < 0) return -1;
+    }
+    return node;
+}
+
+int TagIndex::internTag(const QString& tag, const QString& key)
+{
+    auto existing = tagByKey.constFind(key);
+    if (existing != tagByKey.constEnd()) return existing.value();
+
+    if (nodes.isEmpty()) nodes.append(Node());
+
+    int node = 0;
+    for (QChar c : key) {
+        node = ensureChild(node, c);
+    }
+
+    int tagId = tags.size();
+    tags.append({tag.simplified(), key, 0});
+    tagByKey.insert(key, tagId);
+    nodes[node].tagId = tagId;
+    return tagId;
+}
+
+// Порядок подсказок: частота, затем алфавит
+bool TagIndex::ranksHigher(int a, int b) const
+{
+    if (tags[a].frequency != tags[b].frequency) return tags[a].frequency > tags[b].frequency;
+    return tags[a].key < tags[b].key;
+}
+
+// top-K узла из собственного тега и top-K детей
+void TagIndex::refreshTop(int node)
+{
+    Node& current = nodes[node];
+
+    QVector<int> candidates;
+    if (current.tagId >= 0 && tags[current.tagId].frequency > 0) {
+        candidates.append(current.tagId);
+    }
+    for (const QPair<QChar, int>& child : current.children) {
+        candidates += nodes[child.second].top;
+    }
+
+    int count = std::min<int>(TopCount, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [this](int a, int b) { return ranksHigher(a, b); });
+    candidates.resize(count);
+    current.top = candidates;
+}
+
+// Пересчет top-K снизу вверх по пути тега
+void TagIndex::refreshPath(const QString& key)
+{
+    QVector<int> path;
+    path.reserve(key.size() + 1);
+
+    int node = 0;
+    path.append(node);
+    for (QChar c : key) {
+        node = findChild(node, c);
+        if (node < 0) break;
+        path.append(node);
+    }
+
+    for (int i = path.size() - 1; i >= 0; --i) {
+        refreshTop(path[i]);
+    }
+}
+
+void TagIndex::add(const QString& tag)
+{
+    QString key = normalize(tag);
+    if (key.isEmpty()) return;
+
+    int tagId = internTag(tag, key);
+    tags[tagId].frequency++;
+    refreshPath(key);
+}
+
+void TagIndex::remove(const QString& tag)
+{
+    QString key = normalize(tag);
+    auto existing = tagByKey.constFind(key);
+    if (existing == tagByKey.constEnd()) return;
+
+    TagEntry& entry = tags[existing.value()];
+    if (entry.frequency > 0) {
+        entry.frequency--;
+        refreshPath(key);
+    }
+}
+
+void TagIndex::clear()
+{
+    nodes.clear();
+    tags.clear();
+    tagByKey.clear();
+}
+
+void TagIndex::rebuild(const QHash<QString, int>& usage)
+{
+    clear();
+    for (auto it = usage.constBegin(); it != usage.constEnd(); ++it) {
+        QString key = normalize(it.key());
+        if (key.isEmpty()) continue;
+        tags[internTag(it.key(), key)].frequency += it.value();
+    }
+
+    // Дети всегда создаются после родителя, поэтому обратный порядок - снизу вверх
+    for (int node = nodes.size() - 1; node >= 0; --node) {
+        refreshTop(node);
+    }
+}
+
+QStringList TagIndex::suggestions(const QString& prefix, int limit) const
+{
+    QStringList result;
+    int node = findNode(normalize(prefix));
+    if (node < 0) return result;
+
+    for (int tagId : nodes[node].top) {
+        if (result.size() >= limit) break;
+        result.append(tags[tagId].display);
+    }
+    return result;
+}
+
+int TagIndex::frequency(const QString& tag) const
+{
+    int tagId = tagByKey.value(normalize(tag), -1);
+    return tagId >= 0 ? tags[tagId].frequency : 0;
+}
+
+QString TagIndex::canonical(const QString& tag) const
+{
+    int tagId = tagByKey.value(normalize(tag), -1);
+    return tagId >= 0 ? tags[tagId].display : tag.simplified();
+}
@@ -0,0 +1,57 @@
+#ifndef TAGINDEX_H
+#define TAGINDEX_H
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Префиксное дерево по тегам с частотами использования.
+// В каждом узле хранится top-K тегов поддерева, поэтому подсказка - это спуск по префиксу,
+// без обхода поддерева. Теги интернируются: регистр/пробелы не создают новый тег
+class TagIndex {
+public:
+    static const int TopCount = 10;
+
+    void add(const QString& tag);
+    void remove(const QString& tag);
+    void clear();
+
+    // Массовая загрузка (тег -> число использований), top-K считается один раз
+    void rebuild(const QHash<QString, int>& usage);
+
+    QStringList suggestions(const QString& prefix, int limit = TopCount) const;
+    int frequency(const QString& tag) const;
+
+    // Уже существующее написание тега (или сам тег, если он новый)
+    QString canonical(const QString& tag) const;
+
+private:
+    struct Node {
+        QVector<QPair<QChar, int>> children; // отсортированы по символу
+        int tagId = -1;
+        QVector<int> top;                    // tagId по убыванию частоты
+    };
+
+    struct TagEntry {
+        QString display;
+        QString key;
+        int frequency = 0;
+    };
+
+    static QString normalize(const QString& tag);
+    int findChild(int node, QChar c) const;
+    int ensureChild(int node, QChar c);
+    int findNode(const QString& key) const;
+    int internTag(const QString& tag, const QString& key);
+    bool ranksHigher(int a, int b) const;
+    void refreshTop(int node);
+    void refreshPath(const QString& key);
+
+    QVector<Node> nodes;
+    QVector<TagEntry> tags;
+    QHash<QString, int> tagByKey;
+};
+
+#endif // TAGINDEX_H
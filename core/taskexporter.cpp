@@ -0,0 +1,254 @@
+#include "taskexporter.h"
+#include "applog.h"
+#include "readconnection.h"
+#include "sqlprofiler.h"
+#include "tracer.h"
+#include "workspacestorage.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStringList>
+#include <QThread>
+#include <QVariant>
+#include <QVector>
+#include <stdexcept>
+
+namespace {
+
+// Разделитель тегов в group_concat (в тегах не встречается)
+const QChar tagSeparator(0x1f);
+
+const int writeBufferSize = 64 * 1024;
+
+// Прогресс (и проверка отмены) раз в столько строк
+const int progressInterval = 4096;
+
+const QStringList columns = {
+    "source", "workspace", "category", "description", "tags", "difficulty", "priority", "status", "deadline"
+};
+
+// Накопление вывода и запись в устройство блоками
+class BufferedWriter {
+public:
+    explicit BufferedWriter(QIODevice& device)
+        : device(device)
+    {
+        buffer.reserve(writeBufferSize + 4096);
+    }
+
+    void append(const QByteArray& data)
+    {
+        buffer += data;
+        if (buffer.size() >= writeBufferSize) flush();
+    }
+
+    void flush()
+    {
+        if (buffer.isEmpty()) return;
+        if (device.write(buffer) != buffer.size()) {
+            throw std::runtime_error(device.errorString().toStdString());
+        }
+        buffer.clear();
+    }
+
+private:
+    QIODevice& device;
+    QByteArray buffer;
+};
+
+QByteArray csvField(const QString& value)
+{
+    QByteArray field = value.toUtf8();
+    if (field.contains(',') || field.contains('"') || field.contains('\n') || field.contains('\r')) {
+        field.replace("\"", "\"\"");
+        field = '"' + field + '"';
+    }
+    return field;
+}
+
+// Задачи берутся из schema: main или подключенный файл пр-ва (категории и пр-ва всегда в main)
+QString selectSql(bool history, bool byWorkspace, const QString& schema = "main")
+{
+    // Без ORDER BY: сортировка потребовала бы временного b-дерева на весь результат
+    QString sql = history
+        ? "SELECT w.name, c.name, t.description, "
+          "(SELECT group_concat(tag, char(31)) FROM TaskHistoryTags WHERE history_id = t.id), "
+          "t.difficulty, t.priority, t.status, t.deadline FROM TaskHistory t "
+          "LEFT JOIN Categories c ON c.id = t.category_id "
+          "LEFT JOIN Workspaces w ON w.id = c.workspace_id"
+        : "SELECT w.name, c.name, t.description, "
+          "(SELECT group_concat(tag, char(31)) FROM %1.TaskTags WHERE task_id = t.id), "
+          "t.difficulty, t.priority, t.status, t.deadline FROM %1.Tasks t "
+          "JOIN main.Categories c ON c.id = t.category_id AND c.deleted = 0 "
+          "JOIN main.Workspaces w ON w.id = c.workspace_id";
+    if (!history) sql = sql.arg(schema);
+    if (byWorkspace) sql += " WHERE w.id = :workspace_id";
+    return sql;
+}
+
+// Пр-ва с отдельными файлами (только существующие файлы)
+QVector<int> splitWorkspaces(ReadConnection& connection, const QString& databasePath, int workspaceId)
+{
+    QSqlQuery query = connection.select("SELECT workspace_id FROM WorkspaceFiles");
+    QVector<int> ids;
+    while (query.next()) {
+        const int id = query.value(0).toInt();
+        if ((workspaceId == 0 || id == workspaceId) && QFile::exists(WorkspaceStorage::fileFor(databasePath, id))) {
+            ids.append(id);
+        }
+    }
+    return ids;
+}
+
+} // namespace
+
+TaskExporter::TaskExporter(QObject* parent)
+    : QObject(parent)
+{
+}
+
+TaskExporter::~TaskExporter()
+{
+    if (worker) {
+        cancel();
+        worker->wait();
+    }
+}
+
+TaskExporter::Format TaskExporter::detectFormat(const QString& path)
+{
+    return QFileInfo(path).suffix().compare("csv", Qt::CaseInsensitive) == 0 ? Csv : JsonLines;
+}
+
+qint64 TaskExporter::exportTo(const QString& databasePath, QIODevice& output, const Options& options,
+                              const Progress& progress)
+{
+    TRACE_SCOPE("TaskExporter::exportTo", "sql");
+    ReadConnection connection(databasePath, ReadConnection::uniqueName("task_exporter"));
+    BufferedWriter writer(output);
+
+    if (options.format == Csv) {
+        writer.append(columns.join(',').toUtf8() + '\n');
+    }
+
+    // Проходы: задачи main, задачи каждого файла пр-ва (подключается к этому соединению), история
+    struct Pass {
+        bool history;
+        int splitWorkspace;
+    };
+    QVector<Pass> passes = {{false, 0}};
+    for (int workspaceId : splitWorkspaces(connection, databasePath, options.workspaceId)) {
+        passes.append({false, workspaceId});
+    }
+    if (options.includeHistory) passes.append({true, 0});
+
+    QSqlDatabase db = connection.database();
+    qint64 rows = 0;
+    for (const Pass& pass : passes) {
+        QString schema = "main";
+        if (pass.splitWorkspace != 0) {
+            schema = WorkspaceStorage::schemaName(pass.splitWorkspace);
+            QSqlQuery attach = connection.prepare(QString("ATTACH DATABASE :path AS %1").arg(schema));
+            attach.bindValue(":path", WorkspaceStorage::fileFor(databasePath, pass.splitWorkspace));
+            ReadConnection::exec(attach);
+        }
+
+        const QString sql = selectSql(pass.history, options.workspaceId != 0, schema);
+        SqlProfileScope profile(sql);
+        QSqlQuery query = connection.prepare(sql);
+        if (options.workspaceId != 0) query.bindValue(":workspace_id", options.workspaceId);
+        ReadConnection::exec(query);
+        profile.stop();
+
+        const QString source = pass.history ? "history" : "task";
+        while (query.next()) {
+            QStringList tags = query.value(3).toString().split(tagSeparator, Qt::SkipEmptyParts);
+
+            if (options.format == Csv) {
+                QByteArray line = csvField(source);
+                for (int column = 0; column < 8; ++column) {
+                    line += ',';
+                    line += csvField(column == 3 ? tags.join(';') : query.value(column).toString());
+                }
+                writer.append(line + '\n');
+            } else {
+                QJsonObject object;
+                object["source"] = source;
+                object["workspace"] = query.value(0).toString();
+                object["category"] = query.value(1).toString();
+                object["description"] = query.value(2).toString();
+                object["tags"] = QJsonArray::fromStringList(tags);
+                object["difficulty"] = query.value(4).toString();
+                object["priority"] = query.value(5).toString();
+                object["status"] = query.value(6).toString();
+                object["deadline"] = query.value(7).toString();
+                writer.append(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+            }
+
+            profile.addRows();
+            if (++rows % progressInterval == 0 && progress && !progress(rows)) {
+                return -1;
+            }
+        }
+
+        if (pass.splitWorkspace != 0) {
+            query.finish();
+            QSqlQuery(db).exec("DETACH DATABASE " + schema);
+        }
+    }
+
+    writer.flush();
+    if (progress) progress(rows);
+    return rows;
+}
+
+bool TaskExporter::start(const QString& databasePath, const QString& outputPath, const Options& options)
+{
+    if (isRunning()) return false;
+    cancelled.store(false);
+
+    worker = QThread::create([this, databasePath, outputPath, options]() {
+        QSaveFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            emit finished(false, 0, file.errorString());
+            return;
+        }
+
+        try {
+            qint64 rows = exportTo(databasePath, file, options, [this](qint64 rows) {
+                emit progress(rows);
+                return !cancelled.load();
+            });
+
+            if (rows < 0) {
+                file.cancelWriting();
+                emit finished(false, 0, QString());
+            } else if (!file.commit()) {
+                emit finished(false, rows, file.errorString());
+            } else {
+                qCInfo(lcDb) << "Exported" << rows << "rows to" << outputPath;
+                emit finished(true, rows, QString());
+            }
+        } catch (const std::exception& e) {
+            file.cancelWriting();
+            qCWarning(lcDb) << "Export failed:" << e.what();
+            emit finished(false, 0, QString::fromUtf8(e.what()));
+        }
+    });
+    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+    worker->start(QThread::LowPriority);
+    return true;
+}
+
+void TaskExporter::cancel()
+{
+    cancelled.store(true);
+}
+
+bool TaskExporter::isRunning() const
+{
+    return worker && !worker->isFinished();
+}
@@ -0,0 +1,59 @@
+#ifndef TASKEXPORTER_H
+#define TASKEXPORTER_H
+
+#include <QIODevice>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <functional>
+
+// Потоковый экспорт задач (и истории) в JSON Lines или CSV прямо из forward-only курсора:
+// объекты Task не создаются, память не зависит от размера бд.
+// Поля совпадают с TaskImporter плюс source (task / history)
+class TaskExporter : public QObject {
+    Q_OBJECT
+
+public:
+    enum Format {
+        Csv,
+        JsonLines
+    };
+
+    struct Options {
+        Format format = JsonLines;
+        int workspaceId = 0;       // 0 - вся бд
+        bool includeHistory = true;
+    };
+
+    // Число записанных строк; false - отмена
+    using Progress = std::function<bool(qint64 rows)>;
+
+    explicit TaskExporter(QObject* parent = nullptr);
+    ~TaskExporter() override;
+
+    // По расширению: .csv - CSV, остальное - JSON Lines
+    static Format detectFormat(const QString& path);
+
+    // Синхронный экспорт через свое соединение (можно звать из любого потока).
+    // Возвращает число строк, бросает std::runtime_error; при отмене возвращает -1
+    static qint64 exportTo(const QString& databasePath, QIODevice& output, const Options& options,
+                           const Progress& progress = Progress());
+
+    // Экспорт в файл в рабочем потоке; по окончании - finished() (при отмене ok = false
+    // и пустая ошибка). Файл пишется через QSaveFile: при ошибке или отмене старый файл не трогается
+    bool start(const QString& databasePath, const QString& outputPath, const Options& options);
+    void cancel();
+    bool isRunning() const;
+
+signals:
+    void progress(qint64 rows);
+    void finished(bool ok, qint64 rows, const QString& error);
+
+private:
+    QPointer<QThread> worker;
+    std::atomic<bool> cancelled{false};
+};
+
+#endif // TASKEXPORTER_H
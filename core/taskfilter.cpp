@@ -0,0 +1,187 @@
+#include "taskfilter.h"
+#include "tracer.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+// Текстовое описание плана (для отладки)
+QString TaskFilterPlan::describe() const
+{
+    QString text;
+    switch (planSource) {
+    case AllTasks: text = "scan all"; break;
+    case TagIndex: text = "tag index [" + sourceTags.join(", ") + "]"; break;
+    case StatusIndex: text = "status index"; break;
+    case Nothing: text = "empty"; break;
+    }
+    if (!predicateNames.isEmpty()) {
+        text += " -> " + predicateNames.join(" -> ");
+    }
+    return text;
+}
+
+// Построение индексов для новой версии снимка
+void TaskFilterEngine::ensureIndex(const ModelSnapshotPtr& snapshot)
+{
+    if (indexedSnapshot && indexedSnapshot->version == snapshot->version) return;
+
+    rows.clear();
+    rowsByTag.clear();
+    for (QVector<int>& statusRows : rowsByStatus) {
+        statusRows.clear();
+    }
+    rows.reserve(snapshot->taskCount);
+
+    for (const WorkspaceSnapshotPtr& workspace : snapshot->workspaces) {
+        for (const CategorySnapshotPtr& category : workspace->categories) {
+            for (const TaskSnapshotPtr& task : category->tasks) {
+                int row = rows.size();
+                rows.append({workspace->name, task});
+
+                for (const QString& tag : task->tagKeys) {
+                    QVector<int>& tagRows = rowsByTag[tag];
+                    if (tagRows.isEmpty() || tagRows.last() != row) {
+                        tagRows.append(row);
+                    }
+                }
+                if (task->statusCode >= 0) {
+                    rowsByStatus[task->statusCode].append(row);
+                }
+            }
+        }
+    }
+
+    indexedSnapshot = snapshot;
+}
+
+// Компиляция критериев в план
+TaskFilterPlan TaskFilterEngine::compile(const ModelSnapshotPtr& snapshot, const TaskFilterCriteria& criteria)
+{
+    ensureIndex(snapshot);
+
+    TaskFilterPlan plan;
+
+    QStringList tagKeys;
+    for (const QString& tag : criteria.tags) {
+        QString key = searchKey(tag);
+        if (!key.isEmpty() && !tagKeys.contains(key)) tagKeys.append(key);
+    }
+
+    // Источник кандидатов: самый селективный доступный индекс
+    if (!tagKeys.isEmpty()) {
+        plan.planSource = TaskFilterPlan::TagIndex;
+        for (const QString& key : tagKeys) {
+            if (!rowsByTag.contains(key)) {
+                plan.planSource = TaskFilterPlan::Nothing;
+                return plan;
+            }
+        }
+        std::sort(tagKeys.begin(), tagKeys.end(), [this](const QString& a, const QString& b) {
+            return rowsByTag.value(a).size() < rowsByTag.value(b).size();
+        });
+        plan.sourceTags = tagKeys;
+    } else if (!criteria.statuses.isEmpty()) {
+        plan.planSource = TaskFilterPlan::StatusIndex;
+        plan.sourceStatuses = criteria.statuses;
+    }
+
+    // Остаточные предикаты: сравнения чисел, затем поиск подстроки
+    if (!criteria.statuses.isEmpty() && plan.planSource != TaskFilterPlan::StatusIndex) {
+        QVector<int> statuses = criteria.statuses;
+        plan.predicateNames.append("status");
+        plan.predicates.append([statuses](const TaskSnapshot& task) {
+            return statuses.contains(task.statusCode);
+        });
+    }
+    if (!criteria.priorities.isEmpty()) {
+        QVector<int> priorities = criteria.priorities;
+        plan.predicateNames.append("priority");
+        plan.predicates.append([priorities](const TaskSnapshot& task) {
+            return priorities.contains(task.priorityRank);
+        });
+    }
+    if (!criteria.difficulties.isEmpty()) {
+        QVector<int> difficulties = criteria.difficulties;
+        plan.predicateNames.append("difficulty");
+        plan.predicates.append([difficulties](const TaskSnapshot& task) {
+            return difficulties.contains(task.difficultyRank);
+        });
+    }
+    if (criteria.deadlineFrom.isValid() || criteria.deadlineTo.isValid()) {
+        qint64 from = criteria.deadlineFrom.isValid() ? criteria.deadlineFrom.toJulianDay()
+                                                      : std::numeric_limits<qint64>::min();
+        qint64 to = criteria.deadlineTo.isValid() ? criteria.deadlineTo.toJulianDay()
+                                                  : std::numeric_limits<qint64>::max();
+        plan.predicateNames.append("deadline");
+        plan.predicates.append([from, to](const TaskSnapshot& task) {
+            return task.deadlineDay != 0 && task.deadlineDay >= from && task.deadlineDay <= to;
+        });
+    }
+    QString textKey = searchKey(criteria.text);
+    if (!textKey.isEmpty()) {
+        plan.predicateNames.append("text");
+        plan.predicates.append([textKey](const TaskSnapshot& task) {
+            return task.descriptionKey.contains(textKey);
+        });
+    }
+
+    return plan;
+}
+
+// Кандидаты из индексов (номера строк по возрастанию)
+QVector<int> TaskFilterEngine::candidates(const TaskFilterPlan& plan) const
+{
+    QVector<int> result;
+
+    switch (plan.planSource) {
+    case TaskFilterPlan::Nothing:
+        break;
+    case TaskFilterPlan::AllTasks:
+        result.resize(rows.size());
+        std::iota(result.begin(), result.end(), 0);
+        break;
+    case TaskFilterPlan::TagIndex: {
+        // Пересечение списков начиная с самого короткого
+        result = rowsByTag.value(plan.sourceTags.first());
+        for (int i = 1; i < plan.sourceTags.size() && !result.isEmpty(); ++i) {
+            const QVector<int> other = rowsByTag.value(plan.sourceTags[i]);
+            QVector<int> intersection;
+            std::set_intersection(result.begin(), result.end(), other.begin(), other.end(),
+                                  std::back_inserter(intersection));
+            result.swap(intersection);
+        }
+        break;
+    }
+    case TaskFilterPlan::StatusIndex:
+        for (int status : plan.sourceStatuses) {
+            if (status >= 0 && status < 3) result += rowsByStatus[status];
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        break;
+    }
+
+    return result;
+}
+
+// Выполнение фильтра
+QVector<TaskFilterHit> TaskFilterEngine::run(const ModelSnapshotPtr& snapshot, const TaskFilterCriteria& criteria)
+{
+    TRACE_SCOPE("TaskFilterEngine::run", "search");
+    TaskFilterPlan plan = compile(snapshot, criteria);
+
+    QVector<TaskFilterHit> result;
+    for (int row : candidates(plan)) {
+        const TaskFilterHit& hit = rows.at(row);
+        bool matches = true;
+        for (const auto& predicate : plan.predicates) {
+            if (!predicate(*hit.task)) {
+                matches = false;
+                break;
+            }
+        }
+        if (matches) result.append(hit);
+    }
+    return result;
+}
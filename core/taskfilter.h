@@ -0,0 +1,66 @@
+#ifndef TASKFILTER_H
+#define TASKFILTER_H
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+#include "modelsnapshot.h"
+
+// Критерии фильтра (пустое поле - без ограничения)
+struct TaskFilterCriteria {
+    QVector<int> statuses;      // TaskStatusCode
+    QVector<int> priorities;    // taskPriorityRank()
+    QVector<int> difficulties;  // taskDifficultyRank()
+    QDate deadlineFrom;
+    QDate deadlineTo;
+    QStringList tags;           // задача должна иметь все теги
+    QString text;               // подстрока описания (без учета регистра)
+};
+
+struct TaskFilterHit {
+    QString workspace;
+    TaskSnapshotPtr task;
+};
+
+// Скомпилированный план: источник кандидатов (индекс) + оставшиеся предикаты,
+// отсортированные от дешевых к дорогим
+class TaskFilterPlan {
+public:
+    enum Source { AllTasks, TagIndex, StatusIndex, Nothing };
+
+    Source source() const { return planSource; }
+    int predicateCount() const { return predicates.size(); }
+    QString describe() const;
+
+private:
+    friend class TaskFilterEngine;
+
+    Source planSource = AllTasks;
+    QStringList sourceTags;
+    QVector<int> sourceStatuses;
+    QStringList predicateNames;
+    QVector<std::function<bool(const TaskSnapshot&)>> predicates;
+};
+
+// Фильтрация задач всех рабочих пр-в по снимку модели.
+// Индексы (тег -> задачи, статус -> задачи) строятся один раз на версию снимка
+class TaskFilterEngine {
+public:
+    QVector<TaskFilterHit> run(const ModelSnapshotPtr& snapshot, const TaskFilterCriteria& criteria);
+    TaskFilterPlan compile(const ModelSnapshotPtr& snapshot, const TaskFilterCriteria& criteria);
+
+private:
+    void ensureIndex(const ModelSnapshotPtr& snapshot);
+    QVector<int> candidates(const TaskFilterPlan& plan) const;
+
+    ModelSnapshotPtr indexedSnapshot;
+    QVector<TaskFilterHit> rows;
+    QHash<QString, QVector<int>> rowsByTag;
+    QVector<int> rowsByStatus[3];
+};
+
+#endif // TASKFILTER_H
@@ -0,0 +1,441 @@
+#include "taskimporter.h"
+#include "applog.h"
+#include "tracer.h"
+#include <QDate>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QVariant>
+#include <stdexcept>
+
+namespace {
+
+// Поля Record в порядке csvColumns
+const QStringList fieldNames = {
+    "workspace", "category", "description", "tags", "difficulty", "priority", "status", "deadline", "source"
+};
+
+enum Field {
+    FieldWorkspace,
+    FieldCategory,
+    FieldDescription,
+    FieldTags,
+    FieldDifficulty,
+    FieldPriority,
+    FieldStatus,
+    FieldDeadline,
+    FieldSource         // task / history (экспорт TaskExporter), история не импортируется
+};
+
+// Прогресс (и проверка отмены) раз в столько записей
+const int progressInterval = 1024;
+
+void prepare(QSqlQuery& query, const QString& sql)
+{
+    if (!query.prepare(sql)) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+}
+
+void exec(QSqlQuery& query)
+{
+    if (!query.exec()) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+}
+
+// Теги без пустых и без повторов (без учета регистра)
+QStringList cleanTags(const QStringList& tags)
+{
+    QStringList result;
+    for (const QString& tag : tags) {
+        QString trimmed = tag.trimmed();
+        if (!trimmed.isEmpty() && !result.contains(trimmed, Qt::CaseInsensitive)) {
+            result.append(trimmed);
+        }
+    }
+    return result;
+}
+
+// Срок в формате приложения (dd-MM-yyyy), ISO-даты переводятся
+QString normalizeDeadline(const QString& deadline)
+{
+    QString trimmed = deadline.trimmed();
+    QDate iso = QDate::fromString(trimmed, Qt::ISODate);
+    return iso.isValid() ? iso.toString("dd-MM-yyyy") : trimmed;
+}
+
+} // namespace
+
+TaskImporter::TaskImporter(TaskRepository& repository)
+    : repository(repository)
+{
+}
+
+TaskImporter::Format TaskImporter::detectFormat(const QString& path)
+{
+    return QFileInfo(path).suffix().compare("csv", Qt::CaseInsensitive) == 0 ? Csv : JsonLines;
+}
+
+ImportResult TaskImporter::import(QIODevice& device, Format format, const ImportOptions& options,
+                                  const Progress& progress)
+{
+    TRACE_SCOPE("TaskImporter::import", "sql");
+    ImportResult result;
+
+    schemaQueries.clear();
+    loadExistingIds();
+
+    if (format == Csv) {
+        QStringList header;
+        if (!readCsvRecord(device, &header) || !parseCsvHeader(header)) {
+            throw std::runtime_error("CSV header must contain workspace, category and description columns");
+        }
+    }
+
+    const int chunkSize = qMax(1, options.chunkSize);
+    const qint64 total = device.isSequential() ? -1 : device.size();
+    int processed = 0;
+
+    if (!repository.transaction()) {
+        throw std::runtime_error(repository.lastError().toStdString());
+    }
+    try {
+        while (true) {
+            Record record;
+            bool valid = false;
+
+            if (format == Csv) {
+                QStringList fields;
+                if (!readCsvRecord(device, &fields)) break;
+                valid = recordFromCsv(fields, &record);
+            } else {
+                if (device.atEnd()) break;
+                QByteArray line = device.readLine().trimmed();
+                if (line.isEmpty()) continue;
+                valid = recordFromJson(line, &record);
+            }
+
+            if (!valid) {
+                result.skipped++;
+                continue;
+            }
+
+            insert(record, options);
+
+            if (chunkTasks.size() >= chunkSize) {
+                commitChunk();
+                if (!repository.transaction()) {
+                    throw std::runtime_error(repository.lastError().toStdString());
+                }
+            }
+
+            if (++processed % progressInterval == 0 && progress && !progress(device.pos(), total)) {
+                result.cancelled = true;
+                break;
+            }
+        }
+
+        if (result.cancelled) {
+            rollbackChunk();
+        } else {
+            commitChunk();
+        }
+    } catch (...) {
+        rollbackChunk();
+        schemaQueries.clear();
+        repository.flush();
+        throw;
+    }
+    // Запросы к файлам пр-в не должны держать их подключенными
+    schemaQueries.clear();
+    repository.flush();
+
+    if (progress && !result.cancelled) progress(device.pos(), total);
+
+    result.tasks = importedTasks.size();
+    result.workspacesCreated = createdWorkspaces.size();
+    result.categoriesCreated = createdCategories.size();
+    qCInfo(lcDb) << "Imported" << result.tasks << "tasks," << result.workspacesCreated << "workspaces,"
+                 << result.categoriesCreated << "categories," << result.skipped << "skipped"
+                 << (result.cancelled ? "(cancelled)" : "");
+    return result;
+}
+
+// Одна запись CSV (RFC 4180: кавычки, "" внутри кавычек, переносы строк в поле)
+bool TaskImporter::readCsvRecord(QIODevice& device, QStringList* fields)
+{
+    fields->clear();
+    if (device.atEnd()) return false;
+
+    QString field;
+    bool quoted = false;
+    bool any = false;
+
+    while (!device.atEnd()) {
+        QString line = QString::fromUtf8(device.readLine());
+        if (!quoted) {
+            while (line.endsWith('\n') || line.endsWith('\r')) line.chop(1);
+            if (line.isEmpty() && fields->isEmpty() && field.isEmpty()) continue;
+        }
+        any = true;
+
+        for (int i = 0; i < line.size(); ++i) {
+            QChar c = line[i];
+            if (quoted) {
+                if (c == '"') {
+                    if (i + 1 < line.size() && line[i + 1] == '"') {
+                        field += '"';
+                        ++i;
+                    } else {
+                        quoted = false;
+                    }
+                } else {
+                    field += c;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields->append(field);
+                field.clear();
+            } else if (c != '\r' && c != '\n') {
+                field += c;
+            }
+        }
+
+        // Поле в кавычках продолжается на следующей строке
+        if (!quoted) break;
+    }
+
+    if (!any) return false;
+    fields->append(field);
+    return true;
+}
+
+bool TaskImporter::parseCsvHeader(const QStringList& header)
+{
+    csvColumns = QVector<int>(fieldNames.size(), -1);
+    for (int column = 0; column < header.size(); ++column) {
+        QString name = header[column].trimmed().toLower();
+        if (column == 0 && name.startsWith(QChar(0xFEFF))) name.remove(0, 1);
+        int field = fieldNames.indexOf(name);
+        if (field >= 0) csvColumns[field] = column;
+    }
+    return csvColumns[FieldWorkspace] >= 0 && csvColumns[FieldCategory] >= 0 && csvColumns[FieldDescription] >= 0;
+}
+
+bool TaskImporter::recordFromCsv(const QStringList& fields, Record* record) const
+{
+    auto value = [&](Field field) {
+        int column = csvColumns[field];
+        return column >= 0 && column < fields.size() ? fields[column].trimmed() : QString();
+    };
+
+    record->workspace = value(FieldWorkspace);
+    record->category = value(FieldCategory);
+    record->description = value(FieldDescription);
+    record->tags = cleanTags(value(FieldTags).split(';'));
+    record->difficulty = value(FieldDifficulty);
+    record->priority = value(FieldPriority);
+    record->status = value(FieldStatus);
+    record->deadline = normalizeDeadline(value(FieldDeadline));
+    if (value(FieldSource) == "history") return false;
+    return !record->workspace.isEmpty() && !record->category.isEmpty() && !record->description.isEmpty();
+}
+
+bool TaskImporter::recordFromJson(const QByteArray& line, Record* record)
+{
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        qCDebugRow(lcDb) << "Skipping malformed JSON line:" << error.errorString();
+        return false;
+    }
+
+    QJsonObject object = document.object();
+    record->workspace = object.value("workspace").toString().trimmed();
+    record->category = object.value("category").toString().trimmed();
+    record->description = object.value("description").toString().trimmed();
+
+    QJsonValue tags = object.value("tags");
+    if (tags.isArray()) {
+        QStringList list;
+        for (const QJsonValue& tag : tags.toArray()) {
+            list.append(tag.toString());
+        }
+        record->tags = cleanTags(list);
+    } else {
+        record->tags = cleanTags(tags.toString().split(','));
+    }
+
+    record->difficulty = object.value("difficulty").toString().trimmed();
+    record->priority = object.value("priority").toString().trimmed();
+    record->status = object.value("status").toString().trimmed();
+    record->deadline = normalizeDeadline(object.value("deadline").toString());
+    if (object.value("source").toString() == "history") return false;
+    return !record->workspace.isEmpty() && !record->category.isEmpty() && !record->description.isEmpty();
+}
+
+// Хеши имен уже существующих рабочих пр-в и категорий
+void TaskImporter::loadExistingIds()
+{
+    workspaceIds.clear();
+    categoryIds.clear();
+
+    QSqlQuery query(repository.database());
+    query.setForwardOnly(true);
+    prepare(query, "SELECT id, name FROM Workspaces WHERE deleted = 0");
+    exec(query);
+    while (query.next()) {
+        workspaceIds.insert(query.value(1).toString(), query.value(0).toInt());
+    }
+
+    prepare(query, "SELECT id, name, workspace_id FROM Categories WHERE deleted = 0");
+    exec(query);
+    while (query.next()) {
+        categoryIds.insert(qMakePair(query.value(2).toInt(), query.value(1).toString()), query.value(0).toInt());
+    }
+}
+
+int TaskImporter::resolveWorkspace(const QString& name)
+{
+    auto it = workspaceIds.constFind(name);
+    if (it != workspaceIds.constEnd()) return it.value();
+
+    int id = repository.insertWorkspace(name);
+    workspaceIds.insert(name, id);
+    chunkWorkspaces.append({id, name, 0});
+    return id;
+}
+
+int TaskImporter::resolveCategory(int workspaceId, const QString& name)
+{
+    const QPair<int, QString> key = qMakePair(workspaceId, name);
+    auto it = categoryIds.constFind(key);
+    if (it != categoryIds.constEnd()) return it.value();
+
+    int id = repository.insertCategory(name, workspaceId);
+    categoryIds.insert(key, id);
+    chunkCategories.append({id, name, workspaceId});
+    return id;
+}
+
+TaskImporter::InsertQueries& TaskImporter::insertQueries(const QString& schema)
+{
+    auto it = schemaQueries.find(schema);
+    if (it != schemaQueries.end()) return it.value();
+
+    InsertQueries queries{QSqlQuery(repository.database()), QSqlQuery(repository.database())};
+    prepare(queries.task, QString("INSERT INTO %1.Tasks (description, category_id, difficulty, priority, status, deadline) "
+                                  "VALUES (?, ?, ?, ?, ?, ?)").arg(schema));
+    prepare(queries.tag, QString("INSERT INTO %1.TaskTags (task_id, tag) VALUES (?, ?)").arg(schema));
+    return schemaQueries.insert(schema, queries).value();
+}
+
+void TaskImporter::insert(const Record& record, const ImportOptions& options)
+{
+    int categoryId = resolveCategory(resolveWorkspace(record.workspace), record.category);
+    InsertQueries& queries = insertQueries(repository.workspaceStorage().schemaForCategory(categoryId));
+
+    ImportedTask task{0, categoryId, record};
+    if (task.record.difficulty.isEmpty()) task.record.difficulty = options.defaultDifficulty;
+    if (task.record.priority.isEmpty()) task.record.priority = options.defaultPriority;
+    if (task.record.status.isEmpty()) task.record.status = options.defaultStatus;
+
+    queries.task.bindValue(0, task.record.description);
+    queries.task.bindValue(1, categoryId);
+    queries.task.bindValue(2, task.record.difficulty);
+    queries.task.bindValue(3, task.record.priority);
+    queries.task.bindValue(4, task.record.status);
+    queries.task.bindValue(5, task.record.deadline);
+    exec(queries.task);
+    task.id = queries.task.lastInsertId().toInt();
+
+    for (const QString& tag : task.record.tags) {
+        queries.tag.bindValue(0, task.id);
+        queries.tag.bindValue(1, tag);
+        exec(queries.tag);
+    }
+
+    chunkTasks.append(task);
+}
+
+void TaskImporter::commitChunk()
+{
+    TRACE_SCOPE("TaskImporter::commitChunk", "sql");
+    // Порция - отдельная транзакция на диске, без ожидания окна группировки
+    if (!repository.commit() || !repository.flush()) {
+        throw std::runtime_error(repository.lastError().toStdString());
+    }
+
+    createdWorkspaces += chunkWorkspaces;
+    createdCategories += chunkCategories;
+    importedTasks += chunkTasks;
+    chunkWorkspaces.clear();
+    chunkCategories.clear();
+    chunkTasks.clear();
+}
+
+// Откат текущей порции и забывание созданных в ней id.
+// Файлы созданных в порции пр-в WorkspaceStorage удалит, не найдя их в откаченном каталоге
+void TaskImporter::rollbackChunk()
+{
+    repository.rollback();
+
+    WorkspaceStorage& storage = repository.workspaceStorage();
+    for (const NamedRow& row : chunkCategories) {
+        categoryIds.remove(qMakePair(row.parentId, row.name));
+        storage.removeCategory(row.id);
+    }
+    for (const NamedRow& row : chunkWorkspaces) {
+        workspaceIds.remove(row.name);
+        storage.removeWorkspace(row.id);
+    }
+    chunkWorkspaces.clear();
+    chunkCategories.clear();
+    chunkTasks.clear();
+}
+
+void TaskImporter::applyTo(QMap<QString, Workspace*>& workspaces)
+{
+    TRACE_SCOPE("TaskImporter::applyTo", "model");
+
+    QHash<int, Workspace*> workspacesById;
+    for (Workspace* workspace : workspaces) {
+        workspacesById.insert(workspace->getId(), workspace);
+    }
+    for (const NamedRow& row : createdWorkspaces) {
+        Workspace* workspace = new Workspace(row.id, row.name);
+        workspaces[row.name] = workspace;
+        workspacesById.insert(row.id, workspace);
+    }
+    for (const NamedRow& row : createdCategories) {
+        if (Workspace* workspace = workspacesById.value(row.parentId)) {
+            workspace->addCategory(row.id, row.name);
+        }
+    }
+
+    QHash<int, Category*> categoriesById;
+    for (Workspace* workspace : workspaces) {
+        for (Category* category : workspace->getCategories()) {
+            categoriesById.insert(category->getId(), category);
+        }
+    }
+
+    for (const ImportedTask& task : importedTasks) {
+        Category* category = categoriesById.value(task.categoryId);
+        if (!category) {
+            qCWarning(lcModel) << "Imported task" << task.id << "has no category in the model";
+            continue;
+        }
+        const Record& record = task.record;
+        category->addTask(new Task(task.id, record.description, category->getName(), record.tags,
+                                   record.difficulty, record.priority, record.status, record.deadline));
+    }
+
+    createdWorkspaces.clear();
+    createdCategories.clear();
+    importedTasks.clear();
+}
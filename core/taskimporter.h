@@ -0,0 +1,120 @@
+#ifndef TASKIMPORTER_H
+#define TASKIMPORTER_H
+
+#include <QHash>
+#include <QIODevice>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+#include "taskmodel.h"
+#include "taskrepository.h"
+
+// Параметры импорта
+struct ImportOptions {
+    int chunkSize = 5000;          // задач на транзакцию
+    QString defaultStatus;         // для записей без статуса
+    QString defaultDifficulty;
+    QString defaultPriority;
+};
+
+struct ImportResult {
+    int tasks = 0;
+    int workspacesCreated = 0;
+    int categoriesCreated = 0;
+    int skipped = 0;               // строки без описания, пр-ва или категории, история и битый JSON
+    bool cancelled = false;
+};
+
+// Потоковый импорт задач из CSV (первая строка - заголовок) или JSON Lines.
+// Поля: workspace, category, description, tags, difficulty, priority, status, deadline;
+// теги в CSV через ';', в JSON - массив или строка через ','. Строки истории из
+// TaskExporter (source = history) пропускаются.
+// Рабочие пр-ва и категории находятся (или создаются через TaskRepository, в режиме
+// отдельных файлов - с регистрацией в WorkspaceStorage) по хешам имен, задачи и теги
+// вставляются переиспользуемыми подготовленными запросами (свои на каждую схему) порциями по chunkSize.
+// Бросает std::runtime_error; уже зафиксированные порции остаются в бд
+class TaskImporter {
+public:
+    enum Format {
+        Csv,
+        JsonLines
+    };
+
+    // Обработано байт из total; false - отмена (текущая порция откатывается)
+    using Progress = std::function<bool(qint64 processed, qint64 total)>;
+
+    explicit TaskImporter(TaskRepository& repository);
+
+    // По расширению: .csv - CSV, остальное - JSON Lines
+    static Format detectFormat(const QString& path);
+
+    ImportResult import(QIODevice& device, Format format, const ImportOptions& options = ImportOptions(),
+                        const Progress& progress = Progress());
+
+    // Перенос зафиксированных задач в модель одним проходом
+    void applyTo(QMap<QString, Workspace*>& workspaces);
+
+private:
+    struct Record {
+        QString workspace;
+        QString category;
+        QString description;
+        QStringList tags;
+        QString difficulty;
+        QString priority;
+        QString status;
+        QString deadline;
+    };
+
+    struct NamedRow {
+        int id;
+        QString name;
+        int parentId;
+    };
+
+    struct ImportedTask {
+        int id;
+        int categoryId;
+        Record record;
+    };
+
+    // Вставка задач и тегов в main или в подключенный файл пр-ва
+    struct InsertQueries {
+        QSqlQuery task;
+        QSqlQuery tag;
+    };
+
+    bool readCsvRecord(QIODevice& device, QStringList* fields);
+    bool parseCsvHeader(const QStringList& header);
+    bool recordFromCsv(const QStringList& fields, Record* record) const;
+    static bool recordFromJson(const QByteArray& line, Record* record);
+
+    void loadExistingIds();
+    int resolveWorkspace(const QString& name);
+    int resolveCategory(int workspaceId, const QString& name);
+    InsertQueries& insertQueries(const QString& schema);
+    void insert(const Record& record, const ImportOptions& options);
+    void commitChunk();
+    void rollbackChunk();
+
+    TaskRepository& repository;
+    QHash<QString, InsertQueries> schemaQueries;
+
+    QHash<QString, int> workspaceIds;
+    QHash<QPair<int, QString>, int> categoryIds;
+    QVector<int> csvColumns;       // номер столбца для каждого поля Record (-1 - нет)
+
+    // Текущая порция (до commit) и уже зафиксированное
+    QVector<NamedRow> chunkWorkspaces;
+    QVector<NamedRow> chunkCategories;
+    QVector<ImportedTask> chunkTasks;
+    QVector<NamedRow> createdWorkspaces;
+    QVector<NamedRow> createdCategories;
+    QVector<ImportedTask> importedTasks;
+};
+
+#endif // TASKIMPORTER_H
@@ -0,0 +1,125 @@
+#ifndef TASKMODEL_H
+#define TASKMODEL_H
+
+#include <QDate>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class Notification {
+public:
+    Notification(const QString& taskDesc, const QString& deadlineDate, bool isEnglish = false)
+        : taskDescription(taskDesc), deadline(deadlineDate), viewed(false) {
+        updateMessage(isEnglish);
+    }
+
+    QString getMessage() const { return message; }
+    QString getTaskDescription() const { return taskDescription; }
+    QString getDeadline() const { return deadline; }
+    bool isViewed() const { return viewed; }
+    void markAsViewed() { viewed = true; }
+    void updateMessage(bool isEnglish) {
+        message = isEnglish ?
+                      QString("Attention! Deadline for task \"%1\" expires: %2").arg(taskDescription).arg(deadline) :
+                      QString("Внимание! Срок выполнения задачи \"%1\" истекает: %2").arg(taskDescription).arg(deadline);
+    }
+
+private:
+    QString message;
+    QString taskDescription;
+    QString deadline;
+    bool viewed;
+};
+
+class Task {
+public:
+    Task(int id, const QString& desc, const QString& cat, const QStringList& tg,
+         const QString& diff = "Medium", const QString& prio = "Medium",
+         const QString& stat = "Pending", const QString& dl = "")
+        : id(id), description(desc), category(cat), tags(tg),
+        difficulty(diff), priority(prio), status(stat), deadline(dl) {}
+
+    int getId() const { return id; }
+    QString getDescription() const { return description; }
+    QString getCategory() const { return category; }
+    QStringList getTags() const { return tags; }
+    QString getDifficulty() const { return difficulty; }
+    QString getPriority() const { return priority; }
+    QString getStatus() const { return status; }
+    QString getDeadline() const { return deadline; }
+
+    void setDifficulty(const QString& diff) { difficulty = diff; }
+    void setPriority(const QString& prio) { priority = prio; }
+    void setStatus(const QString& stat) { status = stat; }
+    void setDeadline(const QString& dl) { deadline = dl; }
+
+    int daysUntilDeadline() const {
+        if (deadline.isEmpty()) return -1;
+        QDate deadlineDate = QDate::fromString(deadline, "dd-MM-yyyy");
+        if (!deadlineDate.isValid()) return -1;
+        return QDate::currentDate().daysTo(deadlineDate);
+    }
+
+private:
+    int id;
+    QString description;
+    QString category;
+    QStringList tags;
+    QString difficulty;
+    QString priority;
+    QString status;
+    QString deadline;
+};
+
+class Category {
+public:
+    Category(int id, const QString& name) : id(id), name(name) {}
+
+    int getId() const { return id; }
+    void addTask(Task* task) { tasks.append(task); }
+    QString getName() const { return name; }
+    QVector<Task*>& getTasks() { return tasks; }
+
+    void removeTask(const QString& taskDesc) {
+        for (int i = 0; i < tasks.size(); ++i) {
+            if (tasks[i]->getDescription() == taskDesc) {
+                delete tasks[i];
+                tasks.remove(i);
+                break;
+            }
+        }
+    }
+
+private:
+    int id;
+    QString name;
+    QVector<Task*> tasks;
+};
+
+class Workspace {
+public:
+    Workspace(int id, const QString& name) : id(id), name(name) {}
+
+    int getId() const { return id; }
+    void addCategory(int id, const QString& categoryName) {
+        categories[categoryName] = new Category(id, categoryName);
+    }
+
+    QMap<QString, Category*>& getCategories() { return categories; }
+    QString getName() const { return name; }
+
+    void removeCategory(const QString& categoryName) {
+        if (categories.contains(categoryName)) {
+            delete categories[categoryName];
+            categories.remove(categoryName);
+        }
+    }
+
+private:
+    int id;
+    QString name;
+    QMap<QString, Category*> categories;
+};
+
+#endif // TASKMODEL_H
@@ -0,0 +1,850 @@
+#include "taskrepository.h"
+#include "tracer.h"
+#include "sqlprofiler.h"
+#include "applog.h"
+#include <QHash>
+#include <QSqlError>
+#include <QVariant>
+#include <stdexcept>
+
+TaskRepository::TaskRepository(const QString& connectionName)
+    : connection(connectionName)
+{
+}
+
+TaskRepository::~TaskRepository()
+{
+    close();
+}
+
+// Открытие бд
+bool TaskRepository::open(const QString& path)
+{
+    db = QSqlDatabase::contains(connection) ? QSqlDatabase::database(connection, false)
+                                            : QSqlDatabase::addDatabase("QSQLITE", connection);
+    db.setDatabaseName(path);
+    schemaError.clear();
+    if (!db.open()) {
+        return false;
+    }
+
+    // WAL: читатели (в т.ч. параллельная загрузка) не блокируются записью.
+    // synchronous=NORMAL - fsync только при контрольной точке, а не на каждую фиксацию
+    executeSQL("PRAGMA journal_mode=WAL;");
+    executeSQL("PRAGMA synchronous=NORMAL;");
+    executeSQL("PRAGMA cache_size=-16384;");
+    executeSQL("PRAGMA mmap_size=268435456;");
+    executeSQL("PRAGMA temp_store=MEMORY;");
+    // Каскадное удаление (ON DELETE) работает только с включенными внешними ключами,
+    // а настройка действует на соединение - включается сразу, не только в createSchema()
+    executeSQL("PRAGMA foreign_keys = ON;");
+    return true;
+}
+
+void TaskRepository::close()
+{
+    if (db.isOpen()) {
+        writes.flush();
+        storage.reset();
+        db.close();
+    }
+}
+
+QString TaskRepository::lastError() const
+{
+    return schemaError.isEmpty() ? db.lastError().text() : schemaError;
+}
+
+namespace {
+
+struct TableDefinition {
+    QString name;
+    QString columns;
+};
+
+// Родительские таблицы раньше дочерних
+const QVector<TableDefinition>& tableDefinitions()
+{
+    static const QVector<TableDefinition> tables = {
+        {"Workspaces", "id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL, deleted INTEGER NOT NULL DEFAULT 0"},
+        {"Categories", "id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL, workspace_id INTEGER, "
+                       "deleted INTEGER NOT NULL DEFAULT 0, FOREIGN KEY(workspace_id) REFERENCES Workspaces(id) ON DELETE CASCADE"},
+        {"Tasks", "id INTEGER PRIMARY KEY AUTOINCREMENT, description TEXT NOT NULL, category_id INTEGER, "
+                  "difficulty TEXT, priority TEXT, status TEXT, deadline TEXT, "
+                  "FOREIGN KEY(category_id) REFERENCES Categories(id) ON DELETE CASCADE"},
+        {"TaskTags", "id INTEGER PRIMARY KEY AUTOINCREMENT, task_id INTEGER, tag TEXT, "
+                     "FOREIGN KEY(task_id) REFERENCES Tasks(id) ON DELETE CASCADE"},
+        // История переживает удаление категории
+        {"TaskHistory", "id INTEGER PRIMARY KEY AUTOINCREMENT, description TEXT NOT NULL, category_id INTEGER, "
+                        "difficulty TEXT, priority TEXT, status TEXT, deadline TEXT, completed_at TEXT, "
+                        "FOREIGN KEY(category_id) REFERENCES Categories(id) ON DELETE SET NULL"},
+        {"TaskHistoryTags", "id INTEGER PRIMARY KEY AUTOINCREMENT, history_id INTEGER, tag TEXT, "
+                            "FOREIGN KEY(history_id) REFERENCES TaskHistory(id) ON DELETE CASCADE"}
+    };
+    return tables;
+}
+
+// Индексы по внешним ключам: каскадное удаление и выборка тегов без полного просмотра
+const QStringList schemaIndexes = {
+    "CREATE INDEX IF NOT EXISTS Categories_workspace_id ON Categories(workspace_id);",
+    "CREATE INDEX IF NOT EXISTS Tasks_category_id ON Tasks(category_id);",
+    "CREATE INDEX IF NOT EXISTS TaskTags_task_id ON TaskTags(task_id);",
+    "CREATE INDEX IF NOT EXISTS TaskHistory_category_id ON TaskHistory(category_id);",
+    "CREATE INDEX IF NOT EXISTS TaskHistory_completed_at ON TaskHistory(completed_at);",
+    "CREATE INDEX IF NOT EXISTS TaskHistoryTags_history_id ON TaskHistoryTags(history_id);",
+    // Частичные индексы: помеченных строк единицы, фильтр deleted = 1 не просматривает таблицу
+    "CREATE INDEX IF NOT EXISTS Workspaces_deleted ON Workspaces(id) WHERE deleted = 1;",
+    "CREATE INDEX IF NOT EXISTS Categories_deleted ON Categories(id) WHERE deleted = 1;"
+};
+
+// Столбцы, добавленные после первой версии: table, column, определение, заполнение старых строк
+struct AddedColumn {
+    const char* table;
+    const char* column;
+    const char* definition;
+    const char* fill;
+};
+
+const AddedColumn addedColumns[] = {
+    // Время завершения старых записей неизвестно - считается временем перехода
+    {"TaskHistory", "completed_at", "TEXT", "datetime('now')"},
+    {"Workspaces", "deleted", "INTEGER NOT NULL DEFAULT 0", nullptr},
+    {"Categories", "deleted", "INTEGER NOT NULL DEFAULT 0", nullptr}
+};
+
+} // namespace
+
+// Создание таблиц
+bool TaskRepository::createSchema()
+{
+    QSqlQuery existsQuery("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'Tasks';", db);
+    bool fresh = !existsQuery.next();
+    existsQuery.finish();
+
+    for (const TableDefinition& table : tableDefinitions()) {
+        executeSQL(QString("CREATE TABLE IF NOT EXISTS %1 (%2);").arg(table.name, table.columns));
+    }
+
+    if (fresh) {
+        executeSQL(QString("PRAGMA user_version = %1;").arg(schemaVersion));
+    } else {
+        QSqlQuery versionQuery("PRAGMA user_version;", db);
+        int version = versionQuery.next() ? versionQuery.value(0).toInt() : 0;
+        versionQuery.finish();
+        if (version < schemaVersion && !migrateSchema(version)) {
+            // Индексы по новым столбцам и загрузка модели упали бы на старой схеме
+            executeSQL("PRAGMA foreign_keys = ON;");
+            return false;
+        }
+    }
+
+    for (const QString& sql : schemaIndexes) {
+        executeSQL(sql);
+    }
+    // Миграция выключает внешние ключи на время перестройки таблиц
+    executeSQL("PRAGMA foreign_keys = ON;");
+
+    // Каталог рабочих пр-в в отдельных файлах
+    storage.createSchema();
+    return true;
+}
+
+// Переход со старой схемы: 1 - перенос тегов истории, очистка сирот и перестройка таблиц без ON DELETE;
+// 2 - время завершения в истории; 3 - пометки удаления
+bool TaskRepository::migrateSchema(int version)
+{
+    TRACE_SCOPE("TaskRepository::migrateSchema", "sql");
+    writes.flush();
+
+    // foreign_keys не переключается внутри транзакции
+    executeSQL("PRAGMA foreign_keys = OFF;");
+    if (!db.transaction()) {
+        schemaError = db.lastError().text();
+        qCWarning(lcDb) << "Schema migration failed:" << schemaError;
+        return false;
+    }
+
+    try {
+        // Столбцы добавляются до перестройки таблиц, чтобы порядок столбцов совпал с новым определением
+        for (const AddedColumn& added : addedColumns) {
+            QSqlQuery columnQuery = prepare(QString("SELECT 1 FROM pragma_table_info('%1') WHERE name = :column")
+                                                .arg(added.table));
+            columnQuery.bindValue(":column", added.column);
+            exec(columnQuery);
+            bool hasColumn = columnQuery.next();
+            columnQuery.finish();
+            if (hasColumn) continue;
+
+            run(QString("ALTER TABLE %1 ADD COLUMN %2 %3;").arg(added.table, added.column, added.definition));
+            if (added.fill) {
+                run(QString("UPDATE %1 SET %2 = %3;").arg(added.table, added.column, added.fill));
+            }
+        }
+
+        int historyTags = 0;
+        int orphans = 0;
+        if (version < 1) {
+            // Теги истории лежали в TaskTags под id из TaskHistory; при совпадении id побеждает задача
+            historyTags = run("INSERT INTO TaskHistoryTags (history_id, tag) "
+                              "SELECT task_id, tag FROM TaskTags "
+                              "WHERE task_id NOT IN (SELECT id FROM Tasks) "
+                              "AND task_id IN (SELECT id FROM TaskHistory) ORDER BY id;");
+
+            orphans = run("DELETE FROM Categories WHERE workspace_id IS NULL "
+                          "OR workspace_id NOT IN (SELECT id FROM Workspaces);");
+            orphans += run("DELETE FROM Tasks WHERE category_id IS NULL "
+                           "OR category_id NOT IN (SELECT id FROM Categories);");
+            orphans += run("DELETE FROM TaskTags WHERE task_id IS NULL OR task_id NOT IN (SELECT id FROM Tasks);");
+            run("UPDATE TaskHistory SET category_id = NULL WHERE category_id NOT IN (SELECT id FROM Categories);");
+
+            // Перестройка таблиц, созданных без ON DELETE (id и счетчики AUTOINCREMENT сохраняются)
+            for (const TableDefinition& table : tableDefinitions()) {
+                QSqlQuery sqlQuery = prepare("SELECT sql FROM sqlite_master WHERE type = 'table' AND name = :name");
+                sqlQuery.bindValue(":name", table.name);
+                exec(sqlQuery);
+                bool current = !sqlQuery.next() || sqlQuery.value(0).toString().contains("ON DELETE");
+                sqlQuery.finish();
+                if (current) continue;
+
+                QSqlQuery sequenceQuery = prepare("SELECT seq FROM sqlite_sequence WHERE name = :name");
+                sequenceQuery.bindValue(":name", table.name);
+                exec(sequenceQuery);
+                qint64 sequence = sequenceQuery.next() ? sequenceQuery.value(0).toLongLong() : 0;
+                sequenceQuery.finish();
+
+                run(QString("CREATE TABLE %1_new (%2);").arg(table.name, table.columns));
+                run(QString("INSERT INTO %1_new SELECT * FROM %1;").arg(table.name));
+                run(QString("DROP TABLE %1;").arg(table.name));
+                run(QString("ALTER TABLE %1_new RENAME TO %1;").arg(table.name));
+
+                QSqlQuery restoreSequence = prepare("UPDATE sqlite_sequence SET seq = MAX(seq, :seq) WHERE name = :name");
+                restoreSequence.bindValue(":seq", sequence);
+                restoreSequence.bindValue(":name", table.name);
+                exec(restoreSequence);
+            }
+        }
+
+        QSqlQuery checkQuery("PRAGMA foreign_key_check;", db);
+        if (checkQuery.next()) {
+            throw std::runtime_error(("Foreign key violation in " + checkQuery.value(0).toString()).toStdString());
+        }
+        checkQuery.finish();
+
+        run(QString("PRAGMA user_version = %1;").arg(schemaVersion));
+
+        if (!db.commit()) {
+            throw std::runtime_error(db.lastError().text().toStdString());
+        }
+        qCInfo(lcDb) << "Schema migrated to version" << schemaVersion << "-" << historyTags
+                     << "history tags moved," << orphans << "orphaned rows removed";
+    } catch (const std::exception& e) {
+        db.rollback();
+        schemaError = QString::fromUtf8(e.what());
+        qCWarning(lcDb) << "Schema migration failed:" << e.what();
+        return false;
+    }
+    return true;
+}
+
+// Выполнение sql запроса
+void TaskRepository::executeSQL(const QString& sql)
+{
+    TRACE_SCOPE_DETAIL("sql", "sql", sql);
+    SqlProfileScope profile(sql);
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+    }
+}
+
+QSqlQuery TaskRepository::prepare(const QString& sql)
+{
+    QSqlQuery query(db);
+    if (!query.prepare(sql)) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+    return query;
+}
+
+void TaskRepository::exec(QSqlQuery& query)
+{
+    TRACE_SCOPE_DETAIL("sql", "sql", query.lastQuery());
+    SqlProfileScope profile(query.lastQuery());
+    if (!query.exec()) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+    if (!query.isSelect()) {
+        profile.addRows(query.numRowsAffected());
+    }
+}
+
+int TaskRepository::run(const QString& sql)
+{
+    QSqlQuery query = prepare(sql);
+    exec(query);
+    return query.numRowsAffected();
+}
+
+bool TaskRepository::transaction()
+{
+    return writes.begin();
+}
+
+bool TaskRepository::commit()
+{
+    return writes.commit();
+}
+
+bool TaskRepository::rollback()
+{
+    return writes.rollback();
+}
+
+bool TaskRepository::flush()
+{
+    return writes.flush();
+}
+
+// Загрузка Workspaces из бд
+void TaskRepository::loadWorkspaces(QMap<QString, Workspace*>& workspaces)
+{
+    TRACE_SCOPE("TaskRepository::loadWorkspaces", "model");
+    const QString sql = "SELECT id, name FROM Workspaces WHERE deleted = 0;";
+    SqlProfileScope profile(sql);
+    QSqlQuery query(sql, db);
+    profile.stop();
+    while (query.next()) {
+        profile.addRows();
+        int id = query.value(0).toInt();
+        QString name = query.value(1).toString();
+
+        qCDebugRow(lcDb) << "Loading workspace - ID:" << id << "Name:" << name;
+
+        if (id == 0) {
+            qCWarning(lcModel) << "Warning: Workspace with ID 0 found! This should not happen.";
+            continue;
+        }
+
+        workspaces[name] = new Workspace(id, name);
+    }
+}
+
+// Загрузка Categories из бд
+void TaskRepository::loadCategories(QMap<QString, Workspace*>& workspaces)
+{
+    TRACE_SCOPE("TaskRepository::loadCategories", "model");
+    const QString sql = "SELECT id, name, workspace_id FROM Categories WHERE deleted = 0;";
+    SqlProfileScope profile(sql);
+    QSqlQuery query(sql, db);
+    profile.stop();
+    while (query.next()) {
+        profile.addRows();
+        int id = query.value(0).toInt();
+        QString name = query.value(1).toString();
+        int workspaceId = query.value(2).toInt();
+
+        qCDebugRow(lcDb) << "Loading category - ID:" << id << "Name:" << name
+                         << "Workspace ID:" << workspaceId;
+
+        bool categoryAdded = false;
+        for (auto it = workspaces.begin(); it != workspaces.end(); ++it) {
+            if (it.value()->getId() == workspaceId) {
+                it.value()->addCategory(id, name);
+                categoryAdded = true;
+                qCDebugRow(lcModel) << "Added category to workspace:" << it.key()
+                                    << "with ID:" << id;
+                break;
+            }
+        }
+
+        if (!categoryAdded) {
+            qCWarning(lcModel) << "Category" << name << "with ID" << id
+                               << "has no matching workspace (Workspace ID:" << workspaceId << ")";
+        }
+    }
+}
+
+// Загрузка тасков из бд
+void TaskRepository::loadTasks(QMap<QString, Workspace*>& workspaces)
+{
+    TRACE_SCOPE("TaskRepository::loadTasks", "model");
+    // Задачи помеченных категорий ждут очистки
+    const QString sql = "SELECT id, description, category_id, difficulty, priority, status, deadline FROM Tasks "
+                        "WHERE category_id NOT IN (SELECT id FROM Categories WHERE deleted = 1);";
+    SqlProfileScope profile(sql);
+    QSqlQuery query(sql, db);
+    profile.stop();
+    while (query.next()) {
+        profile.addRows();
+        int id = query.value(0).toInt();
+        QString description = query.value(1).toString();
+        int categoryId = query.value(2).toInt();
+        QString difficulty = query.value(3).toString();
+        QString priority = query.value(4).toString();
+        QString status = query.value(5).toString();
+        QString deadline = query.value(6).toString();
+
+        qCDebugRow(lcDb) << "Loading task ID:" << id << "Description:" << description
+                         << "Category ID:" << categoryId;
+
+        // Теги
+        QStringList tags;
+        QSqlQuery tagQuery(db);
+        tagQuery.prepare("SELECT tag FROM TaskTags WHERE task_id = :task_id");
+        tagQuery.bindValue(":task_id", id);
+
+        SqlProfileScope tagProfile(tagQuery.lastQuery());
+        if (tagQuery.exec()) {
+            while (tagQuery.next()) {
+                tags.append(tagQuery.value(0).toString());
+                tagProfile.addRows();
+            }
+            tagProfile.stop();
+            qCDebugRow(lcDb) << "Tags for task" << id << ":" << tags;
+        } else {
+            qCWarning(lcDb) << "Error loading tags for task" << id << ":" << tagQuery.lastError().text();
+        }
+
+        // Поиск категории
+        bool taskLoaded = false;
+        for (auto workspaceIt = workspaces.begin(); workspaceIt != workspaces.end() && !taskLoaded; ++workspaceIt) {
+            Workspace* workspace = workspaceIt.value();
+            QMap<QString, Category*>& categories = workspace->getCategories();
+
+            for (auto categoryIt = categories.begin(); categoryIt != categories.end() && !taskLoaded; ++categoryIt) {
+                Category* category = categoryIt.value();
+
+                if (category->getId() == categoryId) {
+                    Task* task = new Task(id, description, category->getName(), tags,
+                                          difficulty, priority, status, deadline);
+                    category->addTask(task);
+                    taskLoaded = true;
+
+                    qCDebugRow(lcModel) << "Successfully loaded task into workspace:" << workspace->getName()
+                                        << "category:" << category->getName()
+                                        << "task ID:" << id;
+                }
+            }
+        }
+
+        if (!taskLoaded) {
+            qCWarning(lcModel) << "Failed to load task - category ID" << categoryId << "not found for task ID:" << id;
+        }
+    }
+}
+
+// Загрузка истории из бд
+void TaskRepository::loadTaskHistory(QVector<Task>& taskHistory, bool isEnglish)
+{
+    TRACE_SCOPE("TaskRepository::loadTaskHistory", "model");
+    const QString sql = "SELECT id, description, category_id, difficulty, priority, status, deadline FROM TaskHistory;";
+    SqlProfileScope profile(sql);
+    QSqlQuery query(sql, db);
+    profile.stop();
+    while (query.next()) {
+        profile.addRows();
+        int id = query.value(0).toInt();
+        QString description = query.value(1).toString();
+        QString difficulty = query.value(3).toString();
+        QString priority = query.value(4).toString();
+        QString status = query.value(5).toString();
+        QString deadline = query.value(6).toString();
+
+        // Приведение статуса к текущему языку
+        if (isEnglish && status == "Завершено") {
+            status = "Completed";
+        } else if (!isEnglish && status == "Completed") {
+            status = "Завершено";
+        }
+
+        Task task(id, description, "", QStringList(), difficulty, priority, status, deadline);
+        taskHistory.append(task);
+    }
+}
+
+// Задачи рабочего пр-ва из его файла: два запроса, теги группируются по задаче в памяти
+void TaskRepository::loadWorkspaceTasks(Workspace* workspace)
+{
+    TRACE_SCOPE_DETAIL("TaskRepository::loadWorkspaceTasks", "model", workspace->getName());
+    const QString schema = storage.schemaForWorkspace(workspace->getId());
+
+    QHash<int, Category*> categories;
+    for (Category* category : workspace->getCategories()) {
+        categories.insert(category->getId(), category);
+    }
+
+    QHash<int, QStringList> tags;
+    QSqlQuery tagQuery = prepare(QString("SELECT task_id, tag FROM %1.TaskTags ORDER BY id").arg(schema));
+    tagQuery.setForwardOnly(true);
+    exec(tagQuery);
+    while (tagQuery.next()) {
+        tags[tagQuery.value(0).toInt()].append(tagQuery.value(1).toString());
+    }
+
+    QSqlQuery taskQuery = prepare(
+        QString("SELECT id, description, category_id, difficulty, priority, status, deadline FROM %1.Tasks "
+                "WHERE category_id NOT IN (SELECT id FROM main.Categories WHERE deleted = 1)").arg(schema));
+    taskQuery.setForwardOnly(true);
+    exec(taskQuery);
+
+    int loaded = 0;
+    while (taskQuery.next()) {
+        int id = taskQuery.value(0).toInt();
+        Category* category = categories.value(taskQuery.value(2).toInt());
+        if (!category) {
+            qCWarning(lcModel) << "Failed to load task - category ID" << taskQuery.value(2).toInt()
+                               << "not found for task ID:" << id;
+            continue;
+        }
+        category->addTask(new Task(id, taskQuery.value(1).toString(), category->getName(), tags.take(id),
+                                   taskQuery.value(3).toString(), taskQuery.value(4).toString(),
+                                   taskQuery.value(5).toString(), taskQuery.value(6).toString()));
+        loaded++;
+    }
+    SqlProfiler::addRows(taskQuery.lastQuery(), loaded);
+    qCInfo(lcModel) << "Loaded" << loaded << "tasks of workspace" << workspace->getName() << "from its file";
+}
+
+int TaskRepository::insertWorkspace(const QString& name)
+{
+    QSqlQuery query = prepare("INSERT INTO Workspaces (name) VALUES (:name)");
+    query.bindValue(":name", name);
+    exec(query);
+    int workspaceId = query.lastInsertId().toInt();
+
+    // В режиме отдельных файлов задачи нового пр-ва пишутся в его файл
+    if (storage.isEnabled()) {
+        storage.addWorkspace(workspaceId);
+    }
+    return workspaceId;
+}
+
+// Удаление workspace вместе с категориями, задачами и тегами (ON DELETE CASCADE).
+// Каскад не проходит между файлами: задачи из файла пр-ва удаляются явно, сам файл - после фиксации
+void TaskRepository::deleteWorkspace(int workspaceId)
+{
+    if (storage.isSplitWorkspace(workspaceId)) {
+        run(QString("DELETE FROM %1.Tasks;").arg(storage.schemaForWorkspace(workspaceId)));
+    }
+
+    QSqlQuery query = prepare("DELETE FROM Workspaces WHERE id = :workspace_id");
+    query.bindValue(":workspace_id", workspaceId);
+    exec(query);
+    storage.removeWorkspace(workspaceId);
+}
+
+int TaskRepository::insertCategory(const QString& name, int workspaceId, int categoryId)
+{
+    // NULL в id - следующий по AUTOINCREMENT
+    QSqlQuery query = prepare("INSERT INTO Categories (id, name, workspace_id) VALUES (:id, :name, :workspace_id)");
+    query.bindValue(":id", categoryId ? QVariant(categoryId) : QVariant());
+    query.bindValue(":name", name);
+    query.bindValue(":workspace_id", workspaceId);
+    exec(query);
+    categoryId = query.lastInsertId().toInt();
+    storage.addCategory(categoryId, workspaceId);
+    return categoryId;
+}
+
+// Удаление категории вместе с задачами и тегами (ON DELETE CASCADE, в файле пр-ва - явно)
+void TaskRepository::deleteCategory(int categoryId)
+{
+    if (storage.isSplitCategory(categoryId)) {
+        QSqlQuery tasksQuery = prepare(QString("DELETE FROM %1.Tasks WHERE category_id = :category_id")
+                                           .arg(storage.schemaForCategory(categoryId)));
+        tasksQuery.bindValue(":category_id", categoryId);
+        exec(tasksQuery);
+    }
+
+    QSqlQuery query = prepare("DELETE FROM Categories WHERE id = :category_id");
+    query.bindValue(":category_id", categoryId);
+    exec(query);
+    storage.removeCategory(categoryId);
+}
+
+// Два обновления по индексам - не зависит от числа задач
+void TaskRepository::markWorkspaceDeleted(int workspaceId)
+{
+    QSqlQuery categoriesQuery = prepare("UPDATE Categories SET deleted = 1 WHERE workspace_id = :workspace_id");
+    categoriesQuery.bindValue(":workspace_id", workspaceId);
+    exec(categoriesQuery);
+
+    QSqlQuery query = prepare("UPDATE Workspaces SET deleted = 1 WHERE id = :workspace_id");
+    query.bindValue(":workspace_id", workspaceId);
+    exec(query);
+}
+
+void TaskRepository::markCategoryDeleted(int categoryId)
+{
+    QSqlQuery query = prepare("UPDATE Categories SET deleted = 1 WHERE id = :category_id");
+    query.bindValue(":category_id", categoryId);
+    exec(query);
+}
+
+bool TaskRepository::unmarkCategoryDeleted(int categoryId)
+{
+    QSqlQuery query = prepare("UPDATE Categories SET deleted = 0 WHERE id = :category_id AND deleted = 1");
+    query.bindValue(":category_id", categoryId);
+    exec(query);
+    return query.numRowsAffected() == 1;
+}
+
+QSet<int> TaskRepository::categoryTaskIds(int categoryId)
+{
+    QSqlQuery query = prepare(QString("SELECT id FROM %1.Tasks WHERE category_id = :category_id")
+                                  .arg(storage.schemaForCategory(categoryId)));
+    query.bindValue(":category_id", categoryId);
+    exec(query);
+
+    QSet<int> ids;
+    while (query.next()) {
+        ids.insert(query.value(0).toInt());
+    }
+    SqlProfiler::addRows(query.lastQuery(), ids.size());
+    return ids;
+}
+
+qint64 TaskRepository::tombstonedTaskCount()
+{
+    QSqlQuery categoriesQuery = prepare("SELECT id FROM Categories WHERE deleted = 1");
+    exec(categoriesQuery);
+    QVector<int> categoryIds;
+    while (categoriesQuery.next()) {
+        categoryIds.append(categoriesQuery.value(0).toInt());
+    }
+    categoriesQuery.finish();
+
+    // Категории пр-в с файлами считаются в своей схеме
+    qint64 count = 0;
+    for (int categoryId : categoryIds) {
+        QSqlQuery countQuery = prepare(QString("SELECT count(*) FROM %1.Tasks WHERE category_id = :category_id")
+                                           .arg(storage.schemaForCategory(categoryId)));
+        countQuery.bindValue(":category_id", categoryId);
+        exec(countQuery);
+        if (countQuery.next()) count += countQuery.value(0).toLongLong();
+    }
+    return count;
+}
+
+// Сначала задачи (порциями), затем опустевшая категория, после всех категорий - пр-ва.
+// Теги удаляются каскадно вместе с задачами
+bool TaskRepository::purgeTombstones(int limit, int* tasksRemoved)
+{
+    *tasksRemoved = 0;
+
+    QSqlQuery categoryQuery = prepare("SELECT id FROM Categories WHERE deleted = 1 LIMIT 1");
+    exec(categoryQuery);
+    if (categoryQuery.next()) {
+        const int categoryId = categoryQuery.value(0).toInt();
+        categoryQuery.finish();
+
+        const QString schema = storage.schemaForCategory(categoryId);
+        QSqlQuery idsQuery = prepare(QString("SELECT id FROM %1.Tasks WHERE category_id = :category_id LIMIT :limit")
+                                         .arg(schema));
+        idsQuery.bindValue(":category_id", categoryId);
+        idsQuery.bindValue(":limit", limit);
+        exec(idsQuery);
+        QStringList ids;
+        while (idsQuery.next()) {
+            ids.append(idsQuery.value(0).toString());
+        }
+        idsQuery.finish();
+
+        if (ids.isEmpty()) {
+            deleteCategory(categoryId);
+        } else {
+            *tasksRemoved = run(QString("DELETE FROM %1.Tasks WHERE id IN (%2);").arg(schema, ids.join(',')));
+        }
+        return true;
+    }
+    categoryQuery.finish();
+
+    QSqlQuery workspaceQuery = prepare("SELECT id FROM Workspaces WHERE deleted = 1 LIMIT 1");
+    exec(workspaceQuery);
+    if (workspaceQuery.next()) {
+        const int workspaceId = workspaceQuery.value(0).toInt();
+        workspaceQuery.finish();
+        deleteWorkspace(workspaceId);
+        return true;
+    }
+    return false;
+}
+
+// Вставка задачи и ее тегов
+int TaskRepository::insertTask(const QString& description, int categoryId, const QStringList& tags,
+                               const QString& difficulty, const QString& priority,
+                               const QString& status, const QString& deadline, int taskId)
+{
+    const QString schema = storage.schemaForCategory(categoryId);
+    QSqlQuery taskQuery = prepare(QString(
+        "INSERT INTO %1.Tasks (id, description, category_id, difficulty, priority, status, deadline) "
+        "VALUES (:id, :description, :category_id, :difficulty, :priority, :status, :deadline)"
+        ).arg(schema));
+    taskQuery.bindValue(":id", taskId ? QVariant(taskId) : QVariant());
+    taskQuery.bindValue(":description", description);
+    taskQuery.bindValue(":category_id", categoryId);
+    taskQuery.bindValue(":difficulty", difficulty);
+    taskQuery.bindValue(":priority", priority);
+    taskQuery.bindValue(":status", status);
+    taskQuery.bindValue(":deadline", deadline);
+    exec(taskQuery);
+
+    taskId = taskQuery.lastInsertId().toInt();
+
+    QSqlQuery tagQuery = prepare(QString("INSERT INTO %1.TaskTags (task_id, tag) VALUES (:task_id, :tag)").arg(schema));
+    for (const QString& tag : tags) {
+        tagQuery.bindValue(":task_id", taskId);
+        tagQuery.bindValue(":tag", tag);
+        exec(tagQuery);
+    }
+
+    return taskId;
+}
+
+// Теги удаляются каскадно
+int TaskRepository::deleteTask(int taskId)
+{
+    QSqlQuery deleteTaskQuery = prepare(QString("DELETE FROM %1.Tasks WHERE id = :task_id")
+                                            .arg(storage.schemaForTask(taskId)));
+    deleteTaskQuery.bindValue(":task_id", taskId);
+    exec(deleteTaskQuery);
+    return deleteTaskQuery.numRowsAffected();
+}
+
+int TaskRepository::updateTaskStatus(int taskId, const QString& status)
+{
+    QSqlQuery query = prepare(QString("UPDATE %1.Tasks SET status = :status WHERE id = :task_id")
+                                  .arg(storage.schemaForTask(taskId)));
+    query.bindValue(":status", status);
+    query.bindValue(":task_id", taskId);
+    exec(query);
+    return query.numRowsAffected();
+}
+
+QStringList TaskRepository::taskTags(int taskId)
+{
+    QSqlQuery query = prepare(QString("SELECT tag FROM %1.TaskTags WHERE task_id = :task_id")
+                                  .arg(storage.schemaForTask(taskId)));
+    query.bindValue(":task_id", taskId);
+    exec(query);
+
+    QStringList tags;
+    while (query.next()) {
+        tags.append(query.value(0).toString());
+    }
+    SqlProfiler::addRows(query.lastQuery(), tags.size());
+    return tags;
+}
+
+// Перенос завершенной задачи в историю (возвращает id в истории).
+// Число запросов не зависит от числа тегов: строки копируются через INSERT ... SELECT
+int TaskRepository::moveTaskToHistory(const Task& task, int categoryId, const QString& status, QStringList* tags)
+{
+    if (tags) *tags = taskTags(task.getId());
+
+    const QString schema = storage.schemaForTask(task.getId());
+    QSqlQuery insertHistoryQuery = prepare(QString(
+        "INSERT INTO TaskHistory (description, category_id, difficulty, priority, status, deadline, completed_at) "
+        "SELECT description, :category_id, difficulty, priority, :status, deadline, datetime('now') "
+        "FROM %1.Tasks WHERE id = :task_id"
+        ).arg(schema));
+    insertHistoryQuery.bindValue(":category_id", categoryId);
+    insertHistoryQuery.bindValue(":status", status);
+    insertHistoryQuery.bindValue(":task_id", task.getId());
+    exec(insertHistoryQuery);
+    if (insertHistoryQuery.numRowsAffected() != 1) {
+        throw std::runtime_error(QString("Task %1 not found").arg(task.getId()).toStdString());
+    }
+
+    int historyId = insertHistoryQuery.lastInsertId().toInt();
+    qCDebug(lcDb) << "Task moved to history with ID:" << historyId;
+
+    // Копирование всех тегов задачи в историю
+    QSqlQuery copyTagsQuery = prepare(QString(
+        "INSERT INTO TaskHistoryTags (history_id, tag) "
+        "SELECT :history_id, tag FROM %1.TaskTags WHERE task_id = :task_id ORDER BY id"
+        ).arg(schema));
+    copyTagsQuery.bindValue(":history_id", historyId);
+    copyTagsQuery.bindValue(":task_id", task.getId());
+    exec(copyTagsQuery);
+
+    // Удаление задачи из активных
+    deleteTask(task.getId());
+
+    return historyId;
+}
+
+// Нахождение задачи в истории по описанию
+bool TaskRepository::findHistoryTask(const QString& description, HistoryRecord* record)
+{
+    QSqlQuery query = prepare("SELECT id, description, difficulty, priority, status, deadline FROM TaskHistory WHERE description = :description");
+    query.bindValue(":description", description);
+    exec(query);
+
+    if (!query.next()) return false;
+    SqlProfiler::addRows(query.lastQuery(), 1);
+
+    record->id = query.value(0).toInt();
+    record->description = query.value(1).toString();
+    record->difficulty = query.value(2).toString();
+    record->priority = query.value(3).toString();
+    record->status = query.value(4).toString();
+    record->deadline = query.value(5).toString();
+    return true;
+}
+
+// Возвращение задачи из истории (возвращает новый id задачи), тоже через INSERT ... SELECT
+int TaskRepository::restoreTaskFromHistory(const HistoryRecord& record, int categoryId, QStringList* tags)
+{
+    if (tags) *tags = historyTaskTags(record.id);
+
+    const QString schema = storage.schemaForCategory(categoryId);
+    QSqlQuery insertTaskQuery = prepare(QString(
+        "INSERT INTO %1.Tasks (description, category_id, difficulty, priority, status, deadline) "
+        "SELECT description, :category_id, difficulty, priority, status, deadline FROM TaskHistory WHERE id = :history_id"
+        ).arg(schema));
+    insertTaskQuery.bindValue(":category_id", categoryId);
+    insertTaskQuery.bindValue(":history_id", record.id);
+    exec(insertTaskQuery);
+    if (insertTaskQuery.numRowsAffected() != 1) {
+        throw std::runtime_error(QString("History task %1 not found").arg(record.id).toStdString());
+    }
+
+    int newTaskId = insertTaskQuery.lastInsertId().toInt();
+    qCDebug(lcDb) << "New task ID after restore:" << newTaskId;
+
+    QSqlQuery copyTagsQuery = prepare(QString(
+        "INSERT INTO %1.TaskTags (task_id, tag) "
+        "SELECT :task_id, tag FROM TaskHistoryTags WHERE history_id = :history_id ORDER BY id"
+        ).arg(schema));
+    copyTagsQuery.bindValue(":task_id", newTaskId);
+    copyTagsQuery.bindValue(":history_id", record.id);
+    exec(copyTagsQuery);
+
+    deleteHistoryTask(record.id);
+
+    return newTaskId;
+}
+
+// Теги истории удаляются каскадно
+int TaskRepository::deleteHistoryTask(int historyId)
+{
+    QSqlQuery deleteHistoryQuery = prepare("DELETE FROM TaskHistory WHERE id = :history_id");
+    deleteHistoryQuery.bindValue(":history_id", historyId);
+    exec(deleteHistoryQuery);
+    return deleteHistoryQuery.numRowsAffected();
+}
+
+QStringList TaskRepository::historyTaskTags(int historyId)
+{
+    QSqlQuery query = prepare("SELECT tag FROM TaskHistoryTags WHERE history_id = :history_id ORDER BY id");
+    query.bindValue(":history_id", historyId);
+    exec(query);
+
+    QStringList tags;
+    while (query.next()) {
+        tags.append(query.value(0).toString());
+    }
+    SqlProfiler::addRows(query.lastQuery(), tags.size());
+    return tags;
+}
@@ -0,0 +1,118 @@
+#ifndef TASKREPOSITORY_H
+#define TASKREPOSITORY_H
+
+#include <QMap>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "taskmodel.h"
+#include "workspacestorage.h"
+#include "writecoordinator.h"
+
+// Запись истории (как она лежит в TaskHistory)
+struct HistoryRecord {
+    int id = 0;
+    QString description;
+    QString difficulty;
+    QString priority;
+    QString status;
+    QString deadline;
+};
+
+// Хранение модели в SQLite.
+// Методы изменения бросают std::runtime_error; транзакциями управляет вызывающий код
+class TaskRepository {
+public:
+    explicit TaskRepository(const QString& connectionName = QLatin1String(QSqlDatabase::defaultConnection));
+    ~TaskRepository();
+
+    // Открытие включает foreign_keys для соединения
+    bool open(const QString& path);
+    void close();
+    QString lastError() const;
+    QSqlDatabase database() const { return db; }
+
+    // Версия схемы (PRAGMA user_version): 1 - ON DELETE CASCADE и TaskHistoryTags,
+    // 2 - TaskHistory.completed_at, 3 - пометки удаления (deleted) у рабочих пр-в и категорий
+    static constexpr int schemaVersion = 3;
+
+    // Создание таблиц и переход со старой схемы; false - миграция не удалась (причина в lastError()),
+    // работать с бд в старой схеме нельзя
+    bool createSchema();
+    void executeSQL(const QString& sql);
+
+    // Загрузка модели
+    void loadWorkspaces(QMap<QString, Workspace*>& workspaces);
+    void loadCategories(QMap<QString, Workspace*>& workspaces);
+    void loadTasks(QMap<QString, Workspace*>& workspaces);
+    void loadTaskHistory(QVector<Task>& taskHistory, bool isEnglish);
+    // Задачи рабочего пр-ва из его файла (основная загрузка их не читает)
+    void loadWorkspaceTasks(Workspace* workspace);
+
+    // Транзакции (одно изменение; фиксация группируется WriteCoordinator)
+    bool transaction();
+    bool commit();
+    bool rollback();
+    // Немедленная запись накопленных изменений
+    bool flush();
+    WriteCoordinator& writeCoordinator() { return writes; }
+    // Рабочие пр-ва в отдельных файлах (запросы к задачам направляются в их схему)
+    WorkspaceStorage& workspaceStorage() { return storage; }
+
+    // Рабочие пр-ва и категории
+    int insertWorkspace(const QString& name);
+    void deleteWorkspace(int workspaceId);
+    // categoryId/taskId != 0 - вставка с прежним id (отмена удаления)
+    int insertCategory(const QString& name, int workspaceId, int categoryId = 0);
+    void deleteCategory(int categoryId);
+
+    // Пометки удаления: строки скрываются из всех запросов сразу, а удаляются порциями
+    // (purgeTombstones, см. TombstonePurger). Пр-во помечается вместе со своими категориями
+    void markWorkspaceDeleted(int workspaceId);
+    void markCategoryDeleted(int categoryId);
+    // Снятие пометки с категории (отмена удаления); false - категория уже вычищена
+    bool unmarkCategoryDeleted(int categoryId);
+    // Id оставшихся задач категории
+    QSet<int> categoryTaskIds(int categoryId);
+    // Число задач в помеченных категориях
+    qint64 tombstonedTaskCount();
+    // Шаг очистки: до limit задач одной помеченной категории, пустая категория или помеченное пр-во.
+    // Возвращает false, если вычищать нечего; tasksRemoved - число удаленных задач
+    bool purgeTombstones(int limit, int* tasksRemoved);
+
+    // Задачи
+    int insertTask(const QString& description, int categoryId, const QStringList& tags,
+                   const QString& difficulty, const QString& priority,
+                   const QString& status, const QString& deadline, int taskId = 0);
+    // Число затронутых строк (0 - задачи уже нет)
+    int deleteTask(int taskId);
+    int updateTaskStatus(int taskId, const QString& status);
+    QStringList taskTags(int taskId);
+
+    // История
+    int moveTaskToHistory(const Task& task, int categoryId, const QString& status, QStringList* tags);
+    bool findHistoryTask(const QString& description, HistoryRecord* record);
+    int restoreTaskFromHistory(const HistoryRecord& record, int categoryId, QStringList* tags);
+    int deleteHistoryTask(int historyId);
+    QStringList historyTaskTags(int historyId);
+
+private:
+    bool migrateSchema(int version);
+
+    QSqlQuery prepare(const QString& sql);
+    static void exec(QSqlQuery& query);
+    // Выполнение без параметров, возвращает число измененных строк
+    int run(const QString& sql);
+
+    QString connection;
+    QString schemaError;
+    QSqlDatabase db;
+    WriteCoordinator writes{db};
+    WorkspaceStorage storage{db, writes};
+};
+
+#endif // TASKREPOSITORY_H
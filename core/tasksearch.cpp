@@ -0,0 +1,287 @@
+#include "tasksearch.h"
+#include "workspacestorage.h"
+#include "tracer.h"
+#include "sqlprofiler.h"
+#include "applog.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringList>
+#include <QRegularExpression>
+#include <QVariant>
+#include <stdexcept>
+
+bool TaskSearchIndex::createSchema(const QSqlDatabase& database)
+{
+    db = database;
+    QSqlQuery query(db);
+
+    bool exists = query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'TaskSearch';") && query.next();
+    // Триггеров на теги истории не было в первой версии индекса
+    bool historyTagsIndexed = query.exec("SELECT 1 FROM sqlite_master WHERE type = 'trigger' "
+                                         "AND name = 'TaskSearch_history_tags_ai';") && query.next();
+
+    if (!query.exec("CREATE VIRTUAL TABLE IF NOT EXISTS TaskSearch USING fts5("
+                    "description, tags, tokenize = 'unicode61 remove_diacritics 2', prefix = '2 3');")) {
+        qCInfo(lcSearch) << "FTS5 is not available, falling back to LIKE search:" << query.lastError().text();
+        available = false;
+        return false;
+    }
+
+    const QStringList triggers = {
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_tasks_ai AFTER INSERT ON Tasks BEGIN "
+        "INSERT INTO TaskSearch (rowid, description, tags) VALUES (NEW.id * 2, NEW.description, ''); END;",
+
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_tasks_au AFTER UPDATE OF description ON Tasks BEGIN "
+        "UPDATE TaskSearch SET description = NEW.description WHERE rowid = NEW.id * 2; END;",
+
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_tasks_ad AFTER DELETE ON Tasks BEGIN "
+        "DELETE FROM TaskSearch WHERE rowid = OLD.id * 2; END;",
+
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_history_ai AFTER INSERT ON TaskHistory BEGIN "
+        "INSERT INTO TaskSearch (rowid, description, tags) VALUES (NEW.id * 2 + 1, NEW.description, ''); END;",
+
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_history_ad AFTER DELETE ON TaskHistory BEGIN "
+        "DELETE FROM TaskSearch WHERE rowid = OLD.id * 2 + 1; END;",
+
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_tags_ai AFTER INSERT ON TaskTags BEGIN "
+        "UPDATE TaskSearch SET tags = (SELECT group_concat(tag, ' ') FROM TaskTags WHERE task_id = NEW.task_id) "
+        "WHERE rowid = NEW.task_id * 2; END;",
+
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_tags_ad AFTER DELETE ON TaskTags BEGIN "
+        "UPDATE TaskSearch SET tags = COALESCE((SELECT group_concat(tag, ' ') FROM TaskTags WHERE task_id = OLD.task_id), '') "
+        "WHERE rowid = OLD.task_id * 2; END;",
+
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_history_tags_ai AFTER INSERT ON TaskHistoryTags BEGIN "
+        "UPDATE TaskSearch SET tags = (SELECT group_concat(tag, ' ') FROM TaskHistoryTags WHERE history_id = NEW.history_id) "
+        "WHERE rowid = NEW.history_id * 2 + 1; END;",
+
+        "CREATE TRIGGER IF NOT EXISTS TaskSearch_history_tags_ad AFTER DELETE ON TaskHistoryTags BEGIN "
+        "UPDATE TaskSearch SET tags = COALESCE((SELECT group_concat(tag, ' ') FROM TaskHistoryTags "
+        "WHERE history_id = OLD.history_id), '') WHERE rowid = OLD.history_id * 2 + 1; END;"
+    };
+
+    for (const QString& sql : triggers) {
+        if (!query.exec(sql)) {
+            qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+            available = false;
+            return false;
+        }
+    }
+
+    // Первичное заполнение для существующей бд
+    if (!exists) {
+        query.exec("INSERT INTO TaskSearch (rowid, description, tags) "
+                   "SELECT id * 2, description, "
+                   "COALESCE((SELECT group_concat(tag, ' ') FROM TaskTags WHERE task_id = Tasks.id), '') FROM Tasks;");
+        query.exec("INSERT INTO TaskSearch (rowid, description, tags) "
+                   "SELECT id * 2 + 1, description, COALESCE((SELECT group_concat(tag, ' ') FROM TaskHistoryTags "
+                   "WHERE history_id = TaskHistory.id), '') FROM TaskHistory;");
+        qCInfo(lcSearch) << "Full-text index built";
+    } else if (!historyTagsIndexed) {
+        // Индекс построен без тегов истории - однократное дозаполнение
+        query.exec("UPDATE TaskSearch SET tags = (SELECT group_concat(tag, ' ') FROM TaskHistoryTags "
+                   "WHERE history_id = TaskSearch.rowid / 2) "
+                   "WHERE rowid % 2 = 1 AND rowid / 2 IN (SELECT history_id FROM TaskHistoryTags);");
+        qCInfo(lcSearch) << "History tags added to the full-text index:" << query.numRowsAffected();
+    }
+
+    available = true;
+    return true;
+}
+
+// Триггеры на таблицы другой схемы могут быть только временными (TEMP); при повторном
+// подключении файла старые триггеры уже не срабатывают, поэтому пересоздаются
+void TaskSearchIndex::attachSchema(const QString& schema)
+{
+    if (!available) return;
+
+    const QStringList triggers = {
+        "CREATE TEMP TRIGGER TaskSearch_%1_tasks_ai AFTER INSERT ON %1.Tasks BEGIN "
+        "INSERT INTO TaskSearch (rowid, description, tags) VALUES (NEW.id * 2, NEW.description, ''); END;",
+
+        "CREATE TEMP TRIGGER TaskSearch_%1_tasks_au AFTER UPDATE OF description ON %1.Tasks BEGIN "
+        "UPDATE TaskSearch SET description = NEW.description WHERE rowid = NEW.id * 2; END;",
+
+        "CREATE TEMP TRIGGER TaskSearch_%1_tasks_ad AFTER DELETE ON %1.Tasks BEGIN "
+        "DELETE FROM TaskSearch WHERE rowid = OLD.id * 2; END;",
+
+        "CREATE TEMP TRIGGER TaskSearch_%1_tags_ai AFTER INSERT ON %1.TaskTags BEGIN "
+        "UPDATE TaskSearch SET tags = (SELECT group_concat(tag, ' ') FROM %1.TaskTags WHERE task_id = NEW.task_id) "
+        "WHERE rowid = NEW.task_id * 2; END;",
+
+        "CREATE TEMP TRIGGER TaskSearch_%1_tags_ad AFTER DELETE ON %1.TaskTags BEGIN "
+        "UPDATE TaskSearch SET tags = COALESCE((SELECT group_concat(tag, ' ') FROM %1.TaskTags WHERE task_id = OLD.task_id), '') "
+        "WHERE rowid = OLD.task_id * 2; END;"
+    };
+
+    QSqlQuery query(db);
+    for (const QString& trigger : triggers) {
+        const QString sql = trigger.arg(schema);
+        const QString name = sql.section(' ', 3, 3);
+        if (!query.exec("DROP TRIGGER IF EXISTS temp." + name + ";") || !query.exec(sql)) {
+            qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+        }
+    }
+}
+
+// "отчет  по" -> "отчет"* "по"*
+QString TaskSearchIndex::buildMatchQuery(const QString& text)
+{
+    static const QRegularExpression separators("[\\s\"]+");
+
+    QStringList terms;
+    for (const QString& word : text.split(separators, Qt::SkipEmptyParts)) {
+        terms.append("\"" + word + "\"*");
+    }
+    return terms.join(' ');
+}
+
+// Поиск с ранжированием bm25 (описание весит больше тегов)
+QVector<TaskSearchHit> TaskSearchIndex::search(const QString& text, int limit) const
+{
+    TRACE_SCOPE_DETAIL("TaskSearchIndex::search", "search", text);
+    if (!available) return searchLike(text, limit);
+
+    QVector<TaskSearchHit> hits;
+    QString match = buildMatchQuery(text);
+    if (match.isEmpty()) return hits;
+
+    QSqlQuery query(db);
+    query.prepare(
+        "SELECT TaskSearch.rowid, TaskSearch.description, w.name, c.name, bm25(TaskSearch, 10.0, 5.0) AS score, "
+        "f.workspace_id "
+        "FROM TaskSearch "
+        "LEFT JOIN Tasks t ON TaskSearch.rowid % 2 = 0 AND t.id = TaskSearch.rowid / 2 "
+        "LEFT JOIN TaskHistory h ON TaskSearch.rowid % 2 = 1 AND h.id = TaskSearch.rowid / 2 "
+        "LEFT JOIN Categories c ON c.id = COALESCE(t.category_id, h.category_id) "
+        // Задачи из файлов рабочих пр-в: пр-во по диапазону id, категория - в resolveSplitCategory()
+        "LEFT JOIN WorkspaceFiles f ON t.id IS NULL AND TaskSearch.rowid % 2 = 0 AND TaskSearch.rowid / 2 >= :first_split "
+        "AND f.slot = (TaskSearch.rowid / 2 - :first_split2) >> :slot_bits "
+        "LEFT JOIN Workspaces w ON w.id = COALESCE(c.workspace_id, f.workspace_id) "
+        "WHERE TaskSearch MATCH :match "
+        // Задачи помеченных на удаление категорий и пр-в (ждут очистки)
+        "AND (TaskSearch.rowid % 2 = 1 OR (COALESCE(c.deleted, 0) = 0 AND COALESCE(w.deleted, 0) = 0)) "
+        "ORDER BY score LIMIT :limit"
+        );
+    query.bindValue(":first_split", WorkspaceStorage::firstSplitId);
+    query.bindValue(":first_split2", WorkspaceStorage::firstSplitId);
+    query.bindValue(":slot_bits", WorkspaceStorage::slotBits);
+    query.bindValue(":match", match);
+    query.bindValue(":limit", limit);
+
+    SqlProfileScope profile(query.lastQuery());
+    if (!query.exec()) {
+        qCWarning(lcSearch) << "Search error:" << query.lastError().text();
+        return hits;
+    }
+
+    QVector<int> split;
+    while (query.next()) {
+        qint64 rowId = query.value(0).toLongLong();
+
+        TaskSearchHit hit;
+        hit.id = int(rowId / 2);
+        hit.inHistory = rowId % 2 == 1;
+        hit.description = query.value(1).toString();
+        hit.workspace = query.value(2).toString();
+        hit.category = query.value(3).toString();
+        hit.score = query.value(4).toDouble();
+        if (!query.value(5).isNull()) split.append(hits.size());
+        hits.append(hit);
+        profile.addRows();
+    }
+    query.finish();
+
+    // Подключение файла не должно идти при открытом курсоре - категории после чтения
+    for (int i = split.size() - 1; i >= 0; --i) {
+        if (!resolveSplitCategory(hits[split[i]])) hits.remove(split[i]);
+    }
+    return hits;
+}
+
+// Категория задачи из файла пр-ва; false - задача в помеченной на удаление категории или уже удалена
+bool TaskSearchIndex::resolveSplitCategory(TaskSearchHit& hit) const
+{
+    if (!storage) return true;
+
+    QSqlQuery query(db);
+    try {
+        query.prepare(QString("SELECT c.name, c.deleted FROM %1.Tasks t JOIN main.Categories c ON c.id = t.category_id "
+                              "WHERE t.id = :task_id").arg(storage->schemaForTask(hit.id)));
+    } catch (const std::exception& e) {
+        qCWarning(lcSearch) << "Can't open workspace file of task" << hit.id << ":" << e.what();
+        return true;
+    }
+    query.bindValue(":task_id", hit.id);
+    if (!query.exec()) {
+        qCWarning(lcSearch) << "Search error:" << query.lastError().text();
+        return true;
+    }
+    if (!query.next() || query.value(1).toInt() != 0) return false;
+    hit.category = query.value(0).toString();
+    return true;
+}
+
+// Запасной вариант без FTS5
+QVector<TaskSearchHit> TaskSearchIndex::searchLike(const QString& text, int limit) const
+{
+    QVector<TaskSearchHit> hits;
+    if (text.trimmed().isEmpty()) return hits;
+
+    // Задачи из файлов рабочих пр-в - отдельные части объединения (файлы подключаются)
+    QStringList schemas = {"main"};
+    if (storage) {
+        QSqlQuery files(db);
+        files.exec("SELECT workspace_id FROM WorkspaceFiles;");
+        QVector<int> workspaceIds;
+        while (files.next()) workspaceIds.append(files.value(0).toInt());
+        files.finish();
+        for (int workspaceId : workspaceIds) {
+            try {
+                schemas.append(storage->schemaForWorkspace(workspaceId));
+            } catch (const std::exception& e) {
+                qCWarning(lcSearch) << "Can't open workspace file" << workspaceId << ":" << e.what();
+            }
+        }
+    }
+
+    QString tasks;
+    for (int i = 0; i < schemas.size(); ++i) {
+        tasks += QString("SELECT id, 0 AS history, description, category_id FROM %1.Tasks "
+                         "WHERE description LIKE :pattern%2 UNION ALL ").arg(schemas[i]).arg(i);
+    }
+
+    QSqlQuery query(db);
+    query.prepare(
+        "SELECT x.id, x.history, x.description, w.name, c.name FROM (" + tasks +
+        "SELECT id, 1 AS history, description, category_id FROM TaskHistory WHERE description LIKE :history_pattern"
+        ") x "
+        "LEFT JOIN main.Categories c ON c.id = x.category_id "
+        "LEFT JOIN main.Workspaces w ON w.id = c.workspace_id "
+        "WHERE x.history = 1 OR (COALESCE(c.deleted, 0) = 0 AND COALESCE(w.deleted, 0) = 0) "
+        "LIMIT :limit"
+        );
+    for (int i = 0; i < schemas.size(); ++i) {
+        query.bindValue(QString(":pattern%1").arg(i), "%" + text.trimmed() + "%");
+    }
+    query.bindValue(":history_pattern", "%" + text.trimmed() + "%");
+    query.bindValue(":limit", limit);
+
+    SqlProfileScope profile(query.lastQuery());
+    if (!query.exec()) {
+        qCWarning(lcSearch) << "Search error:" << query.lastError().text();
+        return hits;
+    }
+
+    while (query.next()) {
+        TaskSearchHit hit;
+        hit.id = query.value(0).toInt();
+        hit.inHistory = query.value(1).toInt() == 1;
+        hit.description = query.value(2).toString();
+        hit.workspace = query.value(3).toString();
+        hit.category = query.value(4).toString();
+        hits.append(hit);
+        profile.addRows();
+    }
+    return hits;
+}
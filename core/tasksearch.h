@@ -0,0 +1,45 @@
+#ifndef TASKSEARCH_H
+#define TASKSEARCH_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+class WorkspaceStorage;
+
+struct TaskSearchHit {
+    int id = 0;
+    bool inHistory = false;
+    QString description;
+    QString workspace;
+    QString category;
+    double score = 0.0;
+};
+
+// Полнотекстовый поиск по описаниям задач, истории и тегам (SQLite FTS5).
+// Таблица TaskSearch синхронизируется триггерами, rowid = id * 2 для Tasks и id * 2 + 1 для TaskHistory
+class TaskSearchIndex {
+public:
+    // Создание таблицы/триггеров и первичное заполнение
+    bool createSchema(const QSqlDatabase& database);
+    bool isAvailable() const { return available; }
+    // Временные триггеры на задачи подключенного файла рабочего пр-ва (schema - имя в ATTACH)
+    void attachSchema(const QString& schema);
+    // Категории задач из файлов рабочих пр-в (без нее такие задачи не проверяются на пометку удаления)
+    void setWorkspaceStorage(WorkspaceStorage* workspaceStorage) { storage = workspaceStorage; }
+
+    QVector<TaskSearchHit> search(const QString& text, int limit = 50) const;
+
+    // Преобразование ввода пользователя в запрос FTS5 (все слова, по префиксу)
+    static QString buildMatchQuery(const QString& text);
+
+private:
+    QVector<TaskSearchHit> searchLike(const QString& text, int limit) const;
+    bool resolveSplitCategory(TaskSearchHit& hit) const;
+
+    QSqlDatabase db;
+    WorkspaceStorage* storage = nullptr;
+    bool available = false;
+};
+
+#endif // TASKSEARCH_H
@@ -0,0 +1,96 @@
+#include "tombstonepurger.h"
+#include "taskrepository.h"
+#include "applog.h"
+#include "tracer.h"
+#include <stdexcept>
+
+TombstonePurger::TombstonePurger(TaskRepository& repository, QObject* parent)
+    : QObject(parent), repository(repository)
+{
+    connect(&timer, &QTimer::timeout, this, &TombstonePurger::step);
+}
+
+void TombstonePurger::setBatchSize(int rows)
+{
+    batch = qMax(1, rows);
+}
+
+void TombstonePurger::setInterval(int ms)
+{
+    intervalMs = qMax(0, ms);
+    if (timer.isActive()) timer.start(intervalMs);
+}
+
+void TombstonePurger::configureFromEnvironment()
+{
+    bool ok = false;
+    int rows = qEnvironmentVariableIntValue("TASK_MANAGER_PURGE_BATCH", &ok);
+    if (ok) setBatchSize(rows);
+
+    int ms = qEnvironmentVariableIntValue("TASK_MANAGER_PURGE_INTERVAL_MS", &ok);
+    if (ok) setInterval(ms);
+}
+
+void TombstonePurger::start()
+{
+    // Оценка объема для прогресса; новые пометки добавляются к идущей очистке
+    qint64 remaining = 0;
+    try {
+        remaining = repository.tombstonedTaskCount();
+    } catch (const std::exception& e) {
+        qCWarning(lcDb) << "Error counting deleted rows:" << e.what();
+    }
+
+    if (!timer.isActive()) purged = 0;
+    total = purged + remaining;
+    if (remaining > 0) emit progress(purged, remaining);
+    timer.start(intervalMs);
+}
+
+void TombstonePurger::stop()
+{
+    timer.stop();
+}
+
+void TombstonePurger::step()
+{
+    TRACE_SCOPE("TombstonePurger::step", "sql");
+    int removed = 0;
+    bool more = false;
+
+    try {
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+        more = repository.purgeTombstones(batch, &removed);
+        // Шаг фиксируется сразу, без окна группировки: иначе при шагах раз в intervalMs
+        // транзакция записи была бы открыта почти все время очистки и блокировала другие процессы
+        if (!repository.commit() || !repository.flush()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+    } catch (const std::exception& e) {
+        // Пометки остаются - очистка повторится при следующем запуске
+        repository.rollback();
+        qCWarning(lcDb) << "Error purging deleted rows:" << e.what();
+        finish();
+        return;
+    }
+
+    // Последняя порция тоже считается
+    purged += removed;
+    if (!more) {
+        if (purged > 0) qCInfo(lcDb) << "Purged" << purged << "tasks of deleted workspaces and categories";
+        finish();
+        return;
+    }
+
+    if (removed > 0) emit progress(purged, qMax<qint64>(0, total - purged));
+}
+
+void TombstonePurger::finish()
+{
+    timer.stop();
+    purged = 0;
+    total = 0;
+    emit finished();
+}
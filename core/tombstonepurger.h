@@ -0,0 +1,51 @@
+#ifndef TOMBSTONEPURGER_H
+#define TOMBSTONEPURGER_H
+
+#include <QObject>
+#include <QTimer>
+
+class TaskRepository;
+
+// Фоновая очистка удаленных рабочих пр-в и категорий. Удаление только помечает строки
+// (deleted = 1) и мгновенно скрывает их из запросов, а строки удаляются здесь порциями по
+// batchSize задач - по шагу таймера между событиями интерфейса. Пометки лежат в бд, поэтому
+// очистка, прерванная выходом или сбоем, продолжается при следующем запуске.
+// Шаги идут через соединение репозитория: к нему подключены файлы рабочих пр-в и временные
+// триггеры поиска, а писатель в SQLite все равно один
+class TombstonePurger : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TombstonePurger(TaskRepository& repository, QObject* parent = nullptr);
+
+    // Задач за шаг и пауза между шагами, мс
+    void setBatchSize(int rows);
+    int batchSize() const { return batch; }
+    void setInterval(int ms);
+    int interval() const { return intervalMs; }
+    // TASK_MANAGER_PURGE_BATCH, TASK_MANAGER_PURGE_INTERVAL_MS
+    void configureFromEnvironment();
+
+    // Запуск или продолжение (после новой пометки или при старте); когда вычищать нечего - finished()
+    void start();
+    void stop();
+    bool isRunning() const { return timer.isActive(); }
+
+signals:
+    // Удалено задач с запуска / осталось
+    void progress(qint64 purged, qint64 remaining);
+    void finished();
+
+private:
+    void step();
+    void finish();
+
+    TaskRepository& repository;
+    QTimer timer;
+    int batch = 500;
+    int intervalMs = 10;
+    qint64 purged = 0;
+    qint64 total = 0;
+};
+
+#endif // TOMBSTONEPURGER_H
@@ -0,0 +1,140 @@
+#include "tracer.h"
+#include "applog.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    qint64 startNs;
+    qint64 durationNs;
+    int threadId;
+    QString detail;
+};
+
+struct TraceState {
+    QMutex mutex;
+    QElapsedTimer clock;
+    QString path;
+    QVector<TraceEvent> events;
+};
+
+TraceState& state()
+{
+    static TraceState instance;
+    return instance;
+}
+
+// Короткие номера потоков вместо системных id (1 - поток, включивший трассировку)
+std::atomic<int> nextThreadId{1};
+
+int currentThreadId()
+{
+    thread_local int id = nextThreadId.fetch_add(1);
+    return id;
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::enabled{false};
+
+void Tracer::start(const QString& path)
+{
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    s.path = path;
+    s.events.clear();
+    s.events.reserve(4096);
+    s.clock.start();
+    currentThreadId();
+    enabled.store(true, std::memory_order_relaxed);
+    qCInfo(lcTrace) << "Tracing to" << path;
+}
+
+void Tracer::startFromArguments(const QStringList& arguments)
+{
+    int index = arguments.indexOf("--trace");
+    if (index > 0 && index + 1 < arguments.size()) {
+        start(arguments[index + 1]);
+        return;
+    }
+
+    QString path = qEnvironmentVariable("TASK_MANAGER_TRACE");
+    if (!path.isEmpty()) {
+        start(path);
+    }
+}
+
+qint64 Tracer::now()
+{
+    return state().clock.nsecsElapsed();
+}
+
+void Tracer::record(const char* name, const char* category, qint64 startNs, qint64 endNs,
+                    const QString& detail)
+{
+    if (!isEnabled()) return;
+
+    TraceEvent event{name, category, startNs, endNs - startNs, currentThreadId(), detail};
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    s.events.append(std::move(event));
+}
+
+bool Tracer::stop()
+{
+    if (!isEnabled()) return true;
+    enabled.store(false, std::memory_order_relaxed);
+
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+
+    qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+
+    QJsonObject processName;
+    processName["name"] = "process_name";
+    processName["ph"] = "M";
+    processName["pid"] = pid;
+    processName["args"] = QJsonObject{{"name", "Task_Manager_dev"}};
+    traceEvents.append(processName);
+
+    // Полные события ("X"), время в микросекундах
+    for (const TraceEvent& event : s.events) {
+        QJsonObject object;
+        object["name"] = QString::fromUtf8(event.name);
+        object["cat"] = QString::fromUtf8(event.category);
+        object["ph"] = "X";
+        object["ts"] = event.startNs / 1000.0;
+        object["dur"] = event.durationNs / 1000.0;
+        object["pid"] = pid;
+        object["tid"] = event.threadId;
+        if (!event.detail.isEmpty()) {
+            object["args"] = QJsonObject{{"detail", event.detail}};
+        }
+        traceEvents.append(object);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(s.path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(lcTrace) << "Can't write trace file:" << s.path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    qCInfo(lcTrace) << "Trace written:" << s.path << "events:" << s.events.size();
+    s.events.clear();
+    return true;
+}
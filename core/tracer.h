@@ -0,0 +1,67 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <atomic>
+
+// Трассировка участков кода в формате Chrome trace-event (chrome://tracing, Perfetto).
+// Включается переменной TASK_MANAGER_TRACE=<файл> или флагом --trace <файл>;
+// когда выключена, TRACE_SCOPE стоит одну атомарную проверку
+class Tracer {
+public:
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static void start(const QString& path);
+    // Включение по аргументам командной строки или окружению
+    static void startFromArguments(const QStringList& arguments);
+    // Запись файла и выключение
+    static bool stop();
+
+    // Наносекунды от start()
+    static qint64 now();
+    static void record(const char* name, const char* category, qint64 startNs, qint64 endNs,
+                       const QString& detail);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* category = "app")
+        : name(name), category(category), startNs(Tracer::isEnabled() ? Tracer::now() : -1)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (startNs >= 0) Tracer::record(name, category, startNs, Tracer::now(), detail);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    bool isActive() const { return startNs >= 0; }
+    void setDetail(const QString& text) { detail = text; }
+
+private:
+    const char* name;
+    const char* category;
+    qint64 startNs;
+    QString detail;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+// Замер до конца текущей области видимости
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category)
+
+// То же с подробностями (выражение detail вычисляется только при включенной трассировке)
+#define TRACE_SCOPE_DETAIL(name, category, detail) \
+    TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category); \
+    if (TRACE_CONCAT(traceScope, __LINE__).isActive()) TRACE_CONCAT(traceScope, __LINE__).setDetail(detail)
+
+#endif // TRACER_H
@@ -0,0 +1,129 @@
+#include "trigramindex.h"
+#include "tracer.h"
+#include <algorithm>
+
+// Уникальные триграммы строки (с отступами, как в pg_trgm: "  ab" -> "  a", " ab", "ab ")
+QVector<quint64> TrigramIndex::trigrams(const QString& key)
+{
+    QString padded = "  " + key + " ";
+
+    QVector<quint64> result;
+    result.reserve(padded.size());
+    for (int i = 0; i + 2 < padded.size(); ++i) {
+        quint64 trigram = (quint64(padded[i].unicode()) << 32)
+                          | (quint64(padded[i + 1].unicode()) << 16)
+                          | quint64(padded[i + 2].unicode());
+        result.append(trigram);
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void TrigramIndex::insert(Kind kind, const QString& text)
+{
+    QString key = text.trimmed().toCaseFolded();
+    if (key.isEmpty()) return;
+
+    auto existing = entryByKey[kind].constFind(key);
+    if (existing != entryByKey[kind].constEnd()) {
+        entries[existing.value()].refs++;
+        return;
+    }
+
+    int slot;
+    if (!freeSlots.isEmpty()) {
+        slot = freeSlots.takeLast();
+    } else {
+        slot = entries.size();
+        entries.append(Entry());
+    }
+
+    QVector<quint64> keyTrigrams = trigrams(key);
+    entries[slot] = {text, key, 1, int(keyTrigrams.size())};
+    entryByKey[kind].insert(key, slot);
+
+    for (quint64 trigram : keyTrigrams) {
+        postings[kind][trigram].append(slot);
+    }
+}
+
+void TrigramIndex::remove(Kind kind, const QString& text)
+{
+    QString key = text.trimmed().toCaseFolded();
+    auto existing = entryByKey[kind].find(key);
+    if (existing == entryByKey[kind].end()) return;
+
+    int slot = existing.value();
+    if (--entries[slot].refs > 0) return;
+
+    for (quint64 trigram : trigrams(key)) {
+        auto list = postings[kind].find(trigram);
+        if (list == postings[kind].end()) continue;
+        list->removeOne(slot);
+        if (list->isEmpty()) postings[kind].erase(list);
+    }
+
+    entryByKey[kind].erase(existing);
+    entries[slot] = Entry();
+    freeSlots.append(slot);
+}
+
+void TrigramIndex::clear()
+{
+    entries.clear();
+    freeSlots.clear();
+    for (int kind = 0; kind < KindCount; ++kind) {
+        entryByKey[kind].clear();
+        postings[kind].clear();
+    }
+}
+
+// Сходство: коэффициент Жаккара по триграммам + небольшой бонус за совпадение префикса
+QVector<TrigramIndex::Match> TrigramIndex::topMatches(Kind kind, const QString& query, int k) const
+{
+    TRACE_SCOPE("TrigramIndex::topMatches", "search");
+    QVector<Match> result;
+    QString key = query.trimmed().toCaseFolded();
+    if (key.isEmpty() || k <= 0) return result;
+
+    QVector<quint64> queryTrigrams = trigrams(key);
+
+    // Подсчет общих триграмм по спискам
+    QHash<int, int> shared;
+    for (quint64 trigram : queryTrigrams) {
+        auto list = postings[kind].constFind(trigram);
+        if (list == postings[kind].constEnd()) continue;
+        for (int slot : *list) {
+            shared[slot]++;
+        }
+    }
+
+    struct Scored { int slot; double score; };
+    QVector<Scored> scored;
+    scored.reserve(shared.size());
+    for (auto it = shared.constBegin(); it != shared.constEnd(); ++it) {
+        const Entry& entry = entries[it.key()];
+        double jaccard = double(it.value()) / (queryTrigrams.size() + entry.trigramCount - it.value());
+        double prefix = entry.key.startsWith(key) ? 1.0 : 0.0;
+        scored.append({it.key(), 0.85 * jaccard + 0.15 * prefix});
+    }
+
+    int count = std::min<int>(k, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + count, scored.end(),
+                      [](const Scored& a, const Scored& b) { return a.score > b.score; });
+
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        result.append({entries[scored[i].slot].text, scored[i].score});
+    }
+    return result;
+}
+
+QString TrigramIndex::bestMatch(Kind kind, const QString& query, double minScore) const
+{
+    QVector<Match> matches = topMatches(kind, query, 1);
+    if (matches.isEmpty() || matches.first().score < minScore) return QString();
+    return matches.first().text;
+}
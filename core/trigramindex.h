@@ -0,0 +1,44 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Нечеткий поиск по триграммам (имена рабочих пр-в, категорий, описания задач и записей истории).
+// Одинаковые строки хранятся один раз со счетчиком ссылок
+class TrigramIndex {
+public:
+    enum Kind { WorkspaceName = 0, CategoryName = 1, TaskDescription = 2, HistoryDescription = 3, KindCount = 4 };
+
+    struct Match {
+        QString text;
+        double score = 0.0; // 0..1, 1 - точное совпадение
+    };
+
+    void insert(Kind kind, const QString& text);
+    void remove(Kind kind, const QString& text);
+    void clear();
+
+    // k ближайших строк данного вида
+    QVector<Match> topMatches(Kind kind, const QString& query, int k = 10) const;
+    // Лучшее совпадение не хуже minScore (или пустая строка)
+    QString bestMatch(Kind kind, const QString& query, double minScore = 0.3) const;
+
+private:
+    struct Entry {
+        QString text;
+        QString key;
+        int refs = 0;
+        int trigramCount = 0;
+    };
+
+    static QVector<quint64> trigrams(const QString& key);
+
+    QVector<Entry> entries;
+    QVector<int> freeSlots;
+    QHash<QString, int> entryByKey[KindCount];
+    QHash<quint64, QVector<int>> postings[KindCount];
+};
+
+#endif // TRIGRAMINDEX_H
@@ -0,0 +1,169 @@
+#include "undostack.h"
+#include "taskrepository.h"
+#include "applog.h"
+#include "tracer.h"
+#include <QString>
+#include <stdexcept>
+
+namespace {
+
+// Строки команды изменены другим путем (другой процесс, очистка) - команда устарела
+void requireRow(int affected, const char* what, int id)
+{
+    if (affected != 1) {
+        throw std::runtime_error(QString("%1 %2 not found").arg(what).arg(id).toStdString());
+    }
+}
+
+} // namespace
+
+UndoStack::UndoStack(TaskRepository& repository)
+    : repository(repository)
+{
+}
+
+UndoStack::TaskRow UndoStack::taskRow(const Task& task, int categoryId)
+{
+    TaskRow row;
+    row.id = task.getId();
+    row.categoryId = categoryId;
+    row.description = task.getDescription();
+    row.tags = task.getTags();
+    row.difficulty = task.getDifficulty();
+    row.priority = task.getPriority();
+    row.status = task.getStatus();
+    row.deadline = task.getDeadline();
+    return row;
+}
+
+void UndoStack::push(const Command& command)
+{
+    undoCommands.append(command);
+    if (undoCommands.size() > maxDepth) {
+        undoCommands.removeFirst();
+    }
+    redoCommands.clear();
+}
+
+void UndoStack::clear()
+{
+    undoCommands.clear();
+    redoCommands.clear();
+}
+
+ChangeFeed::Rows UndoStack::undo()
+{
+    return run(undoCommands, redoCommands, false);
+}
+
+ChangeFeed::Rows UndoStack::redo()
+{
+    return run(redoCommands, undoCommands, true);
+}
+
+ChangeFeed::Rows UndoStack::run(QVector<Command>& from, QVector<Command>& to, bool forward)
+{
+    ChangeFeed::Rows rows;
+    if (from.isEmpty()) return rows;
+    TRACE_SCOPE_DETAIL("UndoStack::run", "sql", from.last().label);
+
+    Command command = from.takeLast();
+    try {
+        // Без транзакции apply() шел бы в autocommit и при ошибке не откатился бы
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+        apply(command, forward, rows);
+        if (!repository.commit()) {
+            throw std::runtime_error(repository.lastError().toStdString());
+        }
+    } catch (...) {
+        // Команда не применима (строки изменены другим путем) - со стека снимается
+        repository.rollback();
+        throw;
+    }
+
+    to.append(command);
+    return rows;
+}
+
+void UndoStack::insertTask(const TaskRow& task, const QString& status, ChangeFeed::Rows& rows)
+{
+    repository.insertTask(task.description, task.categoryId, task.tags, task.difficulty, task.priority,
+                          status, task.deadline, task.id);
+    rows.addTask(task.id, task.categoryId);
+}
+
+void UndoStack::deleteTask(const TaskRow& task, ChangeFeed::Rows& rows)
+{
+    requireRow(repository.deleteTask(task.id), "Task", task.id);
+    rows.addTask(task.id, task.categoryId);
+}
+
+void UndoStack::apply(Command& command, bool forward, ChangeFeed::Rows& rows)
+{
+    switch (command.kind) {
+    case Command::AddTask:
+    case Command::RemoveTask:
+        // Отмена добавления - удаление, отмена удаления - вставка с прежним id
+        if (forward == (command.kind == Command::AddTask)) {
+            insertTask(command.tasks.first(), command.tasks.first().status, rows);
+        } else {
+            deleteTask(command.tasks.first(), rows);
+        }
+        break;
+
+    case Command::ChangeStatus: {
+        const TaskRow& task = command.tasks.first();
+        requireRow(repository.updateTaskStatus(task.id, forward ? command.after : command.before), "Task", task.id);
+        rows.addTask(task.id, task.categoryId);
+        break;
+    }
+
+    case Command::CompleteTask: {
+        const TaskRow& task = command.tasks.first();
+        if (forward) {
+            // Повтор: как в MainWindow::changeTaskStatus, запись истории получает новый id
+            Task completed(task.id, task.description, QString(), task.tags, task.difficulty, task.priority,
+                           command.after, task.deadline);
+            command.historyId = repository.moveTaskToHistory(completed, task.categoryId, command.after, nullptr);
+            rows.addTask(task.id, task.categoryId);
+        } else {
+            requireRow(repository.deleteHistoryTask(command.historyId), "History task", command.historyId);
+            insertTask(task, command.before, rows);
+        }
+        rows.history.insert(command.historyId);
+        break;
+    }
+
+    case Command::AddCategory:
+        if (forward) {
+            repository.insertCategory(command.name, command.workspaceId, command.categoryId);
+        } else {
+            // Задачи, добавленные в категорию позже, сняты со стека раньше нее
+            repository.deleteCategory(command.categoryId);
+        }
+        rows.addCategory(command.categoryId, command.workspaceId);
+        break;
+
+    case Command::RemoveCategory:
+        if (forward) {
+            // Как в MainWindow::removeCategory: пометка, строки удалит очистка
+            repository.markCategoryDeleted(command.categoryId);
+        } else if (repository.unmarkCategoryDeleted(command.categoryId)) {
+            // Очистка не дошла до конца: возвращаются только уже удаленные задачи
+            const QSet<int> remaining = repository.categoryTaskIds(command.categoryId);
+            for (const TaskRow& task : command.tasks) {
+                if (!remaining.contains(task.id)) insertTask(task, task.status, rows);
+            }
+        } else {
+            repository.insertCategory(command.name, command.workspaceId, command.categoryId);
+            for (const TaskRow& task : command.tasks) {
+                insertTask(task, task.status, rows);
+            }
+        }
+        rows.addCategory(command.categoryId, command.workspaceId);
+        break;
+    }
+    qCDebug(lcModel) << (forward ? "Redo:" : "Undo:") << command.label;
+}
@@ -0,0 +1,77 @@
+#ifndef UNDOSTACK_H
+#define UNDOSTACK_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "changefeed.h"
+
+class TaskRepository;
+
+// Многоуровневая отмена изменений. Команда хранит только то, что нужно для обратной
+// операции: id и измененные поля (для смены статуса - id и два статуса, для удаления -
+// удаленные строки). Строки возвращаются с прежними id (AUTOINCREMENT их не переиспользует),
+// поэтому более ранние команды стека остаются верными. Удаленная категория лишь помечена
+// (TombstonePurger), отмена снимает пометку и досоздает уже вычищенные задачи. Отмена и повтор
+// выполняются одной транзакцией репозитория и возвращают затронутые строки - модель правится
+// ChangeFeed::refresh
+class UndoStack {
+public:
+    struct TaskRow {
+        int id = 0;
+        int categoryId = 0;
+        QString description;
+        QStringList tags;
+        QString difficulty;
+        QString priority;
+        QString status;
+        QString deadline;
+    };
+
+    struct Command {
+        enum Kind { AddTask, RemoveTask, ChangeStatus, CompleteTask, AddCategory, RemoveCategory };
+
+        Kind kind = AddTask;
+        QString label;          // описание для интерфейса
+        int workspaceId = 0;    // категории
+        int categoryId = 0;
+        QString name;           // имя категории
+        QString before;         // статус до и после
+        QString after;
+        int historyId = 0;      // завершение: запись истории (меняется при повторе)
+        QVector<TaskRow> tasks; // вставленные/удаленные задачи; для смены статуса - только id и категория
+    };
+
+    static const int maxDepth = 100;
+
+    explicit UndoStack(TaskRepository& repository);
+
+    static TaskRow taskRow(const Task& task, int categoryId);
+
+    // Новое действие: стек повтора очищается
+    void push(const Command& command);
+    // После изменений, которые стек не отражает (импорт, восстановление копии, ...)
+    void clear();
+
+    bool canUndo() const { return !undoCommands.isEmpty(); }
+    bool canRedo() const { return !redoCommands.isEmpty(); }
+    QString undoLabel() const { return canUndo() ? undoCommands.last().label : QString(); }
+    QString redoLabel() const { return canRedo() ? redoCommands.last().label : QString(); }
+
+    // Бросают std::runtime_error (транзакция откатывается, команда снимается со стека)
+    ChangeFeed::Rows undo();
+    ChangeFeed::Rows redo();
+
+private:
+    ChangeFeed::Rows run(QVector<Command>& from, QVector<Command>& to, bool forward);
+    void apply(Command& command, bool forward, ChangeFeed::Rows& rows);
+    void insertTask(const TaskRow& task, const QString& status, ChangeFeed::Rows& rows);
+    void deleteTask(const TaskRow& task, ChangeFeed::Rows& rows);
+
+    TaskRepository& repository;
+    QVector<Command> undoCommands;
+    QVector<Command> redoCommands;
+};
+
+#endif // UNDOSTACK_H
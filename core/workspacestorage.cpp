@@ -0,0 +1,321 @@
+#include "workspacestorage.h"
+#include "writecoordinator.h"
+#include "applog.h"
+#include "tracer.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <iterator>
+#include <stdexcept>
+
+WorkspaceStorage::WorkspaceStorage(QSqlDatabase& db, WriteCoordinator& writes)
+    : db(db), writes(writes)
+{
+    clock.start();
+    QObject::connect(&idleTimer, &QTimer::timeout, [this]() { detachIdle(); });
+}
+
+QString WorkspaceStorage::directoryFor(const QString& databasePath)
+{
+    QFileInfo info(databasePath);
+    return info.dir().filePath(info.completeBaseName() + "-workspaces");
+}
+
+QStringList WorkspaceStorage::files(const QString& databasePath)
+{
+    QDir dir(directoryFor(databasePath));
+    QStringList paths;
+    for (const QString& name : dir.entryList({"ws_*.db"}, QDir::Files, QDir::Name)) {
+        paths.append(dir.filePath(name));
+    }
+    return paths;
+}
+
+QString WorkspaceStorage::fileFor(const QString& databasePath, int workspaceId)
+{
+    return QDir(directoryFor(databasePath)).filePath(schemaName(workspaceId) + ".db");
+}
+
+void WorkspaceStorage::setIdleTimeout(int ms)
+{
+    idleMs = qMax(1000, ms);
+    if (idleTimer.isActive()) idleTimer.start(idleMs);
+}
+
+void WorkspaceStorage::configureFromEnvironment()
+{
+    bool ok = false;
+    int on = qEnvironmentVariableIntValue("TASK_MANAGER_WORKSPACE_FILES", &ok);
+    if (ok) setEnabled(on != 0);
+
+    int ms = qEnvironmentVariableIntValue("TASK_MANAGER_WORKSPACE_IDLE_MS", &ok);
+    if (ok) setIdleTimeout(ms);
+}
+
+QString WorkspaceStorage::schemaName(int workspaceId)
+{
+    return QString("ws_%1").arg(workspaceId);
+}
+
+QString WorkspaceStorage::filePath(int workspaceId) const
+{
+    return QDir(directory).filePath(schemaName(workspaceId) + ".db");
+}
+
+void WorkspaceStorage::execute(const QString& sql)
+{
+    TRACE_SCOPE_DETAIL("sql", "sql", sql);
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+}
+
+void WorkspaceStorage::createSchema()
+{
+    reset();
+    directory = directoryFor(db.databaseName());
+
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TABLE IF NOT EXISTS WorkspaceFiles (workspace_id INTEGER PRIMARY KEY, "
+                    "slot INTEGER NOT NULL UNIQUE, "
+                    "FOREIGN KEY(workspace_id) REFERENCES Workspaces(id) ON DELETE CASCADE);")) {
+        qCWarning(lcDb) << "SQL error:" << query.lastError().text();
+        return;
+    }
+
+    query.exec("SELECT workspace_id, slot FROM WorkspaceFiles;");
+    while (query.next()) {
+        Slot slot;
+        slot.slot = query.value(1).toInt();
+        slots.insert(query.value(0).toInt(), slot);
+    }
+    query.exec("SELECT c.id, c.workspace_id FROM Categories c "
+               "JOIN WorkspaceFiles f ON f.workspace_id = c.workspace_id;");
+    while (query.next()) {
+        categoryWorkspaces.insert(query.value(0).toInt(), query.value(1).toInt());
+    }
+    query.finish();
+
+    // Файлы пр-в, которых уже нет в каталоге (удаление зафиксировано, файл не успели удалить)
+    QDir dir(directory);
+    for (const QString& name : dir.entryList({"ws_*.db"}, QDir::Files)) {
+        bool ok = false;
+        int workspaceId = name.mid(3, name.size() - 6).toInt(&ok);
+        if (!ok || slots.contains(workspaceId)) continue;
+        for (const QString& suffix : {"", "-journal", "-wal", "-shm"}) {
+            QFile::remove(dir.filePath(name) + suffix);
+        }
+        qCInfo(lcDb) << "Removed file of deleted workspace:" << name;
+    }
+
+    if (!slots.isEmpty()) {
+        qCInfo(lcDb) << slots.size() << "workspaces stored in separate files";
+    }
+}
+
+void WorkspaceStorage::reset()
+{
+    idleTimer.stop();
+    for (auto it = slots.constBegin(); it != slots.constEnd(); ++it) {
+        if (it->attached) detach(schemaName(it.key()));
+    }
+    for (auto it = removed.constBegin(); it != removed.constEnd(); ++it) {
+        if (it->attached) detach(schemaName(it.key()));
+    }
+    slots.clear();
+    removed.clear();
+    categoryWorkspaces.clear();
+}
+
+QString WorkspaceStorage::schemaForWorkspace(int workspaceId)
+{
+    auto it = slots.find(workspaceId);
+    if (it == slots.end()) return "main";
+    return attach(workspaceId, it.value());
+}
+
+QString WorkspaceStorage::schemaForCategory(int categoryId)
+{
+    auto it = categoryWorkspaces.constFind(categoryId);
+    if (it == categoryWorkspaces.constEnd()) return "main";
+    return schemaForWorkspace(it.value());
+}
+
+QString WorkspaceStorage::schemaForTask(int taskId)
+{
+    if (!isSplitId(taskId)) return "main";
+
+    const int slotIndex = (taskId - firstSplitId) >> slotBits;
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        if (it->slot == slotIndex) return attach(it.key(), it.value());
+    }
+    throw std::runtime_error(QString("No workspace file for task %1").arg(taskId).toStdString());
+}
+
+QString WorkspaceStorage::attach(int workspaceId, Slot& slot)
+{
+    slot.lastUsed = clock.elapsed();
+    const QString schema = schemaName(workspaceId);
+    if (slot.attached) return schema;
+
+    TRACE_SCOPE_DETAIL("WorkspaceStorage::attach", "sql", schema);
+    QDir().mkpath(directory);
+
+    QSqlQuery query(db);
+    if (!query.prepare(QString("ATTACH DATABASE :path AS %1").arg(schema))) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+    query.bindValue(":path", filePath(workspaceId));
+    if (!query.exec()) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+    slot.attached = true;
+
+    createTables(schema, slot.slot);
+    if (attachHook) attachHook(schema);
+    if (!idleTimer.isActive()) idleTimer.start(idleMs);
+
+    qCDebug(lcDb) << "Attached workspace file" << filePath(workspaceId);
+    return schema;
+}
+
+// Те же таблицы, что в основной бд, но без ссылки на Categories (она в другом файле).
+// Счетчик AUTOINCREMENT начинается с начала диапазона слота, CHECK не дает выйти за его конец
+void WorkspaceStorage::createTables(const QString& schema, int slot)
+{
+    const qint64 base = qint64(firstSplitId) + (qint64(slot) << slotBits);
+    const qint64 limit = base + (qint64(1) << slotBits);
+
+    // Режим журнала не переключается внутри транзакции - тогда при следующем подключении
+    if (!writes.hasPending()) {
+        execute(QString("PRAGMA %1.journal_mode=WAL;").arg(schema));
+    }
+    execute(QString("PRAGMA %1.synchronous=NORMAL;").arg(schema));
+
+    execute(QString("CREATE TABLE IF NOT EXISTS %1.Tasks ("
+                    "id INTEGER PRIMARY KEY AUTOINCREMENT CHECK (id > %2 AND id < %3), "
+                    "description TEXT NOT NULL, category_id INTEGER, "
+                    "difficulty TEXT, priority TEXT, status TEXT, deadline TEXT);")
+                .arg(schema).arg(base).arg(limit));
+    execute(QString("CREATE TABLE IF NOT EXISTS %1.TaskTags (id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                    "task_id INTEGER, tag TEXT, "
+                    "FOREIGN KEY(task_id) REFERENCES Tasks(id) ON DELETE CASCADE);").arg(schema));
+    execute(QString("CREATE INDEX IF NOT EXISTS %1.Tasks_category_id ON Tasks(category_id);").arg(schema));
+    execute(QString("CREATE INDEX IF NOT EXISTS %1.TaskTags_task_id ON TaskTags(task_id);").arg(schema));
+    execute(QString("INSERT INTO %1.sqlite_sequence (name, seq) SELECT 'Tasks', %2 "
+                    "WHERE NOT EXISTS (SELECT 1 FROM %1.sqlite_sequence WHERE name = 'Tasks');")
+                .arg(schema).arg(base));
+}
+
+bool WorkspaceStorage::detach(const QString& schema)
+{
+    QSqlQuery query(db);
+    if (!query.exec("DETACH DATABASE " + schema)) {
+        qCWarning(lcDb) << "Can't detach" << schema << ":" << query.lastError().text();
+        return false;
+    }
+    qCDebug(lcDb) << "Detached" << schema;
+    return true;
+}
+
+// Отключение простаивающих файлов и удаление файлов удаленных пр-в.
+// Пока пачка записей не зафиксирована, файлы остаются подключенными
+void WorkspaceStorage::detachIdle()
+{
+    if (writes.hasPending()) return;
+
+    const qint64 now = clock.elapsed();
+    bool anyAttached = false;
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        if (it->attached && now - it->lastUsed >= idleMs && detach(schemaName(it.key()))) {
+            it->attached = false;
+        }
+        anyAttached = anyAttached || it->attached;
+    }
+
+    for (auto it = removed.begin(); it != removed.end(); it = removed.erase(it)) {
+        const int workspaceId = it.key();
+
+        // Удаление могло откатиться вместе с пачкой - тогда пр-во остается в файле
+        QSqlQuery query(db);
+        query.prepare("SELECT 1 FROM WorkspaceFiles WHERE workspace_id = :workspace_id");
+        query.bindValue(":workspace_id", workspaceId);
+        if (!query.exec() || query.next()) {
+            query.finish();
+            slots.insert(workspaceId, it.value());
+            anyAttached = anyAttached || it->attached;
+            QSqlQuery categories(db);
+            categories.prepare("SELECT id FROM Categories WHERE workspace_id = :workspace_id");
+            categories.bindValue(":workspace_id", workspaceId);
+            categories.exec();
+            while (categories.next()) {
+                categoryWorkspaces.insert(categories.value(0).toInt(), workspaceId);
+            }
+            continue;
+        }
+
+        if (it->attached && !detach(schemaName(workspaceId))) {
+            // Файл удалится при следующем открытии бд
+            continue;
+        }
+        const QString path = filePath(workspaceId);
+        for (const QString& suffix : {"", "-journal", "-wal", "-shm"}) {
+            QFile::remove(path + suffix);
+        }
+        qCInfo(lcDb) << "Removed workspace file" << path;
+    }
+
+    if (!anyAttached) idleTimer.stop();
+}
+
+void WorkspaceStorage::addWorkspace(int workspaceId)
+{
+    QVector<bool> used(slotCount, false);
+    for (const Slot& slot : slots) used[slot.slot] = true;
+    for (const Slot& slot : removed) used[slot.slot] = true;
+    const int free = used.indexOf(false);
+    if (free < 0) {
+        throw std::runtime_error("No free workspace file slots");
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO WorkspaceFiles (workspace_id, slot) VALUES (:workspace_id, :slot)");
+    query.bindValue(":workspace_id", workspaceId);
+    query.bindValue(":slot", free);
+    if (!query.exec()) {
+        throw std::runtime_error(query.lastError().text().toStdString());
+    }
+
+    Slot slot;
+    slot.slot = free;
+    attach(workspaceId, slots.insert(workspaceId, slot).value());
+}
+
+void WorkspaceStorage::removeWorkspace(int workspaceId)
+{
+    auto it = slots.find(workspaceId);
+    if (it == slots.end()) return;
+
+    removed.insert(workspaceId, it.value());
+    slots.erase(it);
+    for (auto category = categoryWorkspaces.begin(); category != categoryWorkspaces.end();) {
+        category = category.value() == workspaceId ? categoryWorkspaces.erase(category) : std::next(category);
+    }
+    if (!idleTimer.isActive()) idleTimer.start(idleMs);
+}
+
+void WorkspaceStorage::addCategory(int categoryId, int workspaceId)
+{
+    if (slots.contains(workspaceId)) {
+        categoryWorkspaces.insert(categoryId, workspaceId);
+    }
+}
+
+void WorkspaceStorage::removeCategory(int categoryId)
+{
+    categoryWorkspaces.remove(categoryId);
+}
@@ -0,0 +1,96 @@
+#ifndef WORKSPACESTORAGE_H
+#define WORKSPACESTORAGE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+
+class WriteCoordinator;
+
+// Необязательный режим хранения: задачи и теги рабочего пр-ва лежат в отдельном файле
+// <бд>-workspaces/ws_<id>.db. Основная бд служит каталогом - в ней остаются Workspaces,
+// Categories, история и WorkspaceFiles. Файл подключается (ATTACH как ws_<id>) при первом
+// обращении и отключается после простоя; удаленное пр-во - это удаленный файл.
+//
+// Id задач такого пр-ва выдаются из собственного диапазона (слота) выше firstSplitId,
+// поэтому схема задачи определяется по id без запроса к бд
+class WorkspaceStorage {
+public:
+    WorkspaceStorage(QSqlDatabase& db, WriteCoordinator& writes);
+
+    static constexpr int firstSplitId = 1 << 30;
+    static constexpr int slotBits = 24;     // ~16.7 млн id на пр-во
+    static constexpr int slotCount = 32;
+    static bool isSplitId(int id) { return id >= firstSplitId; }
+
+    // Каталог файлов рабочих пр-в и сами файлы (для резервного копирования)
+    static QString directoryFor(const QString& databasePath);
+    static QStringList files(const QString& databasePath);
+    // Файл и имя схемы пр-ва (для своих соединений, например экспорта)
+    static QString fileFor(const QString& databasePath, int workspaceId);
+    static QString schemaName(int workspaceId);
+
+    // Новые рабочие пр-ва создаются в отдельных файлах
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+    // Отключение файла после простоя, мс
+    void setIdleTimeout(int ms);
+    // TASK_MANAGER_WORKSPACE_FILES (0/1), TASK_MANAGER_WORKSPACE_IDLE_MS
+    void configureFromEnvironment();
+
+    // Вызывается после каждого подключения файла (временные триггеры)
+    void setAttachHook(const std::function<void(const QString& schema)>& hook) { attachHook = hook; }
+
+    // Таблица WorkspaceFiles, чтение каталога, удаление файлов удаленных пр-в
+    void createSchema();
+    // Отключение всех файлов и сброс состояния (перед закрытием бд)
+    void reset();
+
+    bool isSplitWorkspace(int workspaceId) const { return slots.contains(workspaceId); }
+    bool isSplitCategory(int categoryId) const { return categoryWorkspaces.contains(categoryId); }
+
+    // Схема для запросов: "main" или ws_<id> (файл подключается при необходимости).
+    // Бросают std::runtime_error
+    QString schemaForWorkspace(int workspaceId);
+    QString schemaForCategory(int categoryId);
+    QString schemaForTask(int taskId);
+
+    // Изменения каталога (в транзакции вызывающего)
+    void addWorkspace(int workspaceId);
+    void removeWorkspace(int workspaceId);
+    void addCategory(int categoryId, int workspaceId);
+    void removeCategory(int categoryId);
+
+private:
+    struct Slot {
+        int slot = 0;
+        bool attached = false;
+        qint64 lastUsed = 0;
+    };
+
+    QString filePath(int workspaceId) const;
+    QString attach(int workspaceId, Slot& slot);
+    void createTables(const QString& schema, int slot);
+    bool detach(const QString& schema);
+    void detachIdle();
+    void execute(const QString& sql);
+
+    QSqlDatabase& db;
+    WriteCoordinator& writes;
+    QString directory;
+    bool enabled = false;
+    int idleMs = 5 * 60 * 1000;
+    QHash<int, Slot> slots;                 // workspace id -> слот
+    QHash<int, int> categoryWorkspaces;     // только категории пр-в с файлами
+    QHash<int, Slot> removed;               // ждут фиксации удаления, потом файл удаляется
+    std::function<void(const QString&)> attachHook;
+    QTimer idleTimer;
+    QElapsedTimer clock;
+};
+
+#endif // WORKSPACESTORAGE_H
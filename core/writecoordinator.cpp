@@ -0,0 +1,152 @@
+#include "writecoordinator.h"
+#include "applog.h"
+#include "sqlprofiler.h"
+#include "tracer.h"
+#include <QSqlError>
+#include <QSqlQuery>
+
+WriteCoordinator::WriteCoordinator(QSqlDatabase& db)
+    : db(db)
+{
+    timer.setSingleShot(true);
+    QObject::connect(&timer, &QTimer::timeout, [this]() { flush(); });
+}
+
+WriteCoordinator::~WriteCoordinator()
+{
+    flush();
+}
+
+void WriteCoordinator::setWindow(int ms)
+{
+    windowMs = qMax(0, ms);
+    if (windowMs == 0) {
+        flush();
+    }
+}
+
+void WriteCoordinator::configureFromEnvironment(int defaultMs)
+{
+    bool ok = false;
+    int ms = qEnvironmentVariableIntValue("TASK_MANAGER_COMMIT_WINDOW_MS", &ok);
+    setWindow(ok ? ms : defaultMs);
+}
+
+void WriteCoordinator::setBatchStatements(const QString& opening, const QString& closing)
+{
+    batchOpening = opening;
+    batchClosing = closing;
+}
+
+bool WriteCoordinator::execute(const QString& sql)
+{
+    TRACE_SCOPE_DETAIL("sql", "sql", sql);
+    SqlProfileScope profile(sql);
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        qCWarning(lcDb) << "SQL error:" << sql << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool WriteCoordinator::begin()
+{
+    if (!db.isOpen()) return false;
+
+    if (!batchOpen) {
+        if (!db.transaction()) {
+            qCWarning(lcDb) << "Can't start transaction:" << db.lastError().text();
+            return false;
+        }
+        batchOpen = true;
+        pending = 0;
+        batchOpened = !batchOpening.isEmpty() && execute(batchOpening);
+    }
+
+    // Точка сохранения на каждое изменение (вложенные begin() получают свою)
+    if (!execute(QString("SAVEPOINT mutation_%1").arg(depth))) {
+        if (pending == 0 && depth == 0) abortBatch();
+        return false;
+    }
+    depth++;
+    return true;
+}
+
+bool WriteCoordinator::commit()
+{
+    if (depth == 0) return false;
+    if (!execute(QString("RELEASE mutation_%1").arg(depth - 1))) {
+        // Точка сохранения осталась открытой - изменение откатывается здесь же (при сбое отката -
+        // вся пачка), иначе транзакция пачки так и осталась бы незакрытой
+        rollback();
+        return false;
+    }
+    depth--;
+    if (depth > 0) return true;
+
+    pending++;
+    // Без окна пачка - это одно текущее изменение: о сбое узнает вызывающий
+    if (windowMs == 0) return commitBatch(false);
+    if (!timer.isActive()) timer.start(windowMs);
+    return true;
+}
+
+bool WriteCoordinator::rollback()
+{
+    if (depth == 0) return false;
+    depth--;
+    const QString savepoint = QString("mutation_%1").arg(depth);
+    if (!execute("ROLLBACK TO " + savepoint) || !execute("RELEASE " + savepoint)) {
+        // SQLite уже откатил всю транзакцию (например, при нехватке места)
+        const int lost = pending;
+        const QString error = db.lastError().text();
+        qCWarning(lcDb) << "Batch of" << lost << "changes lost on rollback";
+        depth = 0;
+        abortBatch();
+        if (lost > 0 && failureHandler) failureHandler(lost, error);
+        return false;
+    }
+
+    // Пустая пачка не держит транзакцию открытой
+    if (depth == 0 && pending == 0) abortBatch();
+    return true;
+}
+
+bool WriteCoordinator::flush()
+{
+    return commitBatch(true);
+}
+
+bool WriteCoordinator::commitBatch(bool notify)
+{
+    timer.stop();
+    if (!batchOpen || depth > 0) return !batchOpen;
+
+    TRACE_SCOPE("WriteCoordinator::flush", "sql");
+    const int count = pending;
+    SqlProfileScope profile("COMMIT");
+    const bool closed = !batchOpened || batchClosing.isEmpty() || execute(batchClosing);
+    if (!closed || !db.commit()) {
+        const QString error = db.lastError().text();
+        qCWarning(lcDb) << "Commit of" << count << "changes failed:" << error;
+        abortBatch();
+        if (notify && count > 0 && failureHandler) failureHandler(count, error);
+        return false;
+    }
+    profile.addRows(count);
+    batchOpen = false;
+    pending = 0;
+    qCDebug(lcDb) << "Committed batch of" << count << "changes";
+    return true;
+}
+
+void WriteCoordinator::abortBatch()
+{
+    timer.stop();
+    if (batchOpen) {
+        db.rollback();
+    }
+    batchOpen = false;
+    pending = 0;
+}
@@ -0,0 +1,67 @@
+#ifndef WRITECOORDINATOR_H
+#define WRITECOORDINATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QTimer>
+#include <functional>
+
+// Групповая фиксация: изменения, пришедшие в пределах окна, попадают в одну транзакцию.
+// Каждое изменение - SAVEPOINT внутри общей транзакции, так что rollback() отменяет
+// только его, не трогая уже принятые изменения пачки.
+//
+// Гарантия: изменение записано на диск после flush(), т.е. не позже window мс после commit()
+// (window = 0 - сразу). При падении процесса теряется только незафиксированная пачка
+// (последнее окно), а о потере уже принятой commit() пачки сообщает обработчик сбоя;
+// при synchronous=NORMAL в WAL отключение питания может дополнительно
+// откатить последние фиксации до контрольной точки, но бд остается целостной
+class WriteCoordinator {
+public:
+    explicit WriteCoordinator(QSqlDatabase& db);
+    ~WriteCoordinator();
+
+    // Окно группировки в мс (0 - фиксировать каждое изменение сразу)
+    void setWindow(int ms);
+    int window() const { return windowMs; }
+    // TASK_MANAGER_COMMIT_WINDOW_MS, по умолчанию defaultMs
+    void configureFromEnvironment(int defaultMs);
+
+    // Начало, принятие и отмена одного изменения. Неудачный commit() сам откатывает изменение
+    bool begin();
+    bool commit();
+    bool rollback();
+
+    // Немедленная фиксация накопленной пачки
+    bool flush();
+
+    // Пачка с принятыми изменениями откатилась при отложенной фиксации (или SQLite откатил
+    // транзакцию целиком): число потерянных изменений и ошибка. Сбой фиксации одного изменения
+    // без окна виден вызывающему по результату commit()
+    void setFailureHandler(const std::function<void(int, const QString&)>& handler) { failureHandler = handler; }
+
+    // SQL сразу после начала транзакции пачки и перед ее фиксацией (пустая строка - ничего).
+    // Сбой первого не мешает записи (второй тогда не выполняется), сбой второго - сбой фиксации пачки
+    void setBatchStatements(const QString& opening, const QString& closing);
+
+    bool hasPending() const { return batchOpen; }
+    // Число изменений в текущей пачке
+    int pendingCount() const { return pending; }
+
+private:
+    bool execute(const QString& sql);
+    bool commitBatch(bool notify);
+    void abortBatch();
+
+    QSqlDatabase& db;
+    QTimer timer;
+    int windowMs = 0;
+    int depth = 0;          // вложенные begin()
+    int pending = 0;
+    bool batchOpen = false;
+    QString batchOpening;
+    QString batchClosing;
+    bool batchOpened = false;   // batchOpening выполнен в текущей пачке
+    std::function<void(int, const QString&)> failureHandler;
+};
+
+#endif // WRITECOORDINATOR_H
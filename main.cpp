@@ -1,11 +1,31 @@
 #include "mainwindow.h"
+#include "tracer.h"
+#include "sqlprofiler.h"
+#include "applog.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
-    MainWindow w;
-    w.show();
-    return a.exec();
+    // Журнал пишется в фоновом потоке
+    AsyncLogWriter::install();
+
+    // Трассировка: --trace <файл> или TASK_MANAGER_TRACE=<файл>
+    Tracer::startFromArguments(a.arguments());
+    SqlProfiler::configureFromEnvironment();
+
+    int result;
+    {
+        MainWindow w;
+        w.show();
+        result = a.exec();
+    }
+
+    Tracer::stop();
+    if (!SqlProfiler::dumpPath().isEmpty()) {
+        SqlProfiler::dump(SqlProfiler::dumpPath());
+    }
+    AsyncLogWriter::shutdown();
+    return result;
 }
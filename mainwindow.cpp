@@ -1,6 +1,4 @@
 #include "mainwindow.h"
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QDate>
@@ -15,6 +13,34 @@
 #include <QListWidget>
 #include <QAction>
 #include <QEvent>
+#include <QCheckBox>
+#include <QTableView>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QShortcut>
+#include <QKeySequence>
+#include <QFileDialog>
+#include <QSplitter>
+#include <QProgressDialog>
+#include <QProgressBar>
+#include <QSpinBox>
+#include <QFont>
+#include <QJsonDocument>
+#include <QFile>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include "taskresultsmodel.h"
+#include "tagcompleter.h"
+#include "tracer.h"
+#include "sqlprofiler.h"
+#include "applog.h"
+#include "memoryaccounting.h"
+#include "parallelloader.h"
+#include "modelcache.h"
+#include "taskimporter.h"
 
 // Вспомогательная ф-ция превода
 static QString translate(const char* text) {
@@ -24,38 +50,141 @@ static QString translate(const char* text) {
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), isEnglish(false), isDarkTheme(false)
 {
+    TRACE_SCOPE("MainWindow::MainWindow", "ui");
     // Инициализация бд
-    db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName("task_manager.db");
-
-    if (!db.open()) {
-        QMessageBox::critical(this, translate("Error"), translate("Can't open database: ") + db.lastError().text());
+    if (!repository.open("task_manager.db")) {
+        QMessageBox::critical(this, translate("Error"), translate("Can't open database: ") + repository.lastError());
+        return;
+    }
+    if (!repository.createSchema()) {
+        QMessageBox::critical(this, translate("Error"), translate("Can't open database: ") + repository.lastError());
+        repository.close();
         return;
     }
 
-    executeSQL("CREATE TABLE IF NOT EXISTS Workspaces (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL);");
-    executeSQL("CREATE TABLE IF NOT EXISTS Categories (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL, workspace_id INTEGER, FOREIGN KEY(workspace_id) REFERENCES Workspaces(id));");
-    executeSQL("CREATE TABLE IF NOT EXISTS Tasks (id INTEGER PRIMARY KEY AUTOINCREMENT, description TEXT NOT NULL, category_id INTEGER, difficulty TEXT, priority TEXT, status TEXT, deadline TEXT, FOREIGN KEY(category_id) REFERENCES Categories(id));");
-    executeSQL("CREATE TABLE IF NOT EXISTS TaskTags (id INTEGER PRIMARY KEY AUTOINCREMENT, task_id INTEGER, tag TEXT, FOREIGN KEY(task_id) REFERENCES Tasks(id));");
-    executeSQL("CREATE TABLE IF NOT EXISTS TaskHistory (id INTEGER PRIMARY KEY AUTOINCREMENT, description TEXT NOT NULL, category_id INTEGER, difficulty TEXT, priority TEXT, status TEXT, deadline TEXT, FOREIGN KEY(category_id) REFERENCES Categories(id));");
+    // Группировка записи: клики в пределах окна фиксируются одной транзакцией
+    repository.writeCoordinator().configureFromEnvironment(50);
+    // Пачка, уже показанная в модели, не записалась. Обработка - после возврата в цикл событий,
+    // а не посреди метода, который держит указатели на объекты модели
+    repository.writeCoordinator().setFailureHandler([this](int changes, const QString &error) {
+        QMetaObject::invokeMethod(this, [this, changes, error]() { reloadAfterLostWrites(changes, error); },
+                                  Qt::QueuedConnection);
+    });
+
+    // Полнотекстовый индекс
+    taskSearch.createSchema(repository.database());
+    ModelCache::createSchema(repository.database());
+    changeFeed.createSchema();
+
+    // Рабочие пр-ва в отдельных файлах (TASK_MANAGER_WORKSPACE_FILES): поиск по их задачам
+    repository.workspaceStorage().configureFromEnvironment();
+    repository.workspaceStorage().setAttachHook([this](const QString &schema) {
+        taskSearch.attachSchema(schema);
+    });
+    taskSearch.setWorkspaceStorage(&repository.workspaceStorage());
 
     // Кнопки для темы
     themeButton = new QPushButton(translate("Темная тема"), this);
+    themeButton->setObjectName("themeButton");
     connect(themeButton, &QPushButton::clicked, this, &MainWindow::toggleTheme);
 
-    loadWorkspaces();
-    loadCategories();
-    loadTasks();
-    loadTaskHistory();
+    // Старая история в архивный файл (TASK_MANAGER_HISTORY_RETENTION_DAYS) до загрузки модели
+    historyArchive.configureFromEnvironment();
+    archiveOldHistory();
+
+    loadModel();
+
+    // Резервное копирование (по расписанию - TASK_MANAGER_BACKUP_INTERVAL)
+    backupManager = new BackupManager(this);
+    backupManager->setDatabasePath(repository.database().databaseName());
+    backupManager->configureFromEnvironment();
+
+    // Изменения бд другими процессами (TASK_MANAGER_SYNC_INTERVAL_MS, 0 - выключено)
+    changeFeed.configureFromEnvironment();
+    syncTimer = new QTimer(this);
+    connect(syncTimer, &QTimer::timeout, this, &MainWindow::syncExternalChanges);
+    if (changeFeed.interval() > 0) syncTimer->start(changeFeed.interval());
+
+    // Удаленные пр-ва и категории вычищаются порциями в фоне (TASK_MANAGER_PURGE_BATCH)
+    purger = new TombstonePurger(repository, this);
+    purger->configureFromEnvironment();
 
     setupUI();
     updateUI();
+
+    // Очистка, прерванная прошлым выходом
+    purger->start();
+}
+
+// Загрузка модели из бд и построение индексов
+void MainWindow::loadModel()
+{
+    const QString databasePath = repository.database().databaseName();
+
+    // Снимок с прошлого выхода; если бд с тех пор менялась - параллельная загрузка, при ошибке - последовательная
+    const bool cached = ModelCache::load(ModelCache::cachePath(databasePath), repository.database(), workspaces,
+                                         taskHistory, isEnglish);
+    if (!cached && !ParallelModelLoader::load(databasePath, workspaces, taskHistory, isEnglish)) {
+        repository.loadWorkspaces(workspaces);
+        repository.loadCategories(workspaces);
+        repository.loadTasks(workspaces);
+        repository.loadTaskHistory(taskHistory, isEnglish);
+    }
+    // Снимок одноразовый: следующий пишется при выходе
+    ModelCache::invalidate(repository.database());
+
+    snapshots.publishAll(workspaces);
+    rebuildLookupIndex();
+    rebuildTagIndex();
+
+    // Журнал изменений - от загруженного состояния
+    changeFeed.reset();
 }
 
 MainWindow::~MainWindow()
 {
+    // Снимок модели для быстрого следующего запуска (после записи всех изменений)
+    if (repository.database().isOpen() && repository.flush()) {
+        ModelCache::save(ModelCache::cachePath(repository.database().databaseName()), repository.database(),
+                         workspaces, taskHistory);
+    }
     qDeleteAll(workspaces);
-    db.close();
+    repository.close();
+}
+
+// Задачи рабочего пр-ва из отдельного файла загружаются при первом открытии
+void MainWindow::loadWorkspaceFile(Workspace *workspace)
+{
+    if (!repository.workspaceStorage().isSplitWorkspace(workspace->getId()) ||
+        loadedWorkspaceFiles.contains(workspace->getId())) {
+        return;
+    }
+
+    try {
+        repository.loadWorkspaceTasks(workspace);
+    } catch (const std::exception &e) {
+        qCWarning(lcDb) << "Error loading workspace file:" << e.what();
+        QMessageBox::critical(this, translate("Ошибка"),
+                              translate("Не удалось загрузить рабочее пространство: ") + QString::fromStdString(e.what()));
+        return;
+    }
+    loadedWorkspaceFiles.insert(workspace->getId());
+
+    for (Category *category : workspace->getCategories()) {
+        for (Task *task : category->getTasks()) {
+            lookupIndex.insert(TrigramIndex::TaskDescription, task->getDescription());
+            for (const QString &tag : task->getTags()) {
+                tagIndex.add(tag);
+            }
+        }
+    }
+    snapshots.publish(workspaces, workspace->getName());
+}
+
+// Текущий опубликованный снимок модели
+ModelSnapshotPtr MainWindow::currentSnapshot() const
+{
+    return snapshots.current();
 }
 
 // Весь перевод
@@ -178,6 +307,106 @@ QString MainWindow::translate(const QString& text) const {
         {"Категория", "Category"},
         {"Закрыть", "Close"},
 
+        // Фильтр задач
+        {"Фильтр задач", "Filter Tasks"},
+        {"Любой", "Any"},
+        {"Статус:", "Status:"},
+        {"Тэги:", "Tags:"},
+        {"Текст:", "Text:"},
+        {"Срок с/по:", "Deadline from/to:"},
+        {"Применить", "Apply"},
+        {"Найдено задач: %1 (%2 мс)", "Tasks found: %1 (%2 ms)"},
+
+        // Полнотекстовый поиск
+        {"Поиск", "Search"},
+        {"Поиск задач", "Search Tasks"},
+        {"Введите текст для поиска", "Type to search"},
+        {"в истории", "in history"},
+
+        // Нечеткий поиск
+        {"Быстрый переход...", "Quick switch..."},
+        {"Возможно, вы имели в виду \"%1\"?", "Did you mean \"%1\"?"},
+
+        // Профиль sql (скрытый диалог, Ctrl+Shift+D)
+        {"Диагностика SQL", "SQL Diagnostics"},
+        {"Запрос", "Statement"},
+        {"Выполнений", "Count"},
+        {"Строк", "Rows"},
+        {"Всего, мс", "Total, ms"},
+        {"Среднее, мкс", "Mean, µs"},
+        {"p95, мкс", "p95, µs"},
+        {"Макс, мкс", "Max, µs"},
+        {"мкс", "µs"},
+        {"Обновить", "Refresh"},
+        {"Сбросить", "Reset"},
+        {"Сохранить...", "Save..."},
+        {"Не удалось сохранить отчет", "Can't save the report"},
+
+        // Отчет о памяти (скрытый диалог, Ctrl+Shift+M)
+        {"Память", "Memory"},
+        {"Структура", "Structure"},
+        {"Объектов", "Objects"},
+        {"Байт", "Bytes"},
+        {"Виджеты категорий", "Category widgets"},
+        {"Все виджеты", "All widgets"},
+        {"Резидентная память: %1 КБ", "Resident memory: %1 KB"},
+        {"operator new: %1 КБ в %2 блоках (пик %3 КБ, всего выделений %4)",
+         "operator new: %1 KB in %2 blocks (peak %3 KB, %4 allocations total)"},
+        {"Счетчик operator new выключен в этой сборке", "operator new counting is disabled in this build"},
+
+        // Импорт задач
+        {"Импорт задач", "Import Tasks"},
+        {"Импорт задач...", "Importing tasks..."},
+        {"Задачи (*.csv *.jsonl *.ndjson *.json)", "Tasks (*.csv *.jsonl *.ndjson *.json)"},
+        {"Не удалось открыть файл", "Can't open the file"},
+        {"Не удалось импортировать задачи: ", "Failed to import tasks: "},
+        {"Импортировано задач: %1 (новых пространств: %2, категорий: %3), пропущено строк: %4",
+         "Imported tasks: %1 (new workspaces: %2, categories: %3), skipped lines: %4"},
+        {"Импорт прерван, сохранены уже записанные порции.", "Import cancelled, chunks already written are kept."},
+
+        // Экспорт задач
+        {"Экспорт задач", "Export Tasks"},
+        {"Экспорт: %1", "Exporting: %1"},
+        {"Что экспортировать:", "What to export:"},
+        {"Вся база данных (с историей)", "Entire database (with history)"},
+        {"Экспортировано строк: %1", "Exported rows: %1"},
+        {"Экспорт прерван", "Export cancelled"},
+        {"Не удалось экспортировать задачи: ", "Failed to export tasks: "},
+
+        // Резервные копии
+        {"Резервные копии", "Backups"},
+        {"Создать копию", "Back Up Now"},
+        {"Восстановить", "Restore"},
+        {"Копировать автоматически каждые (мин, 0 - выкл.):", "Back up automatically every (min, 0 - off):"},
+        {"Хранить копий:", "Keep backups:"},
+        {"Копия создана: %1", "Backup created: %1"},
+        {"Копирование прервано", "Backup cancelled"},
+        {"Не удалось создать копию: ", "Backup failed: "},
+        {"Заменить текущую базу данных копией %1? Текущий файл будет сохранен как .before-restore.",
+         "Replace the current database with backup %1? The current file will be kept as .before-restore."},
+        {"Дождитесь окончания копирования", "Wait for the backup to finish"},
+        {"Не удалось восстановить копию: ", "Restore failed: "},
+
+        // Рабочие пр-ва в отдельных файлах
+        {"Не удалось загрузить рабочее пространство: ", "Failed to load workspace: "},
+
+        // Архив истории
+        {"Архив", "Archive"},
+        {"Архив истории", "History Archive"},
+        {"Записей в архиве: ", "Archived entries: "},
+        {"Дата завершения", "Completed at"},
+
+        // Отмена действий
+        {"Отменить", "Undo"},
+        {"Повторить", "Redo"},
+        {"Не удалось отменить действие: ", "Undo failed: "},
+        {"Не удалось повторить действие: ", "Redo failed: "},
+        {"Последние изменения не сохранены (%1), данные перечитаны из базы: ",
+         "Recent changes were not saved (%1), data reloaded from the database: "},
+
+        // Фоновая очистка
+        {"Очистка удаленного: осталось задач %1", "Purging deleted items: %1 tasks left"},
+
         // Кнопки смены темы
         {"Темная тема", "Dark Theme"},
         {"Светлая тема", "Light Theme"}
@@ -213,8 +442,25 @@ void MainWindow::setupUI()
     sidebar->setFrameShape(QFrame::NoFrame);
     sidebar->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
 
+    // Быстрый переход к рабочему пр-ву (нечеткий поиск по имени)
+    quickSwitcher = new QLineEdit(this);
+    quickSwitcher->setPlaceholderText(translate("Быстрый переход..."));
+    quickSwitcher->setClearButtonEnabled(true);
+    attachSuggestions(quickSwitcher, TrigramIndex::WorkspaceName);
+    connect(quickSwitcher, &QLineEdit::returnPressed, this, [this]() {
+        QString workspaceName = quickSwitcher->text().trimmed();
+        if (!workspaces.contains(workspaceName)) {
+            workspaceName = lookupIndex.bestMatch(TrigramIndex::WorkspaceName, workspaceName);
+        }
+        if (workspaces.contains(workspaceName)) {
+            quickSwitcher->clear();
+            showCategories(workspaceName);
+        }
+    });
+
     sidebarLayout->addWidget(toggleSidebarButton);
     sidebarLayout->addWidget(addWorkspaceButton);
+    sidebarLayout->addWidget(quickSwitcher);
     toggleSidebarButton->raise(); // Кнопка поверх других виджетов
 
     // Рабочие пространства
@@ -258,19 +504,88 @@ void MainWindow::setupUI()
     connect(notificationsButton, &QPushButton::clicked, this, &MainWindow::showNotifications);
 
     languageButton = new QPushButton(translate("English"), this);
+    languageButton->setObjectName("languageButton");
     connect(languageButton, &QPushButton::clicked, this, &MainWindow::toggleLanguage);
 
     searchByTagsButton = new QPushButton(translate("Поиск по тегам"), this);
     connect(searchByTagsButton, &QPushButton::clicked, this, &MainWindow::searchTasksByTags);
 
+    searchButton = new QPushButton(translate("Поиск"), this);
+    connect(searchButton, &QPushButton::clicked, this, &MainWindow::showTaskSearch);
+
+    filterTasksButton = new QPushButton(translate("Фильтр задач"), this);
+    connect(filterTasksButton, &QPushButton::clicked, this, &MainWindow::showTaskFilter);
+
+    importButton = new QPushButton(translate("Импорт задач"), this);
+    importButton->setObjectName("importButton");
+    connect(importButton, &QPushButton::clicked, this, &MainWindow::importTasks);
+
+    exportButton = new QPushButton(translate("Экспорт задач"), this);
+    exportButton->setObjectName("exportButton");
+    connect(exportButton, &QPushButton::clicked, this, &MainWindow::exportTasks);
+
+    backupButton = new QPushButton(translate("Резервные копии"), this);
+    backupButton->setObjectName("backupButton");
+    connect(backupButton, &QPushButton::clicked, this, &MainWindow::showBackups);
+
+    // Отмена и повтор (Ctrl+Z / Ctrl+Y)
+    undoButton = new QPushButton(translate("Отменить"), this);
+    connect(undoButton, &QPushButton::clicked, this, &MainWindow::undo);
+    redoButton = new QPushButton(translate("Повторить"), this);
+    connect(redoButton, &QPushButton::clicked, this, &MainWindow::redo);
+    QShortcut *undoShortcut = new QShortcut(QKeySequence::Undo, this);
+    connect(undoShortcut, &QShortcut::activated, this, &MainWindow::undo);
+    QShortcut *redoShortcut = new QShortcut(QKeySequence::Redo, this);
+    connect(redoShortcut, &QShortcut::activated, this, &MainWindow::redo);
+    updateUndoButtons();
+
+    exporter = new TaskExporter(this);
+    connect(exporter, &TaskExporter::progress, this, [this](qint64 rows) {
+        exportButton->setText(translate("Экспорт: %1").arg(rows));
+    });
+    connect(exporter, &TaskExporter::finished, this, [this](bool ok, qint64 rows, const QString &error) {
+        exportButton->setText(translate("Экспорт задач"));
+        if (ok) {
+            QMessageBox::information(this, translate("Экспорт задач"), translate("Экспортировано строк: %1").arg(rows));
+        } else if (error.isEmpty()) {
+            QMessageBox::information(this, translate("Экспорт задач"), translate("Экспорт прерван"));
+        } else {
+            QMessageBox::critical(this, translate("Ошибка"), translate("Не удалось экспортировать задачи: ") + error);
+        }
+    });
+
     rightSidebarLayout->addWidget(themeButton);
     applyTheme(false);
 
+    rightSidebarLayout->addWidget(undoButton);
+    rightSidebarLayout->addWidget(redoButton);
     rightSidebarLayout->addWidget(historyButton);
     rightSidebarLayout->addWidget(notificationsButton);
     rightSidebarLayout->addWidget(languageButton);
     rightSidebarLayout->addWidget(searchByTagsButton);
+    rightSidebarLayout->addWidget(filterTasksButton);
+    rightSidebarLayout->addWidget(searchButton);
+    rightSidebarLayout->addWidget(importButton);
+    rightSidebarLayout->addWidget(exportButton);
+    rightSidebarLayout->addWidget(backupButton);
+
+    // Ход фоновой очистки (виден, пока она идет)
+    purgeLabel = new QLabel(this);
+    purgeLabel->hide();
+    connect(purger, &TombstonePurger::progress, this, [this](qint64, qint64 remaining) {
+        purgeLabel->setText(translate("Очистка удаленного: осталось задач %1").arg(remaining));
+        purgeLabel->show();
+    });
+    connect(purger, &TombstonePurger::finished, purgeLabel, &QLabel::hide);
+    rightSidebarLayout->addWidget(purgeLabel);
+
+    // Скрытый диалог профиля sql
+    QShortcut *diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &MainWindow::showSqlDiagnostics);
 
+    // Скрытый отчет о памяти
+    QShortcut *memoryShortcut = new QShortcut(QKeySequence("Ctrl+Shift+M"), this);
+    connect(memoryShortcut, &QShortcut::activated, this, &MainWindow::showMemoryReport);
 
     // Основной слой
     QHBoxLayout *contentLayout = new QHBoxLayout();
@@ -286,153 +601,13 @@ void MainWindow::setupUI()
 
 }
 
-// Загрузка Workspaces из бд
-void MainWindow::loadWorkspaces()
-{
-    QSqlQuery query("SELECT id, name FROM Workspaces;");
-    while (query.next()) {
-        int id = query.value(0).toInt();
-        QString name = query.value(1).toString();
-
-        qDebug() << "Loading workspace - ID:" << id << "Name:" << name;
-
-        if (id == 0) {
-            qDebug() << "Warning: Workspace with ID 0 found! This should not happen.";
-            continue;
-        }
-
-        workspaces[name] = new Workspace(id, name);
-    }
-}
-
-// Загрузка Categories из бд
-void MainWindow::loadCategories()
-{
-    QSqlQuery query("SELECT id, name, workspace_id FROM Categories;");
-    while (query.next()) {
-        int id = query.value(0).toInt();
-        QString name = query.value(1).toString();
-        int workspaceId = query.value(2).toInt();
-
-        qDebug() << "Loading category - ID:" << id << "Name:" << name
-                 << "Workspace ID:" << workspaceId;
-
-        bool categoryAdded = false;
-        for (auto it = workspaces.begin(); it != workspaces.end(); ++it) {
-            if (it.value()->getId() == workspaceId) {
-                it.value()->addCategory(id, name);
-                categoryAdded = true;
-                qDebug() << "Added category to workspace:" << it.key()
-                         << "with ID:" << id;
-                break;
-            }
-        }
-
-        if (!categoryAdded) {
-            qDebug() << "Category" << name << "with ID" << id
-                     << "has no matching workspace (Workspace ID:" << workspaceId << ")";
-        }
-    }
-}
-
-// Загрузка тасков из бд
-void MainWindow::loadTasks()
-{
-    QSqlQuery query("SELECT id, description, category_id, difficulty, priority, status, deadline FROM Tasks;");
-    while (query.next()) {
-        int id = query.value(0).toInt();
-        QString description = query.value(1).toString();
-        int categoryId = query.value(2).toInt();
-        QString difficulty = query.value(3).toString();
-        QString priority = query.value(4).toString();
-        QString status = query.value(5).toString();
-        QString deadline = query.value(6).toString();
-
-        qDebug() << "Loading task ID:" << id << "Description:" << description
-                 << "Category ID:" << categoryId;
-
-        // Теги
-        QStringList tags;
-        QSqlQuery tagQuery;
-        tagQuery.prepare("SELECT tag FROM TaskTags WHERE task_id = :task_id");
-        tagQuery.bindValue(":task_id", id);
-
-        if (tagQuery.exec()) {
-            while (tagQuery.next()) {
-                tags.append(tagQuery.value(0).toString());
-            }
-            qDebug() << "Tags for task" << id << ":" << tags;
-        } else {
-            qDebug() << "Error loading tags for task" << id << ":" << tagQuery.lastError().text();
-        }
-
-        // Поиск категории
-        bool taskLoaded = false;
-        for (auto workspaceIt = workspaces.begin(); workspaceIt != workspaces.end() && !taskLoaded; ++workspaceIt) {
-            Workspace* workspace = workspaceIt.value();
-            QMap<QString, Category*>& categories = workspace->getCategories();
-
-            for (auto categoryIt = categories.begin(); categoryIt != categories.end() && !taskLoaded; ++categoryIt) {
-                Category* category = categoryIt.value();
-
-                if (category->getId() == categoryId) {
-                    Task* task = new Task(id, description, category->getName(), tags,
-                                          difficulty, priority, status, deadline);
-                    category->addTask(task);
-                    taskLoaded = true;
-
-                    qDebug() << "Successfully loaded task into workspace:" << workspace->getName()
-                             << "category:" << category->getName()
-                             << "task ID:" << id;
-                }
-            }
-        }
-
-        if (!taskLoaded) {
-            qDebug() << "Failed to load task - category ID" << categoryId << "not found for task ID:" << id;
-        }
-    }
-}
-
-// Загрузка истории из бд
-void MainWindow::loadTaskHistory() {
-    QSqlQuery query("SELECT id, description, category_id, difficulty, priority, status, deadline FROM TaskHistory;");
-    while (query.next()) {
-        int id = query.value(0).toInt();
-        QString description = query.value(1).toString();
-        int categoryId = query.value(2).toInt();
-        QString difficulty = query.value(3).toString();
-        QString priority = query.value(4).toString();
-        QString status = query.value(5).toString();
-        QString deadline = query.value(6).toString();
-
-        // Приведение статуса к текущему языку
-        if (isEnglish && status == "Завершено") {
-            status = "Completed";
-        } else if (!isEnglish && status == "Completed") {
-            status = "Завершено";
-        }
-
-        Task task(id, description, "", QStringList(), difficulty, priority, status, deadline);
-        taskHistory.append(task);
-    }
-}
-
-// Выполнение sql запроса
-void MainWindow::executeSQL(const QString& sql)
-{
-    QSqlQuery query;
-    if (!query.exec(sql)) {
-        qDebug() << "SQL error:" << query.lastError().text();
-    }
-}
-
 // Отображение Workspaces
 void MainWindow::showWorkspaces()
 {
-    // Очищение предыдущих элементов (кроме первых 2х - меню & добавления)
-    while (sidebarLayout->count() > 2) {
-        QLayoutItem* item = sidebarLayout->takeAt(2);
+    TRACE_SCOPE("MainWindow::showWorkspaces", "ui");
+    // Очищение предыдущих элементов (кроме первых 3х - меню, добавление & быстрый переход)
+    while (sidebarLayout->count() > 3) {
+        QLayoutItem* item = sidebarLayout->takeAt(3);
         if (item->widget()) {
             delete item->widget();
         }
@@ -448,6 +623,7 @@ void MainWindow::showWorkspaces()
 
         // Кнопка выбора рабочего пр-ва
         QPushButton* workspaceBtn = new QPushButton(workspaceIt.key(), workspaceWidget);
+        workspaceBtn->setObjectName("workspaceButton");
         workspaceBtn->setProperty("workspaceName", workspaceIt.key());
         workspaceBtn->setMinimumWidth(160);
         workspaceBtn->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Fixed);
@@ -470,6 +646,7 @@ void MainWindow::showWorkspaces()
 
 // Отображение категорий
 void MainWindow::showCategories(const QString& workspaceName) {
+    TRACE_SCOPE_DETAIL("MainWindow::showCategories", "ui", workspaceName);
     currentWorkspaceLabel->setText(translate("Рабочее пространство: %1").arg(workspaceName));
     addCategoryButton->setEnabled(true);
 
@@ -483,6 +660,7 @@ void MainWindow::showCategories(const QString& workspaceName) {
     if (!workspaces.contains(workspaceName)) return;
 
     Workspace *workspace = workspaces[workspaceName];
+    loadWorkspaceFile(workspace);
     for (auto it = workspace->getCategories().begin(); it != workspace->getCategories().end(); ++it) {
         QGroupBox *group = new QGroupBox(it.key(), categoriesContent);
         QVBoxLayout *layout = new QVBoxLayout(group);
@@ -568,6 +746,7 @@ void MainWindow::showCategories(const QString& workspaceName) {
             actionsLayout->setSpacing(5);
 
             QPushButton *pendingBtn = new QPushButton(actions);
+            pendingBtn->setObjectName("pendingButton");
             pendingBtn->setIcon(QIcon(":/icons/pending.png"));
             pendingBtn->setToolTip(translate("В ожидании"));
             pendingBtn->setProperty("workspaceName", workspaceName);
@@ -579,6 +758,7 @@ void MainWindow::showCategories(const QString& workspaceName) {
             });
 
             QPushButton *progressBtn = new QPushButton(actions);
+            progressBtn->setObjectName("progressButton");
             progressBtn->setIcon(QIcon(":/icons/inprogress.png"));
             progressBtn->setToolTip(translate("В процессе"));
             progressBtn->setProperty("workspaceName", workspaceName);
@@ -590,6 +770,7 @@ void MainWindow::showCategories(const QString& workspaceName) {
             });
 
             QPushButton *completeBtn = new QPushButton(actions);
+            completeBtn->setObjectName("completeButton");
             completeBtn->setIcon(QIcon(":/icons/completed.png"));
             completeBtn->setToolTip(translate("Завершено"));
             completeBtn->setProperty("workspaceName", workspaceName);
@@ -662,32 +843,30 @@ void MainWindow::addWorkspace()
     QString workspaceName = QInputDialog::getText(this, translate("Добавить рабочее пространство"),
                                                   translate("Имя рабочего пространства:"), QLineEdit::Normal, "", &ok);
     if (ok && !workspaceName.isEmpty()) {
-        db.transaction();
         try {
             // Вставка в бд
-            QSqlQuery query;
-            query.prepare("INSERT INTO Workspaces (name) VALUES (:name)");
-            query.bindValue(":name", workspaceName);
-
-            if (!query.exec()) {
-                throw std::runtime_error(query.lastError().text().toStdString());
+            if (!repository.transaction()) {
+                throw std::runtime_error(repository.lastError().toStdString());
+            }
+            int workspaceId = repository.insertWorkspace(workspaceName);
+            qCDebug(lcModel) << "Inserted workspace ID:" << workspaceId;
+            if (!repository.commit()) {
+                throw std::runtime_error(repository.lastError().toStdString());
             }
-
-            int workspaceId = query.lastInsertId().toInt();
-            qDebug() << "Inserted workspace ID:" << workspaceId;
 
             workspaces[workspaceName] = new Workspace(workspaceId, workspaceName);
-            db.commit();
+            snapshots.publish(workspaces, workspaceName);
+            lookupIndex.insert(TrigramIndex::WorkspaceName, workspaceName);
 
-            qDebug() << "Successfully added workspace:" << workspaceName
-                     << "with ID:" << workspaceId;
+            qCDebug(lcModel) << "Successfully added workspace:" << workspaceName
+                             << "with ID:" << workspaceId;
 
             showWorkspaces();
         } catch (const std::exception& e) {
-            db.rollback();
+            repository.rollback();
             QMessageBox::critical(this, translate("Ошибка"),
                                   translate("Не удалось создать рабочее пространство: ") + QString::fromStdString(e.what()));
-            qDebug() << "Error adding workspace:" << e.what();
+            qCWarning(lcDb) << "Error adding workspace:" << e.what();
         }
     }
 }
@@ -713,52 +892,35 @@ void MainWindow::removeWorkspace()
     // Удаление из бд
     int workspaceId = workspace->getId();
 
-    db.transaction();
     try {
-        // Удаление всех задач + тегов
-        QSqlQuery deleteTasksQuery;
-        deleteTasksQuery.prepare(
-            "DELETE FROM Tasks WHERE id IN ("
-            "SELECT t.id FROM Tasks t "
-            "JOIN Categories c ON t.category_id = c.id "
-            "WHERE c.workspace_id = :workspace_id"
-            ")"
-            );
-        deleteTasksQuery.bindValue(":workspace_id", workspaceId);
-        if (!deleteTasksQuery.exec()) {
-            throw std::runtime_error(deleteTasksQuery.lastError().text().toStdString());
+        // Пометка пр-ва и категорий; задачи и сами строки удаляются в фоне
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
-
-        // Удаление всех категорий
-        QSqlQuery deleteCategoriesQuery;
-        deleteCategoriesQuery.prepare("DELETE FROM Categories WHERE workspace_id = :workspace_id");
-        deleteCategoriesQuery.bindValue(":workspace_id", workspaceId);
-        if (!deleteCategoriesQuery.exec()) {
-            throw std::runtime_error(deleteCategoriesQuery.lastError().text().toStdString());
-        }
-
-        // Удаление workspace
-        QSqlQuery deleteWorkspaceQuery;
-        deleteWorkspaceQuery.prepare("DELETE FROM Workspaces WHERE id = :workspace_id");
-        deleteWorkspaceQuery.bindValue(":workspace_id", workspaceId);
-        if (!deleteWorkspaceQuery.exec()) {
-            throw std::runtime_error(deleteWorkspaceQuery.lastError().text().toStdString());
+        repository.markWorkspaceDeleted(workspaceId);
+        if (!repository.commit()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
+        purger->start();
 
-        db.commit();
+        // Удаление пр-ва не отменяется, а команды стека могли ссылаться на его строки
+        undoStack.clear();
+        updateUndoButtons();
 
+        unindexWorkspace(workspace);
         delete workspace;
         workspaces.remove(workspaceName);
+        snapshots.publish(workspaces, workspaceName);
         showWorkspaces();
 
         updateUI();
 
-        qDebug() << "Workspace deleted successfully. ID:" << workspaceId;
+        qCDebug(lcModel) << "Workspace deleted successfully. ID:" << workspaceId;
     } catch (const std::exception &e) {
-        db.rollback();
+        repository.rollback();
         QMessageBox::critical(this, translate("Ошибка"),
                               translate("Не удалось удалить рабочее пространство: ") + QString::fromStdString(e.what()));
-        qDebug() << "Error deleting workspace:" << e.what();
+        qCWarning(lcDb) << "Error deleting workspace:" << e.what();
     }
 }
 
@@ -780,13 +942,13 @@ void MainWindow::workspaceSelected() {
 // Добавление категории
 void MainWindow::addCategory()
 {
-    qDebug() << "Starting addCategory method";
+    qCDebug(lcModel) << "Starting addCategory method";
 
     QString currentText = currentWorkspaceLabel->text();
     QString workspaceName = currentText.replace(translate("Рабочее пространство: "), "").replace(tr("Workspace: "), "");
 
     if (!workspaces.contains(workspaceName)) {
-        qDebug() << "Workspace not found:" << workspaceName;
+        qCDebug(lcModel) << "Workspace not found:" << workspaceName;
         return;
     }
 
@@ -795,35 +957,40 @@ void MainWindow::addCategory()
     QString categoryName = QInputDialog::getText(this, translate("Добавить категорию"),
                                                  translate("Имя категории:"), QLineEdit::Normal, "", &ok);
     if (ok && !categoryName.isEmpty()) {
-        // Вставка в бд
-        db.transaction();
-
         try {
-            QSqlQuery query;
-            query.prepare("INSERT INTO Categories (name, workspace_id) VALUES (:name, :workspace_id)");
-            query.bindValue(":name", categoryName);
-            query.bindValue(":workspace_id", workspaces[workspaceName]->getId());
-
-            if (!query.exec()) {
-                throw std::runtime_error(query.lastError().text().toStdString());
+            // Вставка в бд
+            if (!repository.transaction()) {
+                throw std::runtime_error(repository.lastError().toStdString());
+            }
+            int categoryId = repository.insertCategory(categoryName, workspaces[workspaceName]->getId());
+            qCDebug(lcModel) << "Inserted category ID:" << categoryId;
+            if (!repository.commit()) {
+                throw std::runtime_error(repository.lastError().toStdString());
             }
-
-            int categoryId = query.lastInsertId().toInt();
-            qDebug() << "Inserted category ID:" << categoryId;
 
             workspaces[workspaceName]->addCategory(categoryId, categoryName);
+            lookupIndex.insert(TrigramIndex::CategoryName, categoryName);
+            snapshots.publish(workspaces, workspaceName, categoryName);
+
+            UndoStack::Command command;
+            command.kind = UndoStack::Command::AddCategory;
+            command.label = translate("Добавить категорию") + ": " + categoryName;
+            command.workspaceId = workspaces[workspaceName]->getId();
+            command.categoryId = categoryId;
+            command.name = categoryName;
+            undoStack.push(command);
+            updateUndoButtons();
 
-            db.commit();
             showCategories(workspaceName);
 
-            qDebug() << "Successfully added category:" << categoryName
-                     << "with ID:" << categoryId
-                     << "to workspace:" << workspaceName;
+            qCDebug(lcModel) << "Successfully added category:" << categoryName
+                             << "with ID:" << categoryId
+                             << "to workspace:" << workspaceName;
         } catch (const std::exception& e) {
-            db.rollback();
+            repository.rollback();
             QMessageBox::critical(this, translate("Ошибка"),
                                   translate("Не удалось создать категорию: ") + QString::fromStdString(e.what()));
-            qDebug() << "Error adding category:" << e.what();
+            qCWarning(lcDb) << "Error adding category:" << e.what();
         }
     }
 }
@@ -870,41 +1037,48 @@ void MainWindow::removeCategory()
     Category *category = workspace->getCategories()[categoryName];
     int categoryId = category->getId();
 
-    db.transaction();
     try {
-        // Удаление всех здач + тегов
-        QSqlQuery deleteTasksQuery;
-        deleteTasksQuery.prepare(
-            "DELETE FROM Tasks WHERE id IN ("
-            "SELECT t.id FROM Tasks t "
-            "WHERE t.category_id = :category_id"
-            ")"
-            );
-        deleteTasksQuery.bindValue(":category_id", categoryId);
-        if (!deleteTasksQuery.exec()) {
-            throw std::runtime_error(deleteTasksQuery.lastError().text().toStdString());
+        // Пометка категории; задачи удаляются в фоне
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
-
-        // Удаление категории
-        QSqlQuery deleteCategoryQuery;
-        deleteCategoryQuery.prepare("DELETE FROM Categories WHERE id = :category_id");
-        deleteCategoryQuery.bindValue(":category_id", categoryId);
-        if (!deleteCategoryQuery.exec()) {
-            throw std::runtime_error(deleteCategoryQuery.lastError().text().toStdString());
+        repository.markCategoryDeleted(categoryId);
+        if (!repository.commit()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
-
-        db.commit();
+        purger->start();
+
+        // Для отмены - категория и ее задачи
+        UndoStack::Command command;
+        command.kind = UndoStack::Command::RemoveCategory;
+        command.label = translate("Удалить категорию") + ": " + categoryName;
+        command.workspaceId = workspace->getId();
+        command.categoryId = categoryId;
+        command.name = categoryName;
+        for (const Task *task : category->getTasks()) {
+            command.tasks.append(UndoStack::taskRow(*task, categoryId));
+        }
+        undoStack.push(command);
+        updateUndoButtons();
 
         // Удаление из памяти
+        lookupIndex.remove(TrigramIndex::CategoryName, categoryName);
+        for (Task *task : category->getTasks()) {
+            lookupIndex.remove(TrigramIndex::TaskDescription, task->getDescription());
+            for (const QString &tag : task->getTags()) {
+                tagIndex.remove(tag);
+            }
+        }
         workspace->removeCategory(categoryName);
+        snapshots.publish(workspaces, workspaceName, categoryName);
         showCategories(workspaceName);
 
-        qDebug() << "Category deleted successfully. ID:" << categoryId;
+        qCDebug(lcModel) << "Category deleted successfully. ID:" << categoryId;
     } catch (const std::exception &e) {
-        db.rollback();
+        repository.rollback();
         QMessageBox::critical(this, translate("Ошибка"),
                               translate("Не удалось удалить категорию: ") + QString::fromStdString(e.what()));
-        qDebug() << "Error deleting category:" << e.what();
+        qCWarning(lcDb) << "Error deleting category:" << e.what();
     }
 }
 
@@ -920,7 +1094,7 @@ void MainWindow::addTask()
     // Проверка на сущ
     if (!workspaces.contains(workspaceName) ||
         !workspaces[workspaceName]->getCategories().contains(categoryName)) {
-        qDebug() << "Workspace or category not found:" << workspaceName << categoryName;
+        qCDebug(lcModel) << "Workspace or category not found:" << workspaceName << categoryName;
         return;
     }
 
@@ -933,6 +1107,7 @@ void MainWindow::addTask()
     // Поля ввода
     QLineEdit *descriptionEdit = new QLineEdit(&dialog);
     QLineEdit *tagsEdit = new QLineEdit(&dialog);
+    new TagCompleter(&tagIndex, tagsEdit);
 
     QComboBox *difficultyCombo = new QComboBox(&dialog);
     difficultyCombo->addItems(QStringList()
@@ -978,69 +1153,59 @@ void MainWindow::addTask()
             return;
         }
 
-        // Теги (обработка)
-        QStringList tagList = tags.split(',', Qt::SkipEmptyParts);
-        for (QString &tag : tagList) {
-            tag = tag.trimmed();
+        // Теги (обработка): существующее написание тега вместо почти-дубликата
+        QStringList tagList;
+        for (const QString &tag : tags.split(',', Qt::SkipEmptyParts)) {
+            QString canonicalTag = tagIndex.canonical(tag);
+            if (!canonicalTag.isEmpty() && !tagList.contains(canonicalTag, Qt::CaseInsensitive)) {
+                tagList.append(canonicalTag);
+            }
         }
 
         Category *category = workspaces[workspaceName]->getCategories()[categoryName];
 
-        db.transaction();
         try {
             // Статус в зависимости от текущего языка
             QString status = isEnglish ? "Pending" : "В ожидании";
 
-            // Вставление задачи
-            QSqlQuery taskQuery;
-            taskQuery.prepare(
-                "INSERT INTO Tasks (description, category_id, difficulty, priority, status, deadline) "
-                "VALUES (:description, :category_id, :difficulty, :priority, :status, :deadline)"
-                );
-            taskQuery.bindValue(":description", description);
-            taskQuery.bindValue(":category_id", category->getId());
-            taskQuery.bindValue(":difficulty", difficulty);
-            taskQuery.bindValue(":priority", priority);
-            taskQuery.bindValue(":status", status);
-            taskQuery.bindValue(":deadline", deadline);
-
-            if (!taskQuery.exec()) {
-                throw std::runtime_error(taskQuery.lastError().text().toStdString());
+            // Вставка задачи и тегов
+            if (!repository.transaction()) {
+                throw std::runtime_error(repository.lastError().toStdString());
             }
-
-            // Получение ID
-            int taskId = taskQuery.lastInsertId().toInt();
-            qDebug() << "Inserted task ID:" << taskId;
-
-            // Вставка тегов
-            for (const QString &tag : tagList) {
-                QSqlQuery tagQuery;
-                tagQuery.prepare("INSERT INTO TaskTags (task_id, tag) VALUES (:task_id, :tag)");
-                tagQuery.bindValue(":task_id", taskId);
-                tagQuery.bindValue(":tag", tag);
-
-                if (!tagQuery.exec()) {
-                    throw std::runtime_error(tagQuery.lastError().text().toStdString());
-                }
+            int taskId = repository.insertTask(description, category->getId(), tagList,
+                                               difficulty, priority, status, deadline);
+            qCDebug(lcModel) << "Inserted task ID:" << taskId;
+            if (!repository.commit()) {
+                throw std::runtime_error(repository.lastError().toStdString());
             }
 
-            db.commit();
-
             // Добавление в память
             Task *task = new Task(taskId, description, categoryName, tagList,
                                   difficulty, priority, status, deadline);
             category->addTask(task);
+            snapshots.publish(workspaces, workspaceName, categoryName);
+            lookupIndex.insert(TrigramIndex::TaskDescription, description);
+
+            UndoStack::Command command;
+            command.kind = UndoStack::Command::AddTask;
+            command.label = translate("Создать задачу") + ": " + description;
+            command.tasks.append(UndoStack::taskRow(*task, category->getId()));
+            undoStack.push(command);
+            updateUndoButtons();
+            for (const QString &tag : tagList) {
+                tagIndex.add(tag);
+            }
 
-            qDebug() << "Added task to category:" << categoryName
-                     << "in workspace:" << workspaceName
-                     << "with ID:" << taskId;
+            qCDebug(lcModel) << "Added task to category:" << categoryName
+                             << "in workspace:" << workspaceName
+                             << "with ID:" << taskId;
 
             showCategories(workspaceName);
         } catch (const std::exception &e) {
-            db.rollback();
+            repository.rollback();
             QMessageBox::critical(this, translate("Ошибка"),
                                   translate("Не удалось сохранить задачу: ") + QString::fromStdString(e.what()));
-            qDebug() << "Error adding task:" << e.what();
+            qCWarning(lcDb) << "Error adding task:" << e.what();
         }
     }
 }
@@ -1082,38 +1247,41 @@ void MainWindow::removeTask()
                                   QMessageBox::Yes|QMessageBox::No);
     if (reply != QMessageBox::Yes) return;
 
-    db.transaction();
-
     try {
-        // Удаление тегов
-        QSqlQuery deleteTagsQuery;
-        deleteTagsQuery.prepare("DELETE FROM TaskTags WHERE task_id = :task_id");
-        deleteTagsQuery.bindValue(":task_id", taskToDelete->getId());
-        if (!deleteTagsQuery.exec()) {
-            throw std::runtime_error(deleteTagsQuery.lastError().text().toStdString());
+        // Удаление тегов и таски
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
-
-        // Удаление таски
-        QSqlQuery deleteTaskQuery;
-        deleteTaskQuery.prepare("DELETE FROM Tasks WHERE id = :task_id");
-        deleteTaskQuery.bindValue(":task_id", taskToDelete->getId());
-        if (!deleteTaskQuery.exec()) {
-            throw std::runtime_error(deleteTaskQuery.lastError().text().toStdString());
+        repository.deleteTask(taskToDelete->getId());
+        if (!repository.commit()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
 
-        db.commit();
+        // Для отмены - удаленная строка целиком
+        UndoStack::Command command;
+        command.kind = UndoStack::Command::RemoveTask;
+        command.label = translate("Удалить задачу") + ": " + taskDescription;
+        command.tasks.append(UndoStack::taskRow(*taskToDelete, category->getId()));
+        undoStack.push(command);
+        updateUndoButtons();
 
         // Удаление из памяти
+        int taskId = taskToDelete->getId();
+        lookupIndex.remove(TrigramIndex::TaskDescription, taskToDelete->getDescription());
+        for (const QString &tag : taskToDelete->getTags()) {
+            tagIndex.remove(tag);
+        }
         delete category->getTasks().takeAt(taskIndex);
+        snapshots.publish(workspaces, workspaceName, categoryName);
         showCategories(workspaceName);
 
         // Дебаги
-        qDebug() << "Task deleted successfully. ID:" << taskToDelete->getId();
+        qCDebug(lcModel) << "Task deleted successfully. ID:" << taskId;
     } catch (const std::exception &e) {
-        db.rollback();
+        repository.rollback();
         QMessageBox::critical(this, translate("Ошибка"),
                               translate("Не удалось удалить задачу: ") + QString::fromStdString(e.what()));
-        qDebug() << "Error deleting task:" << e.what();
+        qCWarning(lcDb) << "Error deleting task:" << e.what();
     }
 }
 
@@ -1121,6 +1289,7 @@ void MainWindow::removeTask()
 void MainWindow::changeTaskStatus(const QString& workspaceName, const QString& categoryName,
                                   const QString& taskDescription, const QString& newStatus)
 {
+    TRACE_SCOPE_DETAIL("MainWindow::changeTaskStatus", "ui", newStatus);
     // Проверка на существование рабочего пр-ва
     if (!workspaces.contains(workspaceName)) {
         QMessageBox::warning(this, translate("Ошибка"), translate("Рабочее пространство не найдено"));
@@ -1170,87 +1339,33 @@ void MainWindow::changeTaskStatus(const QString& workspaceName, const QString& c
     bool isCompleting = (newStatus == "Завершено" || newStatus == "Completed") &&
                         (currentStatus != "Завершено" && currentStatus != "Completed");
 
-    db.transaction();
-
     try {
         // Обновление статуса задачи
-        QSqlQuery updateQuery;
-        updateQuery.prepare("UPDATE Tasks SET status = :status WHERE id = :task_id");
-        updateQuery.bindValue(":status", statusToSet);
-        updateQuery.bindValue(":task_id", taskToComplete->getId());
-
-        if (!updateQuery.exec()) {
-            throw std::runtime_error(updateQuery.lastError().text().toStdString());
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
-
-        taskToComplete->setStatus(statusToSet);
+        repository.updateTaskStatus(taskToComplete->getId(), statusToSet);
 
         if (isCompleting) {
 
-            // Вставка задачи в историю
-            QSqlQuery insertHistoryQuery;
-            insertHistoryQuery.prepare(
-                "INSERT INTO TaskHistory (description, category_id, difficulty, priority, status, deadline) "
-                "VALUES (:description, :category_id, :difficulty, :priority, :status, :deadline)"
-                );
-            insertHistoryQuery.bindValue(":description", taskToComplete->getDescription());
-            insertHistoryQuery.bindValue(":category_id", category->getId());
-            insertHistoryQuery.bindValue(":difficulty", taskToComplete->getDifficulty());
-            insertHistoryQuery.bindValue(":priority", taskToComplete->getPriority());
-            insertHistoryQuery.bindValue(":status", isEnglish ? "Completed" : "Завершено");
-            insertHistoryQuery.bindValue(":deadline", taskToComplete->getDeadline());
-
-            if (!insertHistoryQuery.exec()) {
-                throw std::runtime_error(insertHistoryQuery.lastError().text().toStdString());
-            }
-
-            int historyId = insertHistoryQuery.lastInsertId().toInt();
-            qDebug() << "Task moved to history with ID:" << historyId;
-
-            // Копирование всех тегов задачи в историю
-            QSqlQuery getTagsQuery;
-            getTagsQuery.prepare("SELECT tag FROM TaskTags WHERE task_id = :task_id");
-            getTagsQuery.bindValue(":task_id", taskToComplete->getId());
-
-            if (!getTagsQuery.exec()) {
-                throw std::runtime_error(getTagsQuery.lastError().text().toStdString());
-            }
-
+            // Перенос задачи с тегами в историю
             QStringList tags;
-            while (getTagsQuery.next()) {
-                QString tag = getTagsQuery.value(0).toString();
-                tags.append(tag);
-
-                QSqlQuery insertTagQuery;
-                insertTagQuery.prepare("INSERT INTO TaskTags (task_id, tag) VALUES (:task_id, :tag)");
-                insertTagQuery.bindValue(":task_id", historyId);
-                insertTagQuery.bindValue(":tag", tag);
-
-                if (!insertTagQuery.exec()) {
-                    throw std::runtime_error(insertTagQuery.lastError().text().toStdString());
-                }
-                qDebug() << "Tag copied to history:" << tag;
-            }
-
-            // Удаление задачи из активных
-            QSqlQuery deleteTaskQuery;
-            deleteTaskQuery.prepare("DELETE FROM Tasks WHERE id = :task_id");
-            deleteTaskQuery.bindValue(":task_id", taskToComplete->getId());
+            int historyId = repository.moveTaskToHistory(*taskToComplete, category->getId(),
+                                                         isEnglish ? "Completed" : "Завершено", &tags);
 
-            if (!deleteTaskQuery.exec()) {
-                throw std::runtime_error(deleteTaskQuery.lastError().text().toStdString());
+            if (!repository.commit()) {
+                throw std::runtime_error(repository.lastError().toStdString());
             }
+            taskToComplete->setStatus(statusToSet);
 
-            // Удаление тегов задачи
-            QSqlQuery deleteTagsQuery;
-            deleteTagsQuery.prepare("DELETE FROM TaskTags WHERE task_id = :task_id");
-            deleteTagsQuery.bindValue(":task_id", taskToComplete->getId());
-
-            if (!deleteTagsQuery.exec()) {
-                throw std::runtime_error(deleteTagsQuery.lastError().text().toStdString());
-            }
-
-            db.commit();
+            UndoStack::Command command;
+            command.kind = UndoStack::Command::CompleteTask;
+            command.label = translate("Завершено") + ": " + taskToComplete->getDescription();
+            command.before = currentStatus;
+            command.after = isEnglish ? "Completed" : "Завершено";
+            command.historyId = historyId;
+            command.tasks.append(UndoStack::taskRow(*taskToComplete, category->getId()));
+            undoStack.push(command);
 
             // Обновление данных в памяти
             Task historyTask(historyId, taskToComplete->getDescription(),
@@ -1258,25 +1373,45 @@ void MainWindow::changeTaskStatus(const QString& workspaceName, const QString& c
                              taskToComplete->getDifficulty(), taskToComplete->getPriority(),
                              isEnglish ? "Completed" : "Завершено", taskToComplete->getDeadline());
             taskHistory.append(historyTask);
+            lookupIndex.remove(TrigramIndex::TaskDescription, historyTask.getDescription());
+            lookupIndex.insert(TrigramIndex::HistoryDescription, historyTask.getDescription());
 
             // Удаление задачи из категории
+            for (const QString &tag : taskToComplete->getTags()) {
+                tagIndex.remove(tag);
+            }
             delete category->getTasks().takeAt(taskIndex);
 
             QMessageBox::information(this, translate("Задача завершена"),
                                      translate("Задача \"%1\" перемещена в историю").arg(taskDescription));
         } else {
-            db.commit();
+            if (!repository.commit()) {
+                throw std::runtime_error(repository.lastError().toStdString());
+            }
+            taskToComplete->setStatus(statusToSet);
+
+            // Только id и два статуса
+            UndoStack::Command command;
+            command.kind = UndoStack::Command::ChangeStatus;
+            command.label = translate("Статус") + ": " + taskToComplete->getDescription();
+            command.before = currentStatus;
+            command.after = statusToSet;
+            command.tasks.append({taskToComplete->getId(), category->getId()});
+            undoStack.push(command);
+
             QMessageBox::information(this, translate("Статус изменен"),
                                      translate("Статус задачи \"%1\" обновлен").arg(taskDescription));
         }
     } catch (const std::exception &e) {
-        db.rollback();
+        repository.rollback();
         QMessageBox::critical(this, translate("Ошибка"),
                               translate("Не удалось изменить статус задачи: ") + QString::fromStdString(e.what()));
-        qDebug() << "Error changing task status:" << e.what();
+        qCWarning(lcDb) << "Error changing task status:" << e.what();
         return;
     }
 
+    updateUndoButtons();
+    snapshots.publish(workspaces, workspaceName, categoryName);
     showCategories(workspaceName);
 }
 
@@ -1318,11 +1453,13 @@ void MainWindow::showHistory()
     // Кнопки управления
     QPushButton *restoreButton = new QPushButton(translate("Восстановить задачу"), &historyDialog);
     QPushButton *deleteButton = new QPushButton(translate("Удалить задачу"), &historyDialog);
+    QPushButton *archiveButton = new QPushButton(translate("Архив"), &historyDialog);
     QPushButton *closeButton = new QPushButton(translate("Закрыть"), &historyDialog);
 
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     buttonLayout->addWidget(restoreButton);
     buttonLayout->addWidget(deleteButton);
+    buttonLayout->addWidget(archiveButton);
     buttonLayout->addWidget(closeButton);
 
     layout.addWidget(historyTable);
@@ -1338,51 +1475,128 @@ void MainWindow::showHistory()
         historyDialog.accept();
     });
 
+    connect(archiveButton, &QPushButton::clicked, this, &MainWindow::showHistoryArchive);
+
     connect(closeButton, &QPushButton::clicked, &historyDialog, &QDialog::accept);
 
     historyDialog.exec();
 }
 
+// Просмотр архива истории (записи читаются из файла по запросу)
+void MainWindow::showHistoryArchive()
+{
+    QDialog archiveDialog(this);
+    archiveDialog.setWindowTitle(translate("Архив истории"));
+    archiveDialog.resize(900, 600);
+
+    QVBoxLayout layout(&archiveDialog);
+
+    QLabel *countLabel = new QLabel(translate("Записей в архиве: ") + QString::number(historyArchive.rowCount()),
+                                    &archiveDialog);
+    QLineEdit *searchEdit = new QLineEdit(&archiveDialog);
+    searchEdit->setPlaceholderText(translate("Введите текст для поиска"));
+
+    QTableWidget *archiveTable = new QTableWidget(0, 6, &archiveDialog);
+    archiveTable->setHorizontalHeaderLabels(QStringList() << translate("Задача") << translate("Рабочее пространство")
+                                                          << translate("Категория") << translate("Статус")
+                                                          << translate("Срок") << translate("Дата завершения"));
+    archiveTable->horizontalHeader()->setStretchLastSection(true);
+    archiveTable->verticalHeader()->setVisible(false);
+    archiveTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    archiveTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    QPushButton *closeButton = new QPushButton(translate("Закрыть"), &archiveDialog);
+
+    layout.addWidget(countLabel);
+    layout.addWidget(searchEdit);
+    layout.addWidget(archiveTable);
+    layout.addWidget(closeButton);
+
+    // Распаковка блоков только после паузы в наборе
+    QTimer *debounce = new QTimer(&archiveDialog);
+    debounce->setSingleShot(true);
+    debounce->setInterval(250);
+
+    auto runSearch = [this, searchEdit, archiveTable]() {
+        const QVector<HistoryArchive::Entry> entries = historyArchive.search(searchEdit->text());
+        archiveTable->setRowCount(entries.size());
+        for (int i = 0; i < entries.size(); ++i) {
+            const HistoryArchive::Entry &entry = entries[i];
+            archiveTable->setItem(i, 0, new QTableWidgetItem(entry.description));
+            archiveTable->setItem(i, 1, new QTableWidgetItem(entry.workspace));
+            archiveTable->setItem(i, 2, new QTableWidgetItem(entry.category));
+            archiveTable->setItem(i, 3, new QTableWidgetItem(entry.status));
+            archiveTable->setItem(i, 4, new QTableWidgetItem(entry.deadline));
+            archiveTable->setItem(i, 5, new QTableWidgetItem(entry.completedAt));
+        }
+    };
+
+    connect(searchEdit, &QLineEdit::textChanged, debounce, qOverload<>(&QTimer::start));
+    connect(debounce, &QTimer::timeout, &archiveDialog, runSearch);
+    connect(closeButton, &QPushButton::clicked, &archiveDialog, &QDialog::accept);
+
+    runSearch();
+    archiveDialog.exec();
+}
+
 // Возвращение задачи из истории
 void MainWindow::restoreTaskFromHistory()
 {
     bool ok;
-    QString taskDescription = QInputDialog::getText(this, translate("Восстановить задачу"),
-                                                    translate("Введите описание задачи для восстановления:"),
-                                                    QLineEdit::Normal, "", &ok);
+    QString taskDescription = getTextWithSuggestions(translate("Восстановить задачу"),
+                                                     translate("Введите описание задачи для восстановления:"),
+                                                     TrigramIndex::HistoryDescription, &ok);
     if (!ok || taskDescription.isEmpty()) return;
 
-    QString workspaceName = QInputDialog::getText(this, translate("Восстановить задачу"),
-                                                  translate("Введите имя рабочего пространства:"),
-                                                  QLineEdit::Normal, "", &ok);
+    QString workspaceName = getTextWithSuggestions(translate("Восстановить задачу"),
+                                                   translate("Введите имя рабочего пространства:"),
+                                                   TrigramIndex::WorkspaceName, &ok);
     if (!ok || workspaceName.isEmpty()) return;
 
-    QString categoryName = QInputDialog::getText(this, translate("Восстановить задачу"),
-                                                 translate("Введите имя категории:"),
-                                                 QLineEdit::Normal, "", &ok);
+    QString categoryName = getTextWithSuggestions(translate("Восстановить задачу"),
+                                                  translate("Введите имя категории:"),
+                                                  TrigramIndex::CategoryName, &ok);
     if (!ok || categoryName.isEmpty()) return;
 
-    // Нахождение задачи в истории
-    QSqlQuery findTaskQuery;
-    findTaskQuery.prepare("SELECT id, description, difficulty, priority, status, deadline FROM TaskHistory WHERE description = :description");
-    findTaskQuery.bindValue(":description", taskDescription);
-
-    if (!findTaskQuery.exec()) {
-        QMessageBox::critical(this, translate("Ошибка"), findTaskQuery.lastError().text());
-        return;
+    // Опечатки: предложение ближайшего совпадения
+    auto findTaskInHistory = [this](const QString& description) {
+        for (const Task &task : taskHistory) {
+            if (task.getDescription() == description) return true;
+        }
+        return false;
+    };
+    if (!findTaskInHistory(taskDescription)) {
+        taskDescription = confirmSuggestion(TrigramIndex::HistoryDescription, taskDescription);
+        if (taskDescription.isEmpty()) return;
+    }
+    if (!workspaces.contains(workspaceName)) {
+        workspaceName = confirmSuggestion(TrigramIndex::WorkspaceName, workspaceName);
+        if (workspaceName.isEmpty()) return;
+    }
+    if (workspaces.contains(workspaceName) &&
+        !workspaces[workspaceName]->getCategories().contains(categoryName)) {
+        categoryName = confirmSuggestion(TrigramIndex::CategoryName, categoryName);
+        if (categoryName.isEmpty()) return;
     }
 
-    if (!findTaskQuery.next()) {
-        QMessageBox::warning(this, translate("Ошибка"), translate("Задача не найдена в истории"));
+    // Нахождение задачи в истории
+    HistoryRecord record;
+    try {
+        if (!repository.findHistoryTask(taskDescription, &record)) {
+            QMessageBox::warning(this, translate("Ошибка"), translate("Задача не найдена в истории"));
+            return;
+        }
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, translate("Ошибка"), QString::fromStdString(e.what()));
         return;
     }
 
-    int oldTaskId = findTaskQuery.value(0).toInt();
-    QString description = findTaskQuery.value(1).toString();
-    QString difficulty = findTaskQuery.value(2).toString();
-    QString priority = findTaskQuery.value(3).toString();
-    QString status = findTaskQuery.value(4).toString();
-    QString deadline = findTaskQuery.value(5).toString();
+    int oldTaskId = record.id;
+    QString description = record.description;
+    QString difficulty = record.difficulty;
+    QString priority = record.priority;
+    QString status = record.status;
+    QString deadline = record.deadline;
 
     // Проверка на сущ рабочего пр-ва и категории
     if (!workspaces.contains(workspaceName)) {
@@ -1399,100 +1613,161 @@ void MainWindow::restoreTaskFromHistory()
     Category* category = workspace->getCategories()[categoryName];
     int categoryId = category->getId();
 
-    db.transaction();
+    // Иначе задача появится второй раз при загрузке файла пр-ва
+    loadWorkspaceFile(workspace);
 
     try {
-        // Вставка задачи в таблицу
-        QSqlQuery insertTaskQuery;
-        insertTaskQuery.prepare(
-            "INSERT INTO Tasks (description, category_id, difficulty, priority, status, deadline) "
-            "VALUES (:description, :category_id, :difficulty, :priority, :status, :deadline)"
-            );
-        insertTaskQuery.bindValue(":description", description);
-        insertTaskQuery.bindValue(":category_id", categoryId);
-        insertTaskQuery.bindValue(":difficulty", difficulty);
-        insertTaskQuery.bindValue(":priority", priority);
-        insertTaskQuery.bindValue(":status", status);
-        insertTaskQuery.bindValue(":deadline", deadline);
-
-        if (!insertTaskQuery.exec()) {
-            throw std::runtime_error(insertTaskQuery.lastError().text().toStdString());
-        }
-
-        int newTaskId = insertTaskQuery.lastInsertId().toInt();
-        qDebug() << "New task ID after restore:" << newTaskId;
-
-        // Получение тегов из истории
-        QSqlQuery getTagsQuery;
-        getTagsQuery.prepare("SELECT tag FROM TaskTags WHERE task_id = :old_task_id");
-        getTagsQuery.bindValue(":old_task_id", oldTaskId);
-
-        if (!getTagsQuery.exec()) {
-            throw std::runtime_error(getTagsQuery.lastError().text().toStdString());
+        // Перенос задачи с тегами из истории
+        if (!repository.transaction()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
-
         QStringList tags;
-        while (getTagsQuery.next()) {
-            QString tag = getTagsQuery.value(0).toString();
-            tags.append(tag);
-
-            // Вставка тегов для новой задачи
-            QSqlQuery insertTagQuery;
-            insertTagQuery.prepare("INSERT INTO TaskTags (task_id, tag) VALUES (:new_task_id, :tag)");
-            insertTagQuery.bindValue(":new_task_id", newTaskId);
-            insertTagQuery.bindValue(":tag", tag);
-
-            if (!insertTagQuery.exec()) {
-                throw std::runtime_error(insertTagQuery.lastError().text().toStdString());
-            }
-            qDebug() << "Tag copied:" << tag << "for task" << newTaskId;
+        int newTaskId = repository.restoreTaskFromHistory(record, categoryId, &tags);
+        if (!repository.commit()) {
+            throw std::runtime_error(repository.lastError().toStdString());
         }
 
-        // Удаление задачи из истории
-        QSqlQuery deleteHistoryQuery;
-        deleteHistoryQuery.prepare("DELETE FROM TaskHistory WHERE id = :task_id");
-        deleteHistoryQuery.bindValue(":task_id", oldTaskId);
-
-        if (!deleteHistoryQuery.exec()) {
-            throw std::runtime_error(deleteHistoryQuery.lastError().text().toStdString());
-        }
-
-        // Удаление тегов из истории
-        QSqlQuery deleteTagsQuery;
-        deleteTagsQuery.prepare("DELETE FROM TaskTags WHERE task_id = :task_id");
-        deleteTagsQuery.bindValue(":task_id", oldTaskId);
-
-        if (!deleteTagsQuery.exec()) {
-            throw std::runtime_error(deleteTagsQuery.lastError().text().toStdString());
-        }
-
-        db.commit();
-
         // Обновление данных
         Task* task = new Task(newTaskId, description, categoryName, tags,
                               difficulty, priority, status, deadline);
         category->addTask(task);
+        snapshots.publish(workspaces, workspaceName, categoryName);
+        for (const QString &tag : tags) {
+            tagIndex.add(tag);
+        }
 
         // Удаление задачи из списка истории в памяти
         for (auto it = taskHistory.begin(); it != taskHistory.end(); ++it) {
             if (it->getId() == oldTaskId) {
+                lookupIndex.remove(TrigramIndex::HistoryDescription, it->getDescription());
+                lookupIndex.insert(TrigramIndex::TaskDescription, description);
                 taskHistory.erase(it);
                 break;
             }
         }
 
-        qDebug() << "Task restored successfully. Tags count:" << tags.size();
+        // Запись истории, на которую ссылается отмена завершения, больше не существует
+        undoStack.clear();
+        updateUndoButtons();
+
+        qCDebug(lcModel) << "Task restored successfully. Tags count:" << tags.size();
         QMessageBox::information(this, translate("Задача восстановлена"),
                                  translate("Задача \"%1\" была восстановлена").arg(taskDescription));
         showCategories(workspaceName);
     } catch (const std::exception& e) {
-        db.rollback();
-        qDebug() << "Error restoring task:" << e.what();
+        repository.rollback();
+        qCWarning(lcDb) << "Error restoring task:" << e.what();
         QMessageBox::critical(this, translate("Ошибка"),
                               translate("Не удалось восстановить задачу: ") + QString::fromStdString(e.what()));
     }
 }
 
+// Заполнение индекса нечеткого поиска
+void MainWindow::rebuildLookupIndex()
+{
+    lookupIndex.clear();
+    for (Workspace *workspace : workspaces) {
+        lookupIndex.insert(TrigramIndex::WorkspaceName, workspace->getName());
+        for (Category *category : workspace->getCategories()) {
+            lookupIndex.insert(TrigramIndex::CategoryName, category->getName());
+            for (Task *task : category->getTasks()) {
+                lookupIndex.insert(TrigramIndex::TaskDescription, task->getDescription());
+            }
+        }
+    }
+    // Описания истории - отдельно: при восстановлении предлагаются только они
+    for (const Task &task : taskHistory) {
+        lookupIndex.insert(TrigramIndex::HistoryDescription, task.getDescription());
+    }
+}
+
+// Заполнение индекса тегов (частоты по активным задачам)
+void MainWindow::rebuildTagIndex()
+{
+    QHash<QString, int> usage;
+    for (Workspace *workspace : workspaces) {
+        for (Category *category : workspace->getCategories()) {
+            for (Task *task : category->getTasks()) {
+                for (const QString &tag : task->getTags()) {
+                    usage[tag]++;
+                }
+            }
+        }
+    }
+    tagIndex.rebuild(usage);
+}
+
+// Удаление рабочего пр-ва и всего его содержимого из индексов
+void MainWindow::unindexWorkspace(Workspace *workspace)
+{
+    lookupIndex.remove(TrigramIndex::WorkspaceName, workspace->getName());
+    for (Category *category : workspace->getCategories()) {
+        lookupIndex.remove(TrigramIndex::CategoryName, category->getName());
+        for (Task *task : category->getTasks()) {
+            lookupIndex.remove(TrigramIndex::TaskDescription, task->getDescription());
+            for (const QString &tag : task->getTags()) {
+                tagIndex.remove(tag);
+            }
+        }
+    }
+}
+
+// Подсказки при вводе (ближайшие по триграммам строки)
+void MainWindow::attachSuggestions(QLineEdit *edit, TrigramIndex::Kind kind)
+{
+    QStringListModel *suggestions = new QStringListModel(edit);
+    QCompleter *completer = new QCompleter(suggestions, edit);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    edit->setCompleter(completer);
+
+    connect(edit, &QLineEdit::textEdited, edit, [this, suggestions, kind](const QString &text) {
+        QStringList items;
+        for (const TrigramIndex::Match &match : lookupIndex.topMatches(kind, text, 8)) {
+            items.append(match.text);
+        }
+        suggestions->setStringList(items);
+    });
+}
+
+// Аналог QInputDialog::getText с подсказками
+QString MainWindow::getTextWithSuggestions(const QString &title, const QString &label,
+                                           TrigramIndex::Kind kind, bool *ok)
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle(title);
+
+    QVBoxLayout layout(&dialog);
+    QLineEdit *edit = new QLineEdit(&dialog);
+    attachSuggestions(edit, kind);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    buttonBox->button(QDialogButtonBox::Cancel)->setText(translate("Отмена"));
+    connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    layout.addWidget(new QLabel(label, &dialog));
+    layout.addWidget(edit);
+    layout.addWidget(buttonBox);
+
+    bool accepted = dialog.exec() == QDialog::Accepted;
+    if (ok) *ok = accepted;
+    return accepted ? edit->text().trimmed() : QString();
+}
+
+// "Возможно, вы имели в виду ...?" (без совпадений - исходный текст, отказ - пустая строка)
+QString MainWindow::confirmSuggestion(TrigramIndex::Kind kind, const QString &text)
+{
+    QString suggestion = lookupIndex.bestMatch(kind, text);
+    if (suggestion.isEmpty()) return text;
+
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this, translate("Восстановить задачу"),
+        translate("Возможно, вы имели в виду \"%1\"?").arg(suggestion),
+        QMessageBox::Yes | QMessageBox::No);
+    return reply == QMessageBox::Yes ? suggestion : QString();
+}
+
 // Удаление таски из истории
 void MainWindow::deleteTaskFromHistory()
 {
@@ -1505,13 +1780,24 @@ void MainWindow::deleteTaskFromHistory()
 
     for (auto it = taskHistory.begin(); it != taskHistory.end(); ++it) {
         if (compareStringsIgnoreCase(it->getDescription(), taskDescription)) {
-            QString sql = "DELETE FROM TaskHistory WHERE id = " + QString::number(it->getId()) + ";";
-            executeSQL(sql);
-
-            sql = "DELETE FROM TaskTags WHERE task_id = " + QString::number(it->getId()) + ";";
-            executeSQL(sql);
+            try {
+                if (!repository.transaction()) {
+                    throw std::runtime_error(repository.lastError().toStdString());
+                }
+                repository.deleteHistoryTask(it->getId());
+                if (!repository.commit()) {
+                    throw std::runtime_error(repository.lastError().toStdString());
+                }
+            } catch (const std::exception &e) {
+                repository.rollback();
+                QMessageBox::critical(this, translate("Ошибка"), QString::fromStdString(e.what()));
+                return;
+            }
 
+            lookupIndex.remove(TrigramIndex::HistoryDescription, it->getDescription());
             taskHistory.erase(it);
+            undoStack.clear();
+            updateUndoButtons();
 
             QMessageBox::information(this, translate("Задача удалена"),
                                      translate("Task \"%1\" Была удалена навсегда").arg(taskDescription));
@@ -1593,38 +1879,7 @@ void MainWindow::showNotifications() {
 // Проверка дедлайнов
 void MainWindow::checkDeadlines()
 {
-    QDate currentDate = QDate::currentDate();
-
-    // Перебор
-    for (auto workspaceIt = workspaces.begin(); workspaceIt != workspaces.end(); ++workspaceIt) {
-        QMap<QString, Category*>& categories = workspaceIt.value()->getCategories();
-        for (auto categoryIt = categories.begin(); categoryIt != categories.end(); ++categoryIt) {
-            QVector<Task*>& tasks = categoryIt.value()->getTasks();
-            for (Task *task : tasks) {
-                QString taskDeadline = task->getDeadline();
-                if (!taskDeadline.isEmpty()) {
-                    QDate deadlineDate = QDate::fromString(taskDeadline, "dd-MM-yyyy");
-                    if (deadlineDate.isValid() && deadlineDate == currentDate) {
-
-                        // Пр-ка
-                        bool exists = false;
-                        for (const Notification &n : notifications) {
-                            if (n.getTaskDescription() == task->getDescription() &&
-                                n.getDeadline() == taskDeadline) {
-                                exists = true;
-                                break;
-                            }
-                        }
-
-                        // Добавление нового уведомления
-                        if (!exists) {
-                            notifications.append(Notification(task->getDescription(), taskDeadline));
-                        }
-                    }
-                }
-            }
-        }
-    }
+    DeadlineScheduler::checkDeadlines(workspaces, notifications);
 }
 
 // Очистка уведомлений
@@ -1681,6 +1936,7 @@ QInputDialog* MainWindow::createInputDialog(const QString &title, const QString
 
 // Обновление интерфейса
 void MainWindow::updateUI() {
+    TRACE_SCOPE("MainWindow::updateUI", "ui");
     setWindowTitle(translate("Менеджер задач"));
     addWorkspaceButton->setText(translate("Добавить рабочее пространство"));
     addCategoryButton->setText(translate("Добавить категорию"));
@@ -1688,6 +1944,14 @@ void MainWindow::updateUI() {
     notificationsButton->setText(translate("Уведомления"));
     languageButton->setText(isEnglish ? translate("Русский") : translate("English"));
     searchByTagsButton->setText(translate("Поиск по тегам"));
+    filterTasksButton->setText(translate("Фильтр задач"));
+    searchButton->setText(translate("Поиск"));
+    importButton->setText(translate("Импорт задач"));
+    if (!exporter->isRunning()) exportButton->setText(translate("Экспорт задач"));
+    backupButton->setText(translate("Резервные копии"));
+    undoButton->setText(translate("Отменить"));
+    redoButton->setText(translate("Повторить"));
+    quickSwitcher->setPlaceholderText(translate("Быстрый переход..."));
     themeButton->setText(isDarkTheme ? translate("Светлая тема") : translate("Темная тема"));
 
     // Обновление отображения рабочего пространства
@@ -1744,6 +2008,12 @@ void MainWindow::retranslateUi() {
     notificationsButton->setText(translate("Уведомления"));
     languageButton->setText(isEnglish ? "Русский" : "English");
     searchByTagsButton->setText(translate("Поиск по тегам"));
+    filterTasksButton->setText(translate("Фильтр задач"));
+    searchButton->setText(translate("Поиск"));
+    importButton->setText(translate("Импорт задач"));
+    if (!exporter->isRunning()) exportButton->setText(translate("Экспорт задач"));
+    backupButton->setText(translate("Резервные копии"));
+    quickSwitcher->setPlaceholderText(translate("Быстрый переход..."));
 
     QString currentText = currentWorkspaceLabel->text();
     QString cleanName = currentText;
@@ -1836,6 +2106,769 @@ void MainWindow::searchTasksByTags() {
     resultsDialog.exec();
 }
 
+// Фильтр задач по нескольким критериям (по снимку модели, все рабочие пр-ва)
+void MainWindow::showTaskFilter()
+{
+    QDialog filterDialog(this);
+    filterDialog.setWindowTitle(translate("Фильтр задач"));
+    filterDialog.resize(900, 600);
+
+    QVBoxLayout layout(&filterDialog);
+    QFormLayout *form = new QFormLayout();
+
+    QComboBox *statusCombo = new QComboBox(&filterDialog);
+    statusCombo->addItem(translate("Любой"), -1);
+    statusCombo->addItem(translate("В ожидании"), StatusPending);
+    statusCombo->addItem(translate("В процессе"), StatusInProgress);
+    statusCombo->addItem(translate("Завершено"), StatusCompleted);
+
+    QComboBox *priorityCombo = new QComboBox(&filterDialog);
+    priorityCombo->addItem(translate("Любой"), -1);
+    priorityCombo->addItem(translate("Низкий"), 0);
+    priorityCombo->addItem(translate("Средний"), 1);
+    priorityCombo->addItem(translate("Высокий"), 2);
+
+    QComboBox *difficultyCombo = new QComboBox(&filterDialog);
+    difficultyCombo->addItem(translate("Любой"), -1);
+    difficultyCombo->addItem(translate("Лёгкая"), 0);
+    difficultyCombo->addItem(translate("Средняя"), 1);
+    difficultyCombo->addItem(translate("Сложная"), 2);
+
+    // Диапазон сроков
+    QCheckBox *deadlineCheck = new QCheckBox(&filterDialog);
+    QDateEdit *deadlineFromEdit = new QDateEdit(QDate::currentDate(), &filterDialog);
+    QDateEdit *deadlineToEdit = new QDateEdit(QDate::currentDate().addDays(7), &filterDialog);
+    for (QDateEdit *edit : {deadlineFromEdit, deadlineToEdit}) {
+        edit->setDisplayFormat("dd-MM-yyyy");
+        edit->setCalendarPopup(true);
+        edit->setEnabled(false);
+        connect(deadlineCheck, &QCheckBox::toggled, edit, &QDateEdit::setEnabled);
+    }
+    QHBoxLayout *deadlineLayout = new QHBoxLayout();
+    deadlineLayout->addWidget(deadlineCheck);
+    deadlineLayout->addWidget(deadlineFromEdit);
+    deadlineLayout->addWidget(deadlineToEdit);
+
+    QLineEdit *tagsEdit = new QLineEdit(&filterDialog);
+    QLineEdit *textEdit = new QLineEdit(&filterDialog);
+
+    form->addRow(translate("Статус:"), statusCombo);
+    form->addRow(translate("Приоритет:"), priorityCombo);
+    form->addRow(translate("Сложность:"), difficultyCombo);
+    form->addRow(translate("Срок с/по:"), deadlineLayout);
+    form->addRow(translate("Тэги:"), tagsEdit);
+    form->addRow(translate("Текст:"), textEdit);
+
+    QPushButton *applyButton = new QPushButton(translate("Применить"), &filterDialog);
+    QLabel *countLabel = new QLabel(&filterDialog);
+
+    // Результаты (сортировка по клику на заголовок)
+    TaskResultsModel *resultsModel = new TaskResultsModel(&filterDialog);
+    resultsModel->setHeaderLabels({
+        translate("Задача"), translate("Рабочее пространство"), translate("Категория"), translate("Срок"),
+        translate("Статус"), translate("Приоритет"), translate("Сложность")
+    });
+
+    QTableView *resultsView = new QTableView(&filterDialog);
+    resultsView->setModel(resultsModel);
+    resultsView->setSortingEnabled(true);
+    resultsView->sortByColumn(TaskResultsModel::DeadlineColumn, Qt::AscendingOrder);
+    resultsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    resultsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    resultsView->verticalHeader()->setVisible(false);
+    resultsView->horizontalHeader()->setSectionResizeMode(TaskResultsModel::TaskColumn, QHeaderView::Stretch);
+
+    QPushButton *closeButton = new QPushButton(translate("Закрыть"), &filterDialog);
+
+    layout.addLayout(form);
+    layout.addWidget(applyButton);
+    layout.addWidget(countLabel);
+    layout.addWidget(resultsView);
+    layout.addWidget(closeButton);
+
+    auto runFilter = [&]() {
+        TaskFilterCriteria criteria;
+        if (statusCombo->currentData().toInt() >= 0) criteria.statuses.append(statusCombo->currentData().toInt());
+        if (priorityCombo->currentData().toInt() >= 0) criteria.priorities.append(priorityCombo->currentData().toInt());
+        if (difficultyCombo->currentData().toInt() >= 0) criteria.difficulties.append(difficultyCombo->currentData().toInt());
+        if (deadlineCheck->isChecked()) {
+            criteria.deadlineFrom = deadlineFromEdit->date();
+            criteria.deadlineTo = deadlineToEdit->date();
+        }
+        criteria.tags = tagsEdit->text().split(',', Qt::SkipEmptyParts);
+        criteria.text = textEdit->text();
+
+        QElapsedTimer timer;
+        timer.start();
+        QVector<TaskFilterHit> hits = filterEngine.run(currentSnapshot(), criteria);
+        resultsModel->setResults(hits);
+
+        countLabel->setText(translate("Найдено задач: %1 (%2 мс)").arg(hits.size()).arg(timer.elapsed()));
+    };
+
+    connect(applyButton, &QPushButton::clicked, &filterDialog, runFilter);
+    connect(tagsEdit, &QLineEdit::returnPressed, &filterDialog, runFilter);
+    connect(textEdit, &QLineEdit::returnPressed, &filterDialog, runFilter);
+    connect(closeButton, &QPushButton::clicked, &filterDialog, &QDialog::accept);
+
+    runFilter();
+    filterDialog.exec();
+}
+
+// Полнотекстовый поиск (запрос при вводе)
+void MainWindow::showTaskSearch()
+{
+    QDialog searchDialog(this);
+    searchDialog.setWindowTitle(translate("Поиск задач"));
+    searchDialog.resize(600, 450);
+
+    QVBoxLayout layout(&searchDialog);
+
+    QLineEdit *searchEdit = new QLineEdit(&searchDialog);
+    searchEdit->setPlaceholderText(translate("Введите текст для поиска"));
+    searchEdit->setClearButtonEnabled(true);
+
+    QListWidget *resultsList = new QListWidget(&searchDialog);
+    QPushButton *closeButton = new QPushButton(translate("Закрыть"), &searchDialog);
+
+    layout.addWidget(searchEdit);
+    layout.addWidget(resultsList);
+    layout.addWidget(closeButton);
+
+    // Запрос не на каждую клавишу, а после короткой паузы
+    QTimer *debounce = new QTimer(&searchDialog);
+    debounce->setSingleShot(true);
+    debounce->setInterval(120);
+
+    connect(searchEdit, &QLineEdit::textChanged, debounce, qOverload<>(&QTimer::start));
+    connect(debounce, &QTimer::timeout, &searchDialog, [this, searchEdit, resultsList]() {
+        resultsList->clear();
+        for (const TaskSearchHit &hit : taskSearch.search(searchEdit->text())) {
+            QString text = hit.description;
+            if (!hit.category.isEmpty()) {
+                text += QString("  —  %1 / %2").arg(hit.workspace, hit.category);
+            } else if (!hit.workspace.isEmpty()) {
+                text += QString("  —  %1").arg(hit.workspace);
+            }
+            if (hit.inHistory) {
+                text += QString(" (%1)").arg(translate("в истории"));
+            }
+
+            QListWidgetItem *item = new QListWidgetItem(text, resultsList);
+            item->setData(Qt::UserRole, hit.inHistory ? QString() : hit.workspace);
+        }
+    });
+
+    // Переход к рабочему пр-ву найденной задачи
+    connect(resultsList, &QListWidget::itemActivated, &searchDialog, [this, &searchDialog](QListWidgetItem *item) {
+        QString workspaceName = item->data(Qt::UserRole).toString();
+        if (workspaces.contains(workspaceName)) {
+            showCategories(workspaceName);
+            searchDialog.accept();
+        }
+    });
+
+    connect(closeButton, &QPushButton::clicked, &searchDialog, &QDialog::accept);
+
+    searchDialog.exec();
+}
+
+// Профиль sql: статистика по каждому тексту запроса + гистограмма выбранного
+void MainWindow::showSqlDiagnostics()
+{
+    QDialog diagnosticsDialog(this);
+    diagnosticsDialog.setWindowTitle(translate("Диагностика SQL"));
+    diagnosticsDialog.resize(1000, 600);
+
+    QVBoxLayout layout(&diagnosticsDialog);
+
+    QSplitter *splitter = new QSplitter(Qt::Vertical, &diagnosticsDialog);
+    QTableWidget *table = new QTableWidget(0, 7, splitter);
+    table->setHorizontalHeaderLabels({
+        translate("Запрос"), translate("Выполнений"), translate("Строк"), translate("Всего, мс"),
+        translate("Среднее, мкс"), translate("p95, мкс"), translate("Макс, мкс")
+    });
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+    table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    table->verticalHeader()->setVisible(false);
+
+    QLabel *histogramLabel = new QLabel(splitter);
+    histogramLabel->setFont(QFont("Monospace"));
+    histogramLabel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+    histogramLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    QHBoxLayout *buttonsLayout = new QHBoxLayout();
+    QPushButton *refreshButton = new QPushButton(translate("Обновить"), &diagnosticsDialog);
+    QPushButton *resetButton = new QPushButton(translate("Сбросить"), &diagnosticsDialog);
+    QPushButton *saveButton = new QPushButton(translate("Сохранить..."), &diagnosticsDialog);
+    QPushButton *closeButton = new QPushButton(translate("Закрыть"), &diagnosticsDialog);
+    buttonsLayout->addWidget(refreshButton);
+    buttonsLayout->addWidget(resetButton);
+    buttonsLayout->addWidget(saveButton);
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(closeButton);
+
+    layout.addWidget(splitter);
+    layout.addLayout(buttonsLayout);
+
+    auto stats = std::make_shared<QVector<SqlStatementStats>>();
+
+    auto refresh = [table, histogramLabel, stats]() {
+        *stats = SqlProfiler::statistics();
+        table->setRowCount(0);
+        table->setRowCount(stats->size());
+        for (int row = 0; row < stats->size(); ++row) {
+            const SqlStatementStats &entry = stats->at(row);
+            QTableWidgetItem *statementItem = new QTableWidgetItem(entry.statement.simplified());
+            statementItem->setToolTip(entry.statement);
+            table->setItem(row, 0, statementItem);
+            table->setItem(row, 1, new QTableWidgetItem(QString::number(entry.count)));
+            table->setItem(row, 2, new QTableWidgetItem(QString::number(entry.rows)));
+            table->setItem(row, 3, new QTableWidgetItem(QString::number(entry.totalNs / 1e6, 'f', 2)));
+            table->setItem(row, 4, new QTableWidgetItem(QString::number(entry.meanNs() / 1e3, 'f', 1)));
+            table->setItem(row, 5, new QTableWidgetItem(QString::number(entry.percentileNs(0.95) / 1e3, 'f', 1)));
+            table->setItem(row, 6, new QTableWidgetItem(QString::number(entry.maxNs / 1e3, 'f', 1)));
+        }
+        histogramLabel->clear();
+    };
+
+    // Гистограмма задержек выбранного запроса
+    connect(table, &QTableWidget::currentCellChanged, &diagnosticsDialog,
+            [this, histogramLabel, stats](int row) {
+        if (row < 0 || row >= stats->size()) {
+            histogramLabel->clear();
+            return;
+        }
+
+        const SqlStatementStats &entry = stats->at(row);
+        const QVector<qint64> &bounds = SqlProfiler::bucketBoundsNs();
+        qint64 peak = *std::max_element(entry.histogram.begin(), entry.histogram.end());
+
+        QStringList lines;
+        for (int i = 0; i < entry.histogram.size(); ++i) {
+            if (entry.histogram[i] == 0) continue;
+            QString bound = i == bounds.size() - 1 ? QString("   > %1 %2").arg(bounds[i - 1] / 1000).arg(translate("мкс"))
+                                                   : QString("<= %1 %2").arg(bounds[i] / 1000, 7).arg(translate("мкс"));
+            int width = peak > 0 ? int(40 * entry.histogram[i] / peak) : 0;
+            lines.append(QString("%1 %2 %3").arg(bound, -14).arg(QString(qMax(width, 1), QChar(0x2588))).arg(entry.histogram[i]));
+        }
+        histogramLabel->setText(lines.join("\n"));
+    });
+
+    connect(refreshButton, &QPushButton::clicked, &diagnosticsDialog, refresh);
+    connect(resetButton, &QPushButton::clicked, &diagnosticsDialog, [refresh]() {
+        SqlProfiler::reset();
+        refresh();
+    });
+    connect(saveButton, &QPushButton::clicked, &diagnosticsDialog, [this, &diagnosticsDialog]() {
+        QString path = QFileDialog::getSaveFileName(&diagnosticsDialog, translate("Сохранить..."),
+                                                    "sql_profile.json", "JSON (*.json)");
+        if (path.isEmpty()) return;
+        if (!SqlProfiler::dump(path)) {
+            QMessageBox::critical(&diagnosticsDialog, translate("Ошибка"), translate("Не удалось сохранить отчет"));
+        }
+    });
+    connect(closeButton, &QPushButton::clicked, &diagnosticsDialog, &QDialog::accept);
+
+    refresh();
+    diagnosticsDialog.exec();
+}
+
+// Отчет о памяти модели и дерева виджетов
+QJsonObject MainWindow::memoryReport() const
+{
+    QJsonObject report = MemoryAccounting::toJson(
+        MemoryAccounting::modelUsage(workspaces, taskHistory, notifications));
+
+    QJsonObject widgets;
+    widgets["categories_content"] = categoriesContent->findChildren<QWidget*>().size();
+    widgets["all"] = QApplication::allWidgets().size();
+    report["widgets"] = widgets;
+    return report;
+}
+
+void MainWindow::showMemoryReport()
+{
+    QDialog memoryDialog(this);
+    memoryDialog.setWindowTitle(translate("Память"));
+    memoryDialog.resize(520, 420);
+
+    QVBoxLayout layout(&memoryDialog);
+
+    QTableWidget *table = new QTableWidget(0, 3, &memoryDialog);
+    table->setHorizontalHeaderLabels({translate("Структура"), translate("Объектов"), translate("Байт")});
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    table->verticalHeader()->setVisible(false);
+
+    QLabel *processLabel = new QLabel(&memoryDialog);
+
+    QHBoxLayout *buttonsLayout = new QHBoxLayout();
+    QPushButton *refreshButton = new QPushButton(translate("Обновить"), &memoryDialog);
+    QPushButton *saveButton = new QPushButton(translate("Сохранить..."), &memoryDialog);
+    QPushButton *closeButton = new QPushButton(translate("Закрыть"), &memoryDialog);
+    buttonsLayout->addWidget(refreshButton);
+    buttonsLayout->addWidget(saveButton);
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(closeButton);
+
+    layout.addWidget(table);
+    layout.addWidget(processLabel);
+    layout.addLayout(buttonsLayout);
+
+    auto refresh = [this, table, processLabel]() {
+        QVector<MemoryUsage> usage = MemoryAccounting::modelUsage(workspaces, taskHistory, notifications);
+        usage.append({translate("Виджеты категорий"), categoriesContent->findChildren<QWidget*>().size(), -1});
+        usage.append({translate("Все виджеты"), QApplication::allWidgets().size(), -1});
+
+        table->setRowCount(usage.size());
+        for (int row = 0; row < usage.size(); ++row) {
+            table->setItem(row, 0, new QTableWidgetItem(usage[row].name));
+            table->setItem(row, 1, new QTableWidgetItem(QString::number(usage[row].objects)));
+            table->setItem(row, 2, new QTableWidgetItem(usage[row].bytes < 0 ? QString("—")
+                                                                              : QString::number(usage[row].bytes)));
+        }
+
+        QStringList lines;
+        qint64 resident = MemoryAccounting::residentBytes();
+        if (resident >= 0) {
+            lines.append(translate("Резидентная память: %1 КБ").arg(resident / 1024));
+        }
+        AllocatorStats stats = MemoryAccounting::allocatorStats();
+        if (stats.available) {
+            lines.append(translate("operator new: %1 КБ в %2 блоках (пик %3 КБ, всего выделений %4)")
+                             .arg(stats.liveBytes / 1024).arg(stats.liveAllocations)
+                             .arg(stats.peakBytes / 1024).arg(stats.totalAllocations));
+        } else {
+            lines.append(translate("Счетчик operator new выключен в этой сборке"));
+        }
+        processLabel->setText(lines.join("\n"));
+    };
+
+    connect(refreshButton, &QPushButton::clicked, &memoryDialog, refresh);
+    connect(saveButton, &QPushButton::clicked, &memoryDialog, [this, &memoryDialog]() {
+        QString path = QFileDialog::getSaveFileName(&memoryDialog, translate("Сохранить..."),
+                                                    "memory_report.json", "JSON (*.json)");
+        if (path.isEmpty()) return;
+
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            QMessageBox::critical(&memoryDialog, translate("Ошибка"), translate("Не удалось сохранить отчет"));
+            return;
+        }
+        file.write(QJsonDocument(memoryReport()).toJson());
+    });
+    connect(closeButton, &QPushButton::clicked, &memoryDialog, &QDialog::accept);
+
+    refresh();
+    memoryDialog.exec();
+}
+
+// Импорт задач из CSV / JSON Lines
+void MainWindow::importTasks()
+{
+    QString path = QFileDialog::getOpenFileName(this, translate("Импорт задач"), QString(),
+                                                translate("Задачи (*.csv *.jsonl *.ndjson *.json)"));
+    if (path.isEmpty()) return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::critical(this, translate("Ошибка"), translate("Не удалось открыть файл"));
+        return;
+    }
+
+    QProgressDialog progressDialog(translate("Импорт задач..."), translate("Отмена"), 0, 1000, this);
+    progressDialog.setWindowModality(Qt::WindowModal);
+    progressDialog.setMinimumDuration(300);
+
+    ImportOptions options;
+    options.defaultStatus = isEnglish ? "Pending" : "В ожидании";
+    options.defaultDifficulty = translate("Средняя");
+    options.defaultPriority = translate("Средний");
+
+    // Импорт сам переносит строки в модель: синхронизация с журналом - после него.
+    // Шаги очистки не должны попасть в транзакции импорта
+    syncTimer->stop();
+    purger->stop();
+
+    TaskImporter importer(repository);
+    ImportResult result;
+    try {
+        result = importer.import(file, TaskImporter::detectFormat(path), options,
+                                 [&progressDialog](qint64 processed, qint64 total) {
+            if (total > 0) {
+                progressDialog.setValue(int(processed * 1000 / total));
+            }
+            return !progressDialog.wasCanceled();
+        });
+    } catch (const std::exception &e) {
+        qCWarning(lcDb) << "Error importing tasks:" << e.what();
+        QMessageBox::critical(this, translate("Ошибка"),
+                              translate("Не удалось импортировать задачи: ") + QString::fromStdString(e.what()));
+    }
+    progressDialog.reset();
+
+    // Зафиксированные порции попадают в модель даже после ошибки или отмены
+    importer.applyTo(workspaces);
+    undoStack.clear();
+    updateUndoButtons();
+    if (changeFeed.interval() > 0) syncTimer->start(changeFeed.interval());
+    purger->start();
+    snapshots.publishAll(workspaces);
+    rebuildLookupIndex();
+    rebuildTagIndex();
+    checkDeadlines();
+    updateUI();
+
+    QString summary = translate("Импортировано задач: %1 (новых пространств: %2, категорий: %3), пропущено строк: %4")
+                          .arg(result.tasks).arg(result.workspacesCreated)
+                          .arg(result.categoriesCreated).arg(result.skipped);
+    if (result.cancelled) {
+        summary += "\n" + translate("Импорт прерван, сохранены уже записанные порции.");
+    }
+    QMessageBox::information(this, translate("Импорт задач"), summary);
+}
+
+// Экспорт рабочего пр-ва или всей бд в рабочем потоке
+void MainWindow::exportTasks()
+{
+    if (exporter->isRunning()) {
+        exporter->cancel();
+        return;
+    }
+
+    QStringList scopes;
+    scopes << translate("Вся база данных (с историей)") << workspaces.keys();
+
+    bool ok;
+    QString scope = QInputDialog::getItem(this, translate("Экспорт задач"), translate("Что экспортировать:"),
+                                          scopes, 0, false, &ok);
+    if (!ok) return;
+
+    QString path = QFileDialog::getSaveFileName(this, translate("Экспорт задач"), "tasks.jsonl",
+                                                translate("Задачи (*.csv *.jsonl *.ndjson *.json)"));
+    if (path.isEmpty()) return;
+
+    TaskExporter::Options options;
+    options.format = TaskExporter::detectFormat(path);
+    if (workspaces.contains(scope)) {
+        options.workspaceId = workspaces[scope]->getId();
+        options.includeHistory = false;
+    }
+
+    // Рабочий поток читает через свое соединение - накопленная пачка должна быть на диске
+    repository.flush();
+    if (exporter->start(repository.database().databaseName(), path, options)) {
+        exportButton->setText(translate("Экспорт: %1").arg(0));
+    }
+}
+
+// Список резервных копий, создание и восстановление
+void MainWindow::showBackups()
+{
+    QDialog backupDialog(this);
+    backupDialog.setWindowTitle(translate("Резервные копии"));
+    backupDialog.resize(480, 360);
+
+    QVBoxLayout layout(&backupDialog);
+
+    QListWidget *backupList = new QListWidget(&backupDialog);
+    QProgressBar *progressBar = new QProgressBar(&backupDialog);
+    progressBar->setVisible(backupManager->isRunning());
+
+    QFormLayout *scheduleLayout = new QFormLayout();
+    QSpinBox *intervalSpin = new QSpinBox(&backupDialog);
+    intervalSpin->setRange(0, 7 * 24 * 60);
+    intervalSpin->setValue(backupManager->interval());
+    QSpinBox *keepSpin = new QSpinBox(&backupDialog);
+    keepSpin->setRange(1, 100);
+    keepSpin->setValue(backupManager->keepCount());
+    scheduleLayout->addRow(translate("Копировать автоматически каждые (мин, 0 - выкл.):"), intervalSpin);
+    scheduleLayout->addRow(translate("Хранить копий:"), keepSpin);
+
+    QHBoxLayout *buttonsLayout = new QHBoxLayout();
+    QPushButton *backupNowButton = new QPushButton(translate("Создать копию"), &backupDialog);
+    QPushButton *restoreButton = new QPushButton(translate("Восстановить"), &backupDialog);
+    QPushButton *closeButton = new QPushButton(translate("Закрыть"), &backupDialog);
+    buttonsLayout->addWidget(backupNowButton);
+    buttonsLayout->addWidget(restoreButton);
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(closeButton);
+
+    layout.addWidget(backupList);
+    layout.addWidget(progressBar);
+    layout.addLayout(scheduleLayout);
+    layout.addLayout(buttonsLayout);
+
+    auto refresh = [this, backupList]() {
+        backupList->clear();
+        for (const QString &path : backupManager->backups()) {
+            QFileInfo info(path);
+            QListWidgetItem *item = new QListWidgetItem(QString("%1  (%2 КБ)").arg(info.fileName()).arg(info.size() / 1024));
+            item->setData(Qt::UserRole, path);
+            backupList->addItem(item);
+        }
+    };
+    refresh();
+
+    connect(intervalSpin, qOverload<int>(&QSpinBox::valueChanged), this, [this](int minutes) {
+        backupManager->setInterval(minutes);
+    });
+    connect(keepSpin, qOverload<int>(&QSpinBox::valueChanged), this, [this](int count) {
+        backupManager->setKeepCount(count);
+    });
+
+    connect(backupManager, &BackupManager::progress, &backupDialog, [progressBar](int remaining, int total) {
+        progressBar->setVisible(true);
+        progressBar->setRange(0, qMax(total, 1));
+        progressBar->setValue(total - remaining);
+    });
+    connect(backupManager, &BackupManager::finished, &backupDialog,
+            [this, &backupDialog, progressBar, refresh](bool ok, const QString &path, const QString &error) {
+        progressBar->setVisible(false);
+        refresh();
+        if (ok) {
+            QMessageBox::information(&backupDialog, translate("Резервные копии"),
+                                     translate("Копия создана: %1").arg(QFileInfo(path).fileName()));
+        } else if (error.isEmpty()) {
+            QMessageBox::information(&backupDialog, translate("Резервные копии"), translate("Копирование прервано"));
+        } else {
+            QMessageBox::critical(&backupDialog, translate("Ошибка"), translate("Не удалось создать копию: ") + error);
+        }
+    });
+
+    connect(backupNowButton, &QPushButton::clicked, &backupDialog, [this, progressBar]() {
+        // Копия читает файл своим соединением - накопленная пачка должна быть на диске
+        repository.flush();
+        if (backupManager->start()) {
+            progressBar->setRange(0, 0);
+            progressBar->setVisible(true);
+        }
+    });
+
+    connect(restoreButton, &QPushButton::clicked, &backupDialog, [this, &backupDialog, backupList]() {
+        QListWidgetItem *item = backupList->currentItem();
+        if (!item) return;
+        if (backupManager->isRunning()) {
+            QMessageBox::warning(&backupDialog, translate("Ошибка"), translate("Дождитесь окончания копирования"));
+            return;
+        }
+
+        QString path = item->data(Qt::UserRole).toString();
+        if (QMessageBox::question(&backupDialog, translate("Восстановить"),
+                                  translate("Заменить текущую базу данных копией %1? Текущий файл будет сохранен как .before-restore.")
+                                      .arg(QFileInfo(path).fileName())) != QMessageBox::Yes) {
+            return;
+        }
+        restoreDatabase(path);
+        backupDialog.accept();
+    });
+
+    connect(closeButton, &QPushButton::clicked, &backupDialog, &QDialog::accept);
+
+    backupDialog.exec();
+}
+
+// Замена бд копией и перезагрузка модели
+void MainWindow::restoreDatabase(const QString &backupPath)
+{
+    TRACE_SCOPE("MainWindow::restoreDatabase", "ui");
+    const QString databasePath = repository.database().databaseName();
+
+    purger->stop();
+    repository.close();
+    try {
+        BackupManager::restore(backupPath, databasePath);
+    } catch (const std::exception &e) {
+        qCWarning(lcDb) << "Error restoring backup:" << e.what();
+        QMessageBox::critical(this, translate("Ошибка"),
+                              translate("Не удалось восстановить копию: ") + QString::fromStdString(e.what()));
+    }
+
+    // Открытие восстановленной (или, при ошибке, прежней) бд
+    if (!repository.open(databasePath)) {
+        QMessageBox::critical(this, translate("Error"), translate("Can't open database: ") + repository.lastError());
+        return;
+    }
+    if (!repository.createSchema()) {
+        QMessageBox::critical(this, translate("Error"), translate("Can't open database: ") + repository.lastError());
+        repository.close();
+        return;
+    }
+    taskSearch.createSchema(repository.database());
+    ModelCache::createSchema(repository.database());
+    changeFeed.createSchema();
+
+    qDeleteAll(workspaces);
+    workspaces.clear();
+    taskHistory.clear();
+    loadedWorkspaceFiles.clear();
+    undoStack.clear();
+    updateUndoButtons();
+    archiveOldHistory();
+    loadModel();
+    checkDeadlines();
+
+    currentWorkspaceLabel->setText(translate("Выберите рабочее пространство"));
+    updateUI();
+
+    // Пометки из копии
+    purger->start();
+}
+
+// Перенос старых записей истории в архив
+void MainWindow::archiveOldHistory()
+{
+    TRACE_SCOPE("MainWindow::archiveOldHistory", "ui");
+    historyArchive.open(HistoryArchive::pathFor(repository.database().databaseName()));
+    try {
+        historyArchive.reconcile(repository);
+        historyArchive.archive(repository);
+    } catch (const std::exception &e) {
+        // Записи остаются в бд, попытка повторится при следующем запуске
+        qCWarning(lcDb) << "Error archiving history:" << e.what();
+    }
+}
+
+// Применение изменений, сделанных в бд другими процессами
+void MainWindow::syncExternalChanges()
+{
+    ChangeFeed::Delta delta;
+    try {
+        delta = changeFeed.sync(workspaces, taskHistory, isEnglish);
+    } catch (const std::exception &e) {
+        qCWarning(lcDb) << "Error reading change log:" << e.what();
+        return;
+    }
+    // Полная загрузка: строки, на которые ссылаются команды отмены, могли измениться
+    if (delta.reloadRequired) {
+        undoStack.clear();
+        updateUndoButtons();
+    }
+    applyModelDelta(delta);
+}
+
+// Модель расходится с бд (изменения пачки откатились): загрузка заново и сообщение
+void MainWindow::reloadAfterLostWrites(int changes, const QString &error)
+{
+    qCWarning(lcDb) << "Reloading the model after" << changes << "unsaved changes were lost";
+    undoStack.clear();
+    updateUndoButtons();
+
+    ChangeFeed::Delta delta;
+    delta.reloadRequired = true;
+    applyModelDelta(delta);
+
+    QMessageBox::critical(this, translate("Ошибка"),
+                          translate("Последние изменения не сохранены (%1), данные перечитаны из базы: ").arg(changes)
+                          + error);
+}
+
+// Индексы, снимки и перерисовка по изменениям модели (журнал или отмена)
+void MainWindow::applyModelDelta(const ChangeFeed::Delta &delta)
+{
+    if (delta.isEmpty()) return;
+
+    QString currentName = currentWorkspaceLabel->text();
+    currentName.replace(translate("Рабочее пространство: "), "").replace(translate("Workspace: "), "");
+
+    if (delta.reloadRequired) {
+        qCInfo(lcModel) << "Too many changes, reloading the model";
+        qDeleteAll(workspaces);
+        workspaces.clear();
+        taskHistory.clear();
+        loadedWorkspaceFiles.clear();
+        loadModel();
+    } else {
+        // Индексы - только по измененным строкам
+        for (const QString &name : delta.removedWorkspaces) lookupIndex.remove(TrigramIndex::WorkspaceName, name);
+        for (const QString &name : delta.addedWorkspaces) lookupIndex.insert(TrigramIndex::WorkspaceName, name);
+        for (const QString &name : delta.removedCategories) lookupIndex.remove(TrigramIndex::CategoryName, name);
+        for (const QString &name : delta.addedCategories) lookupIndex.insert(TrigramIndex::CategoryName, name);
+        for (const QString &text : delta.removedDescriptions) lookupIndex.remove(TrigramIndex::TaskDescription, text);
+        for (const QString &text : delta.addedDescriptions) lookupIndex.insert(TrigramIndex::TaskDescription, text);
+        for (const QString &text : delta.removedHistoryDescriptions) {
+            lookupIndex.remove(TrigramIndex::HistoryDescription, text);
+        }
+        for (const QString &text : delta.addedHistoryDescriptions) {
+            lookupIndex.insert(TrigramIndex::HistoryDescription, text);
+        }
+        for (const QString &tag : delta.removedTags) tagIndex.remove(tag);
+        for (const QString &tag : delta.addedTags) tagIndex.add(tag);
+
+        for (const QString &name : delta.workspaces) {
+            snapshots.publish(workspaces, name);
+        }
+        for (const QPair<QString, QString> &category : delta.categories) {
+            if (!delta.workspaces.contains(category.first)) {
+                snapshots.publish(workspaces, category.first, category.second);
+            }
+        }
+    }
+    checkDeadlines();
+
+    // Перерисовка: список рабочих пр-в и открытое рабочее пр-во
+    if (!workspaces.contains(currentName)) {
+        if (delta.reloadRequired || delta.removedWorkspaces.contains(currentName)) {
+            currentWorkspaceLabel->setText(translate("Выберите рабочее пространство"));
+        }
+        showWorkspaces();
+        return;
+    }
+    if (delta.reloadRequired || !delta.addedWorkspaces.isEmpty() || !delta.removedWorkspaces.isEmpty()) {
+        showWorkspaces();
+    }
+    bool currentChanged = delta.reloadRequired || delta.workspaces.contains(currentName);
+    for (const QPair<QString, QString> &category : delta.categories) {
+        currentChanged = currentChanged || category.first == currentName;
+    }
+    if (currentChanged) {
+        showCategories(currentName);
+    }
+}
+
+// Отмена последнего действия: одна транзакция, модель правится по затронутым строкам
+void MainWindow::undo()
+{
+    if (!undoStack.canUndo()) return;
+    try {
+        ChangeFeed::Rows rows = undoStack.undo();
+        applyModelDelta(changeFeed.refresh(rows, workspaces, taskHistory, isEnglish));
+    } catch (const std::exception &e) {
+        qCWarning(lcDb) << "Error undoing:" << e.what();
+        QMessageBox::critical(this, translate("Ошибка"),
+                              translate("Не удалось отменить действие: ") + QString::fromStdString(e.what()));
+    }
+    updateUndoButtons();
+}
+
+// Повтор отмененного действия
+void MainWindow::redo()
+{
+    if (!undoStack.canRedo()) return;
+    try {
+        ChangeFeed::Rows rows = undoStack.redo();
+        applyModelDelta(changeFeed.refresh(rows, workspaces, taskHistory, isEnglish));
+        // Повтор удаления категории снова ставит пометку
+        purger->start();
+    } catch (const std::exception &e) {
+        qCWarning(lcDb) << "Error redoing:" << e.what();
+        QMessageBox::critical(this, translate("Ошибка"),
+                              translate("Не удалось повторить действие: ") + QString::fromStdString(e.what()));
+    }
+    updateUndoButtons();
+}
+
+void MainWindow::updateUndoButtons()
+{
+    undoButton->setEnabled(undoStack.canUndo());
+    undoButton->setToolTip(undoStack.undoLabel());
+    redoButton->setEnabled(undoStack.canRedo());
+    redoButton->setToolTip(undoStack.redoLabel());
+}
+
 // Возвращение строки в нижнем реигстре
 QString MainWindow::toLowerCase(const QString& str) const
 {
@@ -1905,8 +2938,9 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event) {
 
 // Нахождение задач по тегам
 QVector<QPair<QString, QString>> MainWindow::findTasksByTags(const QStringList& tags) {
+    TRACE_SCOPE_DETAIL("MainWindow::findTasksByTags", "search", tags.join(", "));
     QVector<QPair<QString, QString>> results;
-    qDebug() << "Starting tag search for tags:" << tags;
+    qCDebug(lcSearch) << "Starting tag search for tags:" << tags;
 
     // Проверка активных тасков
     for (auto workspaceIt = workspaces.begin(); workspaceIt != workspaces.end(); ++workspaceIt) {
@@ -1921,29 +2955,22 @@ QVector<QPair<QString, QString>> MainWindow::findTasksByTags(const QStringList&
                 QStringList taskTags = task->getTags();
 
                 // Перезапрос тегов из БД для актуальности
-                taskTags.clear();
-                QSqlQuery tagQuery;
-                tagQuery.prepare("SELECT tag FROM TaskTags WHERE task_id = :task_id");
-                tagQuery.bindValue(":task_id", task->getId());
-
-                if (tagQuery.exec()) {
-                    while (tagQuery.next()) {
-                        taskTags.append(tagQuery.value(0).toString());
-                    }
-                } else {
-                    qDebug() << "Error loading tags for task:" << task->getDescription();
+                try {
+                    taskTags = repository.taskTags(task->getId());
+                } catch (const std::exception &) {
+                    qCWarning(lcDb) << "Error loading tags for task:" << task->getDescription();
                 }
 
-                qDebug() << "Checking task:" << task->getDescription() << "with tags:" << taskTags;
+                qCDebugRow(lcSearch) << "Checking task:" << task->getDescription() << "with tags:" << taskTags;
 
                 for (const QString& taskTag : taskTags) {
                     for (const QString& searchTag : tags) {
                         // Сравнение (без учета регистра)
                         if (taskTag.trimmed().compare(searchTag.trimmed(), Qt::CaseInsensitive) == 0) {
                             results.append(qMakePair(workspace->getName(), category->getName()));
-                            qDebug() << "Found match! Workspace:" << workspace->getName()
-                                     << "Category:" << category->getName()
-                                     << "Task:" << task->getDescription();
+                            qCDebugRow(lcSearch) << "Found match! Workspace:" << workspace->getName()
+                                                 << "Category:" << category->getName()
+                                                 << "Task:" << task->getDescription();
                             goto next_task;
                         }
                     }
@@ -1953,8 +2980,9 @@ QVector<QPair<QString, QString>> MainWindow::findTasksByTags(const QStringList&
         }
     }
 
-    if (results.isEmpty()) {
-        qDebug() << "No tasks found with these tags. All available tags in the system:";
+    // Сбор всех тегов только для отладочного вывода
+    if (results.isEmpty() && lcSearch().isDebugEnabled()) {
+        qCDebug(lcSearch) << "No tasks found with these tags. All available tags in the system:";
         QSet<QString> allTags;
 
         for (const auto& workspace : workspaces) {
@@ -1968,7 +2996,7 @@ QVector<QPair<QString, QString>> MainWindow::findTasksByTags(const QStringList&
                 }
             }
         }
-        qDebug() << "All existing tags:" << allTags.values();
+        qCDebug(lcSearch) << "All existing tags:" << allTags.values();
     }
 
     return results;
@@ -1985,6 +3013,7 @@ void MainWindow::toggleTheme()
 // Применение темы
 void MainWindow::applyTheme(bool dark)
 {
+    TRACE_SCOPE("MainWindow::applyTheme", "ui");
     if (dark) {
         currentThemeStyle = R"(
             /* Dark Theme */
@@ -5,8 +5,6 @@
 #include <QMap>
 #include <QVector>
 #include <QString>
-#include <QSqlDatabase>
-#include <QSqlQuery>
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QScrollArea>
@@ -28,121 +26,24 @@
 #include <QParallelAnimationGroup>
 #include <QScrollBar>
 #include <QWheelEvent>
-
-class Notification {
-public:
-    Notification(const QString& taskDesc, const QString& deadlineDate, bool isEnglish = false)
-        : taskDescription(taskDesc), deadline(deadlineDate), viewed(false) {
-        updateMessage(isEnglish);
-    }
-
-    QString getMessage() const { return message; }
-    QString getTaskDescription() const { return taskDescription; }
-    QString getDeadline() const { return deadline; }
-    bool isViewed() const { return viewed; }
-    void markAsViewed() { viewed = true; }
-    void updateMessage(bool isEnglish) {
-        message = isEnglish ?
-                      QString("Attention! Deadline for task \"%1\" expires: %2").arg(taskDescription).arg(deadline) :
-                      QString("Внимание! Срок выполнения задачи \"%1\" истекает: %2").arg(taskDescription).arg(deadline);
-    }
-
-private:
-    QString message;
-    QString taskDescription;
-    QString deadline;
-    bool viewed;
-};
-
-class Task {
-public:
-    Task(int id, const QString& desc, const QString& cat, const QStringList& tg,
-         const QString& diff = "Medium", const QString& prio = "Medium",
-         const QString& stat = "Pending", const QString& dl = "")
-        : id(id), description(desc), category(cat), tags(tg),
-        difficulty(diff), priority(prio), status(stat), deadline(dl) {}
-
-    int getId() const { return id; }
-    QString getDescription() const { return description; }
-    QString getCategory() const { return category; }
-    QStringList getTags() const { return tags; }
-    QString getDifficulty() const { return difficulty; }
-    QString getPriority() const { return priority; }
-    QString getStatus() const { return status; }
-    QString getDeadline() const { return deadline; }
-
-    void setDifficulty(const QString& diff) { difficulty = diff; }
-    void setPriority(const QString& prio) { priority = prio; }
-    void setStatus(const QString& stat) { status = stat; }
-    void setDeadline(const QString& dl) { deadline = dl; }
-
-    int daysUntilDeadline() const {
-        if (deadline.isEmpty()) return -1;
-        QDate deadlineDate = QDate::fromString(deadline, "dd-MM-yyyy");
-        if (!deadlineDate.isValid()) return -1;
-        return QDate::currentDate().daysTo(deadlineDate);
-    }
-
-private:
-    int id;
-    QString description;
-    QString category;
-    QStringList tags;
-    QString difficulty;
-    QString priority;
-    QString status;
-    QString deadline;
-};
-
-class Category {
-public:
-    Category(int id, const QString& name) : id(id), name(name) {}
-
-    int getId() const { return id; }
-    void addTask(Task* task) { tasks.append(task); }
-    QString getName() const { return name; }
-    QVector<Task*>& getTasks() { return tasks; }
-
-    void removeTask(const QString& taskDesc) {
-        for (int i = 0; i < tasks.size(); ++i) {
-            if (tasks[i]->getDescription() == taskDesc) {
-                delete tasks[i];
-                tasks.remove(i);
-                break;
-            }
-        }
-    }
-
-private:
-    int id;
-    QString name;
-    QVector<Task*> tasks;
-};
-
-class Workspace {
-public:
-    Workspace(int id, const QString& name) : id(id), name(name) {}
-
-    int getId() const { return id; }
-    void addCategory(int id, const QString& categoryName) {
-        categories[categoryName] = new Category(id, categoryName);
-    }
-
-    QMap<QString, Category*>& getCategories() { return categories; }
-    QString getName() const { return name; }
-
-    void removeCategory(const QString& categoryName) {
-        if (categories.contains(categoryName)) {
-            delete categories[categoryName];
-            categories.remove(categoryName);
-        }
-    }
-
-private:
-    int id;
-    QString name;
-    QMap<QString, Category*> categories;
-};
+#include <QJsonObject>
+#include <QSet>
+#include <QTimer>
+
+#include "taskmodel.h"
+#include "taskrepository.h"
+#include "deadlinescheduler.h"
+#include "modelsnapshot.h"
+#include "taskfilter.h"
+#include "tasksearch.h"
+#include "trigramindex.h"
+#include "tagindex.h"
+#include "taskexporter.h"
+#include "backupmanager.h"
+#include "historyarchive.h"
+#include "changefeed.h"
+#include "undostack.h"
+#include "tombstonepurger.h"
 
 class MainWindow : public QMainWindow
 {
@@ -152,6 +53,12 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Снимок модели для фоновых читателей (поиск, статистика, экспорт)
+    ModelSnapshotPtr currentSnapshot() const;
+
+    // Отчет о памяти (структуры модели, виджеты, счетчики allocator'а) в JSON
+    QJsonObject memoryReport() const;
+
 signals:
     void languageChanged();
 
@@ -170,13 +77,23 @@ private slots:
     void changeTaskStatus(const QString& workspaceName, const QString& categoryName,
                           const QString& taskDescription, const QString& newStatus);
     void showHistory();
+    void showHistoryArchive();
     void restoreTaskFromHistory();
     void deleteTaskFromHistory();
     void showNotifications();
     void clearNotifications();
     void toggleLanguage();
     void searchTasksByTags();
+    void showTaskFilter();
+    void showTaskSearch();
+    void showSqlDiagnostics();
+    void showMemoryReport();
+    void importTasks();
+    void exportTasks();
+    void showBackups();
     void toggleTheme();
+    void undo();
+    void redo();
 
 private:
     bool isCompletedStatus(const QString& status) const;
@@ -187,11 +104,21 @@ private:
     QDialog* createHistoryDialog();
     QInputDialog* createInputDialog(const QString &title, const QString &label);
     void setupUI();
-    void loadWorkspaces();
-    void loadCategories();
-    void loadTasks();
-    void loadTaskHistory();
-    void executeSQL(const QString& sql);
+    void loadModel();
+    void loadWorkspaceFile(Workspace *workspace);
+    void restoreDatabase(const QString &backupPath);
+    void archiveOldHistory();
+    void syncExternalChanges();
+    void applyModelDelta(const ChangeFeed::Delta &delta);
+    void reloadAfterLostWrites(int changes, const QString &error);
+    void updateUndoButtons();
+    void rebuildLookupIndex();
+    void rebuildTagIndex();
+    void unindexWorkspace(Workspace *workspace);
+    void attachSuggestions(QLineEdit *edit, TrigramIndex::Kind kind);
+    QString getTextWithSuggestions(const QString &title, const QString &label,
+                                   TrigramIndex::Kind kind, bool *ok);
+    QString confirmSuggestion(TrigramIndex::Kind kind, const QString &text);
     void checkDeadlines();
     void showWorkspaces();
     void showCategories(const QString& workspaceName);
@@ -203,14 +130,35 @@ private:
     QString currentThemeStyle;
     bool eventFilter(QObject *obj, QEvent *event) override;
 
-    QSqlDatabase db;
+    TaskRepository repository;
+    ChangeFeed changeFeed{repository};
+    UndoStack undoStack{repository};
     QVector<Notification> notifications;
     QMap<QString, Workspace*> workspaces;
     QVector<Task> taskHistory;
+    HistoryArchive historyArchive;
+    QSet<int> loadedWorkspaceFiles;
+    SnapshotPublisher snapshots;
+    TaskFilterEngine filterEngine;
+    TaskSearchIndex taskSearch;
+    TrigramIndex lookupIndex;
+    TagIndex tagIndex;
     bool isEnglish;
 
     // UI Elements
     QPushButton *searchByTagsButton;
+    QPushButton *filterTasksButton;
+    QPushButton *searchButton;
+    QPushButton *importButton;
+    QPushButton *exportButton;
+    TaskExporter *exporter;
+    QPushButton *backupButton;
+    QPushButton *undoButton;
+    QPushButton *redoButton;
+    BackupManager *backupManager;
+    QTimer *syncTimer;
+    TombstonePurger *purger;
+    QLabel *purgeLabel;
     QWidget *mainWidget;
     QVBoxLayout *mainLayout;
     QScrollArea *sidebar;
@@ -218,6 +166,7 @@ private:
     QVBoxLayout *sidebarLayout;
     QPushButton *toggleSidebarButton;
     QPushButton *addWorkspaceButton;
+    QLineEdit *quickSwitcher;
     QPushButton *historyButton;
     QPushButton *notificationsButton;
     QPushButton *languageButton;
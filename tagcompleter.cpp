@@ -0,0 +1,42 @@
+#include "tagcompleter.h"
+
+TagCompleter::TagCompleter(const TagIndex *index, QLineEdit *edit)
+    : QCompleter(edit), tagIndex(index), lineEdit(edit), suggestions(new QStringListModel(this))
+{
+    setModel(suggestions);
+    setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    setCaseSensitivity(Qt::CaseInsensitive);
+    setWidget(edit);
+
+    connect(edit, &QLineEdit::textEdited, this, &TagCompleter::updateSuggestions);
+    connect(this, qOverload<const QString &>(&QCompleter::activated), edit, &QLineEdit::setText);
+}
+
+// Тег, который сейчас вводится (после последней запятой)
+QString TagCompleter::currentToken(const QString &text)
+{
+    return text.mid(text.lastIndexOf(',') + 1).trimmed();
+}
+
+void TagCompleter::updateSuggestions(const QString &text)
+{
+    QString token = currentToken(text);
+    suggestions->setStringList(token.isEmpty() ? QStringList() : tagIndex->suggestions(token));
+    if (!token.isEmpty()) {
+        complete();
+    }
+}
+
+// Подстановка: уже введенные теги + выбранный
+QString TagCompleter::pathFromIndex(const QModelIndex &index) const
+{
+    QString text = lineEdit->text();
+    int separator = text.lastIndexOf(',');
+    QString head = separator >= 0 ? text.left(separator + 1) + " " : QString();
+    return head + index.data().toString();
+}
+
+QStringList TagCompleter::splitPath(const QString &path) const
+{
+    return {currentToken(path)};
+}
@@ -0,0 +1,30 @@
+#ifndef TAGCOMPLETER_H
+#define TAGCOMPLETER_H
+
+#include <QCompleter>
+#include <QLineEdit>
+#include <QStringListModel>
+
+#include "tagindex.h"
+
+// Автодополнение последнего тега в строке "тег1, тег2, ..."
+class TagCompleter : public QCompleter
+{
+    Q_OBJECT
+
+public:
+    TagCompleter(const TagIndex *index, QLineEdit *edit);
+
+    QString pathFromIndex(const QModelIndex &index) const override;
+    QStringList splitPath(const QString &path) const override;
+
+private:
+    void updateSuggestions(const QString &text);
+    static QString currentToken(const QString &text);
+
+    const TagIndex *tagIndex;
+    QLineEdit *lineEdit;
+    QStringListModel *suggestions;
+};
+
+#endif // TAGCOMPLETER_H
@@ -0,0 +1,102 @@
+#include "taskresultsmodel.h"
+#include <algorithm>
+#include <limits>
+
+TaskResultsModel::TaskResultsModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void TaskResultsModel::setHeaderLabels(const QStringList& labels)
+{
+    headers = labels;
+    emit headerDataChanged(Qt::Horizontal, 0, ColumnCount - 1);
+}
+
+// Новые результаты (ключи строк считаются один раз)
+void TaskResultsModel::setResults(const QVector<TaskFilterHit>& hits)
+{
+    beginResetModel();
+    rows.clear();
+    rows.reserve(hits.size());
+    for (const TaskFilterHit& hit : hits) {
+        rows.append({hit, searchKey(hit.workspace), searchKey(hit.task->category)});
+    }
+    endResetModel();
+
+    if (sortColumn >= 0) {
+        sort(sortColumn, sortOrder);
+    }
+}
+
+int TaskResultsModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+int TaskResultsModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TaskResultsModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole) return QVariant();
+
+    const Row& row = rows[index.row()];
+    const TaskSnapshot& task = *row.hit.task;
+    switch (index.column()) {
+    case TaskColumn: return task.description;
+    case WorkspaceColumn: return row.hit.workspace;
+    case CategoryColumn: return task.category;
+    case DeadlineColumn: return task.deadline;
+    case StatusColumn: return task.status;
+    case PriorityColumn: return task.priority;
+    case DifficultyColumn: return task.difficulty;
+    }
+    return QVariant();
+}
+
+QVariant TaskResultsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section < headers.size()) {
+        return headers[section];
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+// Сортировка по числовым ключам и casefold-строкам (без localeAwareCompare)
+void TaskResultsModel::sort(int column, Qt::SortOrder order)
+{
+    sortColumn = column;
+    sortOrder = order;
+
+    auto less = [column](const Row& a, const Row& b) {
+        const TaskSnapshot& x = *a.hit.task;
+        const TaskSnapshot& y = *b.hit.task;
+        switch (column) {
+        case TaskColumn: return x.descriptionKey < y.descriptionKey;
+        case WorkspaceColumn: return a.workspaceKey < b.workspaceKey;
+        case CategoryColumn: return a.categoryKey < b.categoryKey;
+        case DeadlineColumn: {
+            // Задачи без срока - в конце
+            qint64 dx = x.deadlineDay ? x.deadlineDay : std::numeric_limits<qint64>::max();
+            qint64 dy = y.deadlineDay ? y.deadlineDay : std::numeric_limits<qint64>::max();
+            return dx < dy;
+        }
+        case StatusColumn: return x.statusCode < y.statusCode;
+        case PriorityColumn: return x.priorityRank < y.priorityRank;
+        case DifficultyColumn: return x.difficultyRank < y.difficultyRank;
+        }
+        return false;
+    };
+
+    emit layoutAboutToBeChanged();
+    if (order == Qt::AscendingOrder) {
+        std::stable_sort(rows.begin(), rows.end(), less);
+    } else {
+        std::stable_sort(rows.begin(), rows.end(), [&less](const Row& a, const Row& b) { return less(b, a); });
+    }
+    emit layoutChanged();
+}
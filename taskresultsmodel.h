@@ -0,0 +1,44 @@
+#ifndef TASKRESULTSMODEL_H
+#define TASKRESULTSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+
+#include "taskfilter.h"
+
+// Модель результатов фильтра с сортировкой по заранее посчитанным ключам
+class TaskResultsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { TaskColumn, WorkspaceColumn, CategoryColumn, DeadlineColumn,
+                  StatusColumn, PriorityColumn, DifficultyColumn, ColumnCount };
+
+    explicit TaskResultsModel(QObject *parent = nullptr);
+
+    void setHeaderLabels(const QStringList& labels);
+    void setResults(const QVector<TaskFilterHit>& hits);
+    const TaskFilterHit& hitAt(int row) const { return rows[row].hit; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+    struct Row {
+        TaskFilterHit hit;
+        QString workspaceKey;
+        QString categoryKey;
+    };
+
+    QVector<Row> rows;
+    QStringList headers;
+    int sortColumn = -1;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+};
+
+#endif // TASKRESULTSMODEL_H